@@ -0,0 +1,46 @@
+//
+//  bench_volume.cpp
+//  reaper_csurf_integrator
+//
+//  ns/op for the reference volume conversions in handy_functions.h against their table driven versions
+//
+//  bench_volume [iterations]
+//
+
+#include "control_surface_integrator.h"
+#include "handy_functions.h"
+
+static volatile double sink_ = 0.0;
+
+template<typename F> static double TimeConversion(int iterations, F convert)
+{
+    double sum = 0.0;
+    
+    auto start = chrono::steady_clock::now();
+    
+    for(int i = 0; i < iterations; i++)
+        sum += convert((i % 16384) / 16383.0);
+    
+    auto end = chrono::steady_clock::now();
+    
+    sink_ = sum;
+    
+    return chrono::duration<double, nano>(end - start).count() / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000000;
+    
+    GetVolumeTables(); // build outside the timed loops
+    
+    printf("%-40s %10s\n", "Conversion", "ns/op");
+    printf("%-40s %10.2f\n", "normalizedToVol", TimeConversion(iterations, [](double x) { return normalizedToVol(x); }));
+    printf("%-40s %10.2f\n", "normalizedToVolFast", TimeConversion(iterations, [](double x) { return normalizedToVolFast(x); }));
+    printf("%-40s %10.2f\n", "VAL2DB", TimeConversion(iterations, [](double x) { return VAL2DB(x * 4.0); }));
+    printf("%-40s %10.2f\n", "VAL2DBFast", TimeConversion(iterations, [](double x) { return VAL2DBFast(x * 4.0); }));
+    printf("%-40s %10.2f\n", "volToNormalized", TimeConversion(iterations, [](double x) { return volToNormalized(x * 4.0); }));
+    printf("%-40s %10.2f\n", "volToNormalizedFast", TimeConversion(iterations, [](double x) { return volToNormalizedFast(x * 4.0); }));
+    
+    return 0;
+}
@@ -0,0 +1,382 @@
+//
+//  csi_bench.cpp
+//  reaper_csurf_integrator
+//
+//  Hot path benchmarks against the in-memory DAW model, timed by the profiler's own phases.
+//  Reports ns/op, allocations/op and DAW calls/op per scenario, and the change in ns/op against a baseline written by an earlier run.
+//
+//  csi_bench [--baseline <file>] [--out <file>] [--quick]
+//
+
+#include "csi_test_host.h"
+
+struct BenchResult
+{
+    string name;
+    long long ops = 0;
+    double nsPerOp = 0.0;
+    double allocationsPerOp = 0.0;
+    double dawCallsPerOp = 0.0;
+};
+
+static vector<BenchResult> results_;
+static int iterations_ = 1000; // --quick drops this to 10
+
+static const int NumBenchFXZones = 40; // more than ControlSurface::MaxResidentFXZones, so cycling through them reparses every time
+
+static string GetBenchFXName(int index)
+{
+    return "VST: BenchEQ " + to_string(index + 1) + " (Bench)";
+}
+
+static string MakeBenchResources(int numSurfaces)
+{
+    string csiIni = "Version 1.1\nPage \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n";
+
+    for(int i = 0; i < numSurfaces; i++)
+        csiIni += "MidiSurface MCU" + to_string(i + 1) + " " + to_string(i) + " " + to_string(i) + " MCU.mst MCU 8 4 8 0\n";
+
+    string resources = MakeTestResources(csiIni);
+
+    AddTestResource(resources, "Zones/MCU/Send.zon",
+                    "Zone Send\n"
+                    "\tSendNavigator\n"
+                    "\tRotary|\t\tTrackSendVolume\n"
+                    "\tDisplayUpper|\tTrackSendNameDisplay\n"
+                    "ZoneEnd\n");
+
+    for(int fx = 0; fx < NumBenchFXZones; fx++)
+    {
+        string zone = "Zone \"" + GetBenchFXName(fx) + "\"\n\tSelectedTrackNavigator\n";
+
+        for(int i = 1; i <= 8; i++)
+            zone += "\tRotary" + to_string(i) + "\t\tFXParam " + to_string(i - 1) + "\n\tDisplayUpper" + to_string(i) + "\tFXParamNameDisplay " + to_string(i - 1) + "\n";
+
+        AddTestResource(resources, "Zones/MCU/BenchFX" + to_string(fx + 1) + ".zon", zone + "ZoneEnd\n");
+    }
+
+    return resources;
+}
+
+static void SetTrackCount(int numTracks)
+{
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    daw.RemoveAllTracks();
+
+    for(int i = 0; i < numTracks; i++)
+    {
+        MediaTrack* track = daw.AddTrack("Track " + to_string(i + 1));
+
+        if(i < 32)
+        {
+            daw.AddFX(track, GetBenchFXName(0), 8);
+
+            if(i > 0)
+                daw.AddSend(track, daw.tracks_[0].get());
+        }
+    }
+
+    if(TheManager != nullptr)
+        TheManager->OnTrackListChange();
+}
+
+static void ClearSentMessages()
+{
+    for(auto &[device, midiOutput] : HeadlessDAW::Get().midiOutputs_)
+        midiOutput->ClearSentMessages();
+}
+
+static void BeginBench()
+{
+    ClearSentMessages();
+    CSIProfiler::SetEnabled(true);
+}
+
+// ops <= 0 takes the number of outermost scopes the phase recorded
+static void EndBench(string name, ProfilePhase phase, long long ops = 0)
+{
+    PhaseStats stats = CSIProfiler::GetPhaseStats(phase);
+
+    CSIProfiler::SetEnabled(false);
+    ClearSentMessages();
+
+    BenchResult result;
+    result.name = name;
+    result.ops = ops > 0 ? ops : stats.calls;
+
+    if(result.ops > 0)
+    {
+        result.nsPerOp = stats.totalNanoseconds / result.ops;
+        result.allocationsPerOp = (double)stats.allocations / result.ops;
+        result.dawCallsPerOp = (double)stats.dawCalls / result.ops;
+    }
+
+    results_.push_back(result);
+}
+
+static void BenchMidiInput()
+{
+    string resources = MakeBenchResources(1);
+    SetTrackCount(32);
+    StartManager(resources);
+    RunTicks(2);
+
+    HeadlessMidiInput* midiInput = HeadlessDAW::Get().GetMidiInput(0);
+
+    // A fader ride, 16 messages a tick across the first 4 strips
+    BeginBench();
+
+    for(int i = 0; i < iterations_; i++)
+    {
+        for(int message = 0; message < 16; message++)
+        {
+            int position = (i * 16 + message) & 0x3fff;
+            midiInput->QueueMessage(0xe0 + (message & 3), position & 0x7f, position >> 7);
+        }
+
+        RunTicks(1);
+    }
+
+    EndBench("ProcessMidiMessage/fader", ProfileProcessMidiMessage);
+
+    // V-Pot turns, alternating direction
+    BeginBench();
+
+    for(int i = 0; i < iterations_; i++)
+    {
+        for(int message = 0; message < 16; message++)
+            midiInput->QueueMessage(0xb0, 0x10 + (message & 7), (message & 1) ? 0x41 : 0x01);
+
+        RunTicks(1);
+    }
+
+    EndBench("ProcessMidiMessage/encoder", ProfileProcessMidiMessage);
+
+    StopManager();
+    RemoveTestResources(resources);
+}
+
+static void BenchRequestUpdate(int numChannels)
+{
+    string resources = MakeBenchResources(numChannels / 8);
+    SetTrackCount(32);
+    StartManager(resources);
+    RunTicks(2);
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    BeginBench();
+
+    for(int i = 0; i < iterations_; i++)
+    {
+        // Every strip's volume moves, so each tick has real feedback to send
+        for(int track = 0; track < numChannels; track++)
+            daw.tracks_[track]->info_.SetValue("D_VOL", 0.1 + 0.8 * ((i + track) % 100) / 100.0);
+
+        RunTicks(1);
+    }
+
+    EndBench("RequestUpdate/" + to_string(numChannels) + "ch", ProfileRequestUpdate, iterations_);
+
+    StopManager();
+    RemoveTestResources(resources);
+}
+
+static void DeactivateZones(ControlSurface* surface, vector<Zone*> &zones)
+{
+    for(auto zone : zones)
+        surface->Deactivate(zone);
+
+    zones.clear();
+}
+
+static void BenchZones()
+{
+    string resources = MakeBenchResources(1);
+    SetTrackCount(32);
+    StartManager(resources);
+    RunTicks(2);
+
+    ControlSurface* surface = TheManager->GetCurrentPage()->GetSurface("MCU1");
+    vector<Zone*> zones;
+
+    // Home includes the 8 channel Track zone, the nested Activate calls count as part of the one Home activation
+    BeginBench();
+
+    for(int i = 0; i < iterations_; i++)
+    {
+        if(ZoneTemplate* zoneTemplate = surface->GetZoneTemplate("Home"))
+            zoneTemplate->Activate(surface, zones);
+
+        DeactivateZones(surface, zones);
+    }
+
+    EndBench("ZoneActivate/Home", ProfileZoneActivate, iterations_);
+
+    BeginBench();
+
+    for(int i = 0; i < iterations_; i++)
+    {
+        if(ZoneTemplate* zoneTemplate = surface->GetZoneTemplate(GetBenchFXName(0)))
+            zoneTemplate->Activate(surface, zones, 0, false, false);
+
+        DeactivateZones(surface, zones);
+    }
+
+    EndBench("ZoneActivate/FX", ProfileZoneActivate, iterations_);
+
+    BeginBench();
+
+    for(int i = 0; i < iterations_; i++)
+    {
+        if(ZoneTemplate* zoneTemplate = surface->GetZoneTemplate("Send"))
+            zoneTemplate->Activate(surface, zones);
+
+        DeactivateZones(surface, zones);
+    }
+
+    EndBench("ZoneActivate/Send", ProfileZoneActivate, iterations_);
+
+    // Parsing is timed wherever it happens, on first use of an FX zone here rather than at startup
+    BeginBench();
+
+    for(int i = 0; i < iterations_ / 10 + 1; i++)
+        for(int fx = 0; fx < NumBenchFXZones; fx++)
+            surface->GetZoneTemplate(GetBenchFXName(fx));
+
+    EndBench("ProcessZoneFile/FX", ProfileProcessZoneFile);
+
+    StopManager();
+    RemoveTestResources(resources);
+}
+
+static void BenchRebuildTrackList(int numTracks)
+{
+    string resources = MakeBenchResources(1);
+    SetTrackCount(numTracks);
+    StartManager(resources);
+    RunTicks(2);
+
+    TrackNavigationManager* trackNavigationManager = TheManager->GetCurrentPage()->GetTrackNavigationManager();
+    int repetitions = iterations_ * 100 / numTracks + 1;
+
+    BeginBench();
+
+    for(int i = 0; i < repetitions; i++)
+    {
+        ProfileScope rebuildScope(ProfileRebuildTrackList);
+        trackNavigationManager->RebuildTrackList();
+    }
+
+    EndBench("RebuildTrackList/" + to_string(numTracks), ProfileRebuildTrackList);
+
+    StopManager();
+    RemoveTestResources(resources);
+}
+
+static map<string, double> ReadBaseline(string baselinePath)
+{
+    map<string, double> baseline;
+    JSONValue benchmarks;
+
+    if( ! JSONValue::ReadFile(baselinePath, benchmarks))
+    {
+        fprintf(stderr, "Could not read %s as JSON, no baseline\n", baselinePath.c_str());
+        return baseline;
+    }
+
+    if(const JSONValue* entries = benchmarks.Find("benchmarks"))
+        for(auto &entry : entries->elements)
+            if(entry.GetString("name") != "")
+                baseline[entry.GetString("name")] = entry.GetNumber("nsPerOp");
+
+    return baseline;
+}
+
+static void WriteResults(string outPath)
+{
+    ofstream file(outPath, ios::trunc);
+
+    if( ! file.is_open())
+    {
+        fprintf(stderr, "Could not open %s for writing\n", outPath.c_str());
+        return;
+    }
+
+    file << "{\n    \"benchmarks\": [\n";
+
+    for(int i = 0; i < results_.size(); i++)
+    {
+        BenchResult &result = results_[i];
+
+        file << "        { \"name\": \"" << result.name << "\", \"ops\": " << result.ops << fixed << setprecision(2);
+        file << ", \"nsPerOp\": " << result.nsPerOp << ", \"allocationsPerOp\": " << result.allocationsPerOp << ", \"dawCallsPerOp\": " << result.dawCallsPerOp << " }";
+        file << (i + 1 < results_.size() ? ",\n" : "\n");
+    }
+
+    file << "    ]\n}\n";
+}
+
+int main(int argc, char* argv[])
+{
+    string baselinePath = "";
+    string outPath = "";
+
+    for(int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+
+        if(arg == "--baseline" && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if(arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if(arg == "--quick")
+            iterations_ = 10;
+        else
+        {
+            fputs("usage: csi_bench [--baseline <file>] [--out <file>] [--quick]\n", stderr);
+            return 2;
+        }
+    }
+
+    BenchMidiInput();
+
+    BenchRequestUpdate(8);
+    BenchRequestUpdate(16);
+    BenchRequestUpdate(32);
+
+    BenchZones();
+
+    BenchRebuildTrackList(100);
+    BenchRebuildTrackList(1000);
+    BenchRebuildTrackList(5000);
+
+    map<string, double> baseline = baselinePath != "" ? ReadBaseline(baselinePath) : map<string, double>();
+
+    printf("%-32s %10s %12s %9s %10s %10s\n", "Benchmark", "Ops", "ns/op", "Change", "Allocs/op", "DAW/op");
+
+    for(auto &result : results_)
+    {
+        char change[32] = "";
+
+        if(baseline.count(result.name) > 0 && baseline[result.name] > 0.0)
+            snprintf(change, sizeof(change), "%+7.1f%%", (result.nsPerOp / baseline[result.name] - 1.0) * 100.0);
+
+        printf("%-32s %10lld %12.0f %9s %10.1f %10.1f\n", result.name.c_str(), result.ops, result.nsPerOp, change, result.allocationsPerOp, result.dawCallsPerOp);
+    }
+
+    if(outPath != "")
+        WriteResults(outPath);
+
+    for(auto &result : results_)
+    {
+        if(result.ops == 0)
+        {
+            fprintf(stderr, "%s recorded nothing\n", result.name.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+//
+//  csi_headless.cpp
+//  reaper_csurf_integrator
+//
+//  Runs the engine against the in-memory DAW model
+//
+//  csi_headless --resources <folder with a CSI tree> [--tracks <count>] [--ticks <count>] [--replay <recording> [--fast]]
+//
+//  A replay runs after the ticks until the recording is exhausted, and leaves ReplayFeedback.txt and ReplayDAWWrites.txt in <folder>/CSI
+//
+
+#include <thread>
+#include "control_surface_integrator.h"
+
+static void Usage()
+{
+    fputs("usage: csi_headless --resources <folder> [--tracks <count>] [--ticks <count>] [--replay <recording> [--fast]]\n", stderr);
+}
+
+int main(int argc, char* argv[])
+{
+    string resourcePath = "";
+    int numTracks = 0;
+    int numTicks = 1;
+    string replayPath = "";
+    bool replayAsFastAsPossible = false;
+    
+    for(int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        
+        if(arg == "--resources" && i + 1 < argc)
+            resourcePath = argv[++i];
+        else if(arg == "--tracks" && i + 1 < argc)
+            numTracks = atoi(argv[++i]);
+        else if(arg == "--ticks" && i + 1 < argc)
+            numTicks = atoi(argv[++i]);
+        else if(arg == "--replay" && i + 1 < argc)
+            replayPath = argv[++i];
+        else if(arg == "--fast")
+            replayAsFastAsPossible = true;
+        else
+        {
+            Usage();
+            return 2;
+        }
+    }
+    
+    if(resourcePath == "")
+    {
+        Usage();
+        return 2;
+    }
+    
+    HeadlessDAW& daw = HeadlessDAW::Get();
+    daw.SetResourcePath(resourcePath);
+    daw.echoConsole_ = true;
+    
+    for(int i = 0; i < numTracks; i++)
+        daw.AddTrack("");
+    
+    TheManager = new Manager(nullptr);
+    TheManager->Init();
+    
+    for(int i = 0; i < numTicks; i++)
+        TheManager->Run();
+    
+    int result = 0;
+    
+    if(replayPath != "")
+    {
+        if(TheManager->StartReplay(replayPath, replayAsFastAsPossible))
+        {
+            while(TheManager->IsReplaying())
+            {
+                TheManager->Run();
+                
+                if( ! replayAsFastAsPossible)
+                    this_thread::sleep_for(chrono::milliseconds(30)); // about the rate REAPER calls Run
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Could not replay %s\n", replayPath.c_str());
+            result = 1;
+        }
+    }
+    
+    for(auto &[device, midiOutput] : daw.midiOutputs_)
+        printf("MIDI output %d: %d messages\n", device, midiOutput->GetNumMessagesSent());
+    
+    TheManager->Shutdown();
+    delete TheManager;
+    TheManager = nullptr;
+    
+    return result;
+}
@@ -0,0 +1,12 @@
+//
+//  csi_headless_globals.cpp
+//  reaper_csurf_integrator
+//
+//  The globals main.cpp defines in the plugin build
+//
+
+#include "control_surface_integrator.h"
+
+HWND g_hwnd = nullptr;
+reaper_plugin_info_t* g_reaper_plugin_info = nullptr; // no REAPER, so no EuCon
+Manager* TheManager = nullptr;
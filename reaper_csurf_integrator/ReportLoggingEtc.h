@@ -10,8 +10,18 @@
 #define ReportLoggingEtc_h
 
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <vector>
 
+#ifdef CSI_HEADLESS_DAW
+#include "reaper_plugin.h"
+inline void ShowConsoleMsg(const char* msg); // defined in control_surface_integrator_HeadlessDAW.h
+#else
 #include "reaper_plugin_functions.h"
+#endif
 
 /////////////////////////////////////////////////
 class LOG
@@ -57,4 +67,336 @@ public:
     
 };
 
+enum TraceDirection
+{
+    TraceInput = 1,
+    TraceOutput = 2,
+};
+
+enum TraceKind
+{
+    TraceWidgetInput,
+    TraceMidiInput,
+    TraceMidiOutput,
+    TraceSysExOutput,
+    TraceOSCInput,
+    TraceOSCOutput,
+    TraceEuConInput,
+    TraceEuConOutput,
+    TraceZoneLoad,
+};
+
+/////////////////////////////////////////////////
+struct TraceRecord
+/////////////////////////////////////////////////
+{
+    double timestamp;
+    double value;
+    unsigned short kind;
+    unsigned short surfaceId;
+    unsigned short widgetId;
+    unsigned short size;
+    bool hasValue;
+    bool isTruncated; // data didn't hold everything, the formatted line is marked
+    char data[102]; // raw bytes, or address and text NUL separated, sized so a record is 128 bytes and a full MCU display SysEx fits
+};
+
+/////////////////////////////////////////////////
+class CSITrace
+/////////////////////////////////////////////////
+{
+private:
+    static std::atomic<int> enabledDirections_;
+    
+public:
+    // The only thing the hot path pays when tracing is off
+    static bool IsEnabled(TraceDirection direction) { return (enabledDirections_.load(std::memory_order_relaxed) & direction) != 0; }
+    
+    static void SetEnabled(int directions, int consoleDirections);
+    static void Shutdown();
+    
+    static int RegisterName(std::string name);
+    static std::string GetName(int id);
+    
+    static void Record(TraceKind kind, int surfaceId, int widgetId, double value);
+    static void Record(TraceKind kind, int surfaceId, int widgetId, const unsigned char* bytes, int size);
+    static void Record(TraceKind kind, int surfaceId, int widgetId, const char* address, double value);
+    static void Record(TraceKind kind, int surfaceId, int widgetId, const char* address, const char* text);
+    
+    static void FlushToConsole();
+    static void DumpToFile(std::string filePath, double sinceTimestamp = 0.0); // CSIProfiler::GetTimestamp() time, records before it are left out
+};
+
+enum RecordKind
+{
+    RecordTick,
+    RecordSurfaceName,
+    RecordMidi,
+    RecordOSCPacket,
+    RecordEuConDouble,
+    RecordEuConString,
+    RecordEuConVisibility,
+    RecordOSCMessage, // OSCArguments then the address, recorded as decoded by the OSC input thread
+};
+
+/////////////////////////////////////////////////
+struct RecordHeader
+/////////////////////////////////////////////////
+{
+    // Precedes each payload in a recording file, surfaceId indexes the recording's own RecordSurfaceName entries
+    double timestamp; // ms since recording started
+    unsigned short surfaceId;
+    unsigned char kind;
+    unsigned char reserved;
+    unsigned int size;
+};
+
+/////////////////////////////////////////////////
+struct RecordedEvent
+/////////////////////////////////////////////////
+{
+    double timestamp;
+    int tick;
+    RecordKind kind;
+    std::string surfaceName;
+    std::vector<unsigned char> payload;
+};
+
+/////////////////////////////////////////////////
+class CSIRecorder
+/////////////////////////////////////////////////
+{
+    // Captures raw surface input, main thread only
+private:
+    static std::atomic<bool> isRecording_;
+    
+public:
+    static bool IsRecording() { return isRecording_.load(std::memory_order_relaxed); }
+    
+    static bool Start(std::string filePath);
+    static void Stop();
+    
+    static void BeginTick();
+    static void Record(int surfaceId, RecordKind kind, double timestamp, const void* payload, int size);
+    static void Record(int surfaceId, RecordKind kind, double timestamp, const void* prefix, int prefixSize, std::string text);
+    
+    static bool Load(std::string filePath, std::vector<RecordedEvent> &events);
+};
+
+/////////////////////////////////////////////////
+struct LatencyHistogram
+/////////////////////////////////////////////////
+{
+    // Upper bounds double from 0.125ms, the last bucket catches everything from 512ms up
+    static const int NumBuckets = 14;
+    
+    int buckets[NumBuckets] = {};
+    int count = 0;
+    double total = 0.0;
+    double maximum = 0.0;
+    
+    static double GetBucketLimit(int bucket) { return 0.125 * (1 << bucket); }
+    
+    void Add(double milliseconds)
+    {
+        int bucket = 0;
+        
+        while(bucket < NumBuckets - 1 && milliseconds >= GetBucketLimit(bucket))
+            bucket++;
+        
+        buckets[bucket]++;
+        count++;
+        total += milliseconds;
+        
+        if(milliseconds > maximum)
+            maximum = milliseconds;
+    }
+    
+    double GetPercentile(double fraction)
+    {
+        int target = count * fraction;
+        int seen = 0;
+        
+        for(int i = 0; i < NumBuckets - 1; i++)
+        {
+            seen += buckets[i];
+            
+            if(seen > target)
+                return GetBucketLimit(i);
+        }
+        
+        return maximum;
+    }
+};
+
+enum ProfilePhase
+{
+    ProfileRun,
+    ProfileRebuildTrackList,
+    ProfileHandleExternalInput,
+    ProfileRequestUpdate,
+    ProfileProcessMidiMessage,
+    ProfileZoneActivate,
+    ProfileProcessZoneFile,
+    NumProfilePhases
+};
+
+struct PhaseStats
+{
+    long long calls = 0;
+    double totalNanoseconds = 0.0;
+    double maxNanoseconds = 0.0;
+    long long dawCalls = 0;
+    long long maxDAWCalls = 0;
+    long long allocations = 0;
+    long long maxAllocations = 0;
+};
+
+const int MaxDAWApis = 160;
+
+/////////////////////////////////////////////////
+struct JSONValue
+/////////////////////////////////////////////////
+{
+    // Just enough JSON to read back the profile and benchmark files CSI writes
+    enum Type { Null, Bool, Number, String, Array, Object };
+    
+    Type type = Null;
+    bool boolValue = false;
+    double numberValue = 0.0;
+    std::string stringValue;
+    std::vector<JSONValue> elements;
+    std::vector<std::pair<std::string, JSONValue>> members;
+    
+    const JSONValue* Find(const std::string &key) const
+    {
+        for(auto &member : members)
+            if(member.first == key)
+                return &member.second;
+        
+        return nullptr;
+    }
+    
+    double GetNumber(const std::string &key, double defaultValue = 0.0) const
+    {
+        const JSONValue* value = Find(key);
+        return value != nullptr && value->type == Number ? value->numberValue : defaultValue;
+    }
+    
+    std::string GetString(const std::string &key) const
+    {
+        const JSONValue* value = Find(key);
+        return value != nullptr && value->type == String ? value->stringValue : "";
+    }
+    
+    // false, leaving value Null, for anything that isn't a single well formed JSON value
+    static bool Parse(const std::string &text, JSONValue &value);
+    static bool ReadFile(const std::string &filePath, JSONValue &value);
+};
+
+/////////////////////////////////////////////////
+class CSIProfiler
+/////////////////////////////////////////////////
+{
+private:
+    static std::atomic<bool> isEnabled_;
+    static double inputTimestamp_;
+    
+    // Phases and DAW calls are only kept for the thread that enabled the profiler, the main thread.
+    // EuCon's thread makes DAW calls too, those go uncounted. Allocations are counted from any thread.
+    static std::thread::id profiledThread_;
+    static int currentPhase_; // innermost open ProfileScope, NumProfilePhases outside all of them
+    static int phaseDepths_[NumProfilePhases]; // open ProfileScopes per phase
+    static long long dawCallCount_;
+    static long long dawCalls_[NumProfilePhases + 1][MaxDAWApis];
+    static std::atomic<long long> allocationCount_;
+    
+public:
+    static bool IsEnabled() { return isEnabled_.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool isEnabled);
+    
+    static double GetTimestamp() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+    
+    // Everything dispatched between these is attributed to an input that arrived at arrivalTimestamp
+    static void BeginInput(double arrivalTimestamp) { inputTimestamp_ = arrivalTimestamp; }
+    static void EndInput() { inputTimestamp_ = 0.0; }
+    static double GetInputTimestamp() { return inputTimestamp_; }
+    
+    static void RecordActionLatency(int surfaceId, const void* action);
+    static void RecordFeedbackLatency(int surfaceId, double inputTimestamp);
+    static void RecordPhase(ProfilePhase phase, int surfaceId, double nanoseconds, long long dawCalls, long long allocations);
+    static void RecordOSCPacket(int surfaceId, int bytes, int messages);
+    static void RecordEuConInput(int surfaceId, int messages, int dispatched, int depth, int dropped);
+    
+    static bool IsInPhase(ProfilePhase phase) { return phaseDepths_[phase] > 0; }
+    static int EnterPhase(ProfilePhase phase) { int previousPhase = currentPhase_; currentPhase_ = phase; phaseDepths_[phase]++; return previousPhase; }
+    static void LeavePhase(ProfilePhase phase, int previousPhase) { currentPhase_ = previousPhase; phaseDepths_[phase]--; }
+    
+    // Totals for a phase across every surface since SetEnabled(true)
+    static PhaseStats GetPhaseStats(ProfilePhase phase);
+    
+    // Each DAW facade method registers its name once, see COUNT_DAW_CALL, methods registering the same name share a slot
+    static int RegisterDAWApi(const char* name);
+    
+    static void CountDAWCall(int api)
+    {
+        if(IsEnabled() && std::this_thread::get_id() == profiledThread_)
+        {
+            dawCallCount_++;
+            dawCalls_[currentPhase_][api]++;
+        }
+    }
+    
+    static long long GetDAWCallCount() { return dawCallCount_; }
+    static long long GetDAWCalls(int phase, int api) { return dawCalls_[phase][api]; }
+    
+    // Only fed when built with CSI_COUNT_ALLOCATIONS, which replaces the global operator new
+    static void CountAllocation() { if(IsEnabled()) allocationCount_.fetch_add(1, std::memory_order_relaxed); }
+    static long long GetAllocationCount() { return allocationCount_.load(std::memory_order_relaxed); }
+    
+    // Prints the report and writes it as JSON to profilePath, comparing against baselinePath when that file exists
+    static void Report(std::map<const void*, std::string> &actionNames, std::string profilePath, std::string baselinePath);
+};
+
+/////////////////////////////////////////////////
+class ProfileScope
+/////////////////////////////////////////////////
+{
+    // Times its own lifetime into a profiler phase, nested phases are included.
+    // A phase nested in itself, an included Zone's Activate say, is only counted by the outermost scope.
+private:
+    ProfilePhase const phase_;
+    int const surfaceId_;
+    bool const isActive_;
+    int previousPhase_ = NumProfilePhases;
+    long long startDAWCalls_ = 0;
+    long long startAllocations_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    
+public:
+    ProfileScope(ProfilePhase phase, int surfaceId = -1) : phase_(phase), surfaceId_(surfaceId), isActive_(CSIProfiler::IsEnabled() && ! CSIProfiler::IsInPhase(phase))
+    {
+        if(isActive_)
+        {
+            previousPhase_ = CSIProfiler::EnterPhase(phase);
+            startDAWCalls_ = CSIProfiler::GetDAWCallCount();
+            startAllocations_ = CSIProfiler::GetAllocationCount();
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    
+    ~ProfileScope()
+    {
+        if(isActive_)
+        {
+            double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_).count();
+            CSIProfiler::RecordPhase(phase_, surfaceId_, nanoseconds, CSIProfiler::GetDAWCallCount() - startDAWCalls_, CSIProfiler::GetAllocationCount() - startAllocations_);
+            CSIProfiler::LeavePhase(phase_, previousPhase_);
+        }
+    }
+};
+
+// Placed first in every DAW facade method with the name the report shows, the function local static resolves the API slot on the first call only
+#define COUNT_DAW_CALL(name) static const int dawApi_ = CSIProfiler::RegisterDAWApi(name); CSIProfiler::CountDAWCall(dawApi_)
+
 #endif /* ReportLoggingEtc_h */
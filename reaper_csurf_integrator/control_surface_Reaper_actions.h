@@ -30,8 +30,8 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            double min, max = 0;
-            double value = DAW::TrackFX_GetParam(track, context->GetZone()->GetSlotIndex(), context->GetParamIndex(), &min, &max);
+            double min = 0.0, max = 0.0;
+            double value = context->GetFXParams()->GetValue(track, context->GetZone()->GetSlotIndex(), context->GetParamIndex(), &min, &max);
             value +=  relativeValue;
             
             if(value < min) value = min;
@@ -49,32 +49,20 @@ class FocusedFXParam : public Action
 public:
     void RequestUpdate(ActionContext* context) override
     {
-        int trackNum = 0;
         int fxSlotNum = 0;
         int fxParamNum = 0;
         
-        if(DAW::GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
-        {
-            if(MediaTrack* track = context->GetTrackNavigationManager()->GetTrackFromId(trackNum))
-            {
-                double min = 0.0;
-                double max = 0.0;
-                double value = DAW::TrackFX_GetParam(track, fxSlotNum, fxParamNum, &min, &max);
-                
-                context->UpdateWidgetValue(value);
-            }
-        }
+        if(MediaTrack* track = context->GetTrackNavigationManager()->GetLastTouchedFXTrack(&fxSlotNum, &fxParamNum))
+            context->UpdateWidgetValue(context->GetFXParams()->GetValue(track, fxSlotNum, fxParamNum, nullptr, nullptr));
     }
     
     void Do(ActionContext* context, double value) override
     {
-        int trackNum = 0;
         int fxSlotNum = 0;
         int fxParamNum = 0;
         
-        if(DAW::GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
-            if(MediaTrack* track = context->GetTrackNavigationManager()->GetTrackFromId(trackNum))
-                DAW::TrackFX_SetParam(track, fxSlotNum, fxParamNum, value);
+        if(MediaTrack* track = context->GetTrackNavigationManager()->GetLastTouchedFXTrack(&fxSlotNum, &fxParamNum))
+            DAW::TrackFX_SetParam(track, fxSlotNum, fxParamNum, value);
     }
 };
 
@@ -86,11 +74,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-        {
-            double vol, pan = 0.0;
-            DAW::GetTrackUIVolPan(track, &vol, &pan);
-            context->UpdateWidgetValue(volToNormalized(vol));
-        }
+            context->UpdateWidgetValue(volToNormalizedFast(context->GetTrackStates()->GetUIVolume(track)));
         else
             context->ClearWidget();
     }
@@ -111,9 +95,7 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            double trackVolume, trackPan = 0.0;
-            DAW::GetTrackUIVolPan(track, &trackVolume, &trackPan);
-            trackVolume = volToNormalized(trackVolume);
+            double trackVolume = volToNormalizedFast(context->GetTrackStates()->GetUIVolume(track));
             
             if( fabs(value - trackVolume) < 0.025) // GAW -- Magic number -- ne touche pas
                 DAW::CSurf_SetSurfaceVolume(track, DAW::CSurf_OnVolumeChange(track, normalizedToVol(value), false), NULL);
@@ -130,9 +112,7 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            double trackVolume, trackPan = 0.0;
-            DAW::GetTrackUIVolPan(track, &trackVolume, &trackPan);
-            trackVolume = volToNormalized(trackVolume);
+            double trackVolume = volToNormalizedFast(context->GetTrackStates()->GetUIVolume(track));
             
             if( fabs(value - trackVolume) < 0.0025) // GAW -- Magic number -- ne touche pas
                 DAW::CSurf_SetSurfaceVolume(track, DAW::CSurf_OnVolumeChange(track, normalizedToVol(value), false), NULL);
@@ -148,11 +128,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-        {
-            double vol, pan = 0.0;
-            DAW::GetTrackUIVolPan(track, &vol, &pan);
-            context->UpdateWidgetValue(VAL2DB(vol));
-        }
+            context->UpdateWidgetValue(VAL2DB(context->GetTrackStates()->GetUIVolume(track)));
         else
             context->ClearWidget();
     }
@@ -172,11 +148,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-        {
-            double vol, pan = 0.0;
-            DAW::GetTrackUIVolPan(track, &vol, &pan);
-            context->UpdateWidgetValue(context->GetIntParam(), panToNormalized(pan));
-        }
+            context->UpdateWidgetValue(context->GetIntParam(), panToNormalized(context->GetTrackStates()->GetUIPan(track)));
         else
             context->ClearWidget();
     }
@@ -196,11 +168,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-        {
-            double vol, pan = 0.0;
-            DAW::GetTrackUIVolPan(track, &vol, &pan);
-            context->UpdateWidgetValue(pan * 100.0);
-        }
+            context->UpdateWidgetValue(context->GetTrackStates()->GetUIPan(track) * 100.0);
         else
             context->ClearWidget();
     }
@@ -220,7 +188,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(context->GetIntParam(), panToNormalized(DAW::GetMediaTrackInfo_Value(track, "D_WIDTH")));
+            context->UpdateWidgetValue(context->GetIntParam(), panToNormalized(context->GetTrackStates()->GetWidth(track)));
         else
             context->ClearWidget();
     }
@@ -240,7 +208,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(DAW::GetMediaTrackInfo_Value(track, "D_WIDTH") * 100.0);
+            context->UpdateWidgetValue(context->GetTrackStates()->GetWidth(track) * 100.0);
         else
             context->ClearWidget();
     }
@@ -307,9 +275,9 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            double vol, pan = 0.0;
+            double vol = 0.0, pan = 0.0;
             DAW::GetTrackSendUIVolPan(track, context->GetParamIndex(), &vol, &pan);
-            context->UpdateWidgetValue(volToNormalized(vol));
+            context->UpdateWidgetValue(volToNormalizedFast(vol));
         }
         else
             context->ClearWidget();
@@ -335,7 +303,7 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            double vol, pan = 0.0;
+            double vol = 0.0, pan = 0.0;
             DAW::GetTrackSendUIVolPan(track, context->GetParamIndex(), &vol, &pan);
             context->UpdateWidgetValue(VAL2DB(vol));
         }
@@ -364,7 +332,7 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            double vol, pan = 0.0;
+            double vol = 0.0, pan = 0.0;
             DAW::GetTrackSendUIVolPan(track, context->GetParamIndex(), &vol, &pan);
             context->UpdateWidgetValue(panToNormalized(pan));
         }
@@ -521,9 +489,7 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            char fxParamValue[128];
-            DAW::TrackFX_GetFormattedParamValue(track, context->GetSlotIndex(), context->GetParamIndex(), fxParamValue, sizeof(fxParamValue));
-            context->UpdateWidgetValue(string(fxParamValue));
+            context->UpdateWidgetValue(string(context->GetFXParams()->GetFormattedValue(track, context->GetSlotIndex(), context->GetParamIndex())));
         }
         else
             context->ClearWidget();
@@ -537,19 +503,11 @@ class FocusedFXParamNameDisplay : public Action
 public:
     virtual void RequestUpdate(ActionContext* context) override
     {
-        int trackNum = 0;
         int fxSlotNum = 0;
         int fxParamNum = 0;
         
-        if(DAW::GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
-        {
-            if(MediaTrack* track = context->GetTrackNavigationManager()->GetTrackFromId(trackNum))
-            {
-                char fxParamName[128];
-                DAW::TrackFX_GetParamName(track, fxSlotNum, fxParamNum, fxParamName, sizeof(fxParamName));
-                context->UpdateWidgetValue(string(fxParamName));
-            }
-        }
+        if(MediaTrack* track = context->GetTrackNavigationManager()->GetLastTouchedFXTrack(&fxSlotNum, &fxParamNum))
+            context->UpdateWidgetValue(string(context->GetFXParams()->GetName(track, fxSlotNum, fxParamNum)));
         else
             context->ClearWidget();
     }
@@ -562,19 +520,11 @@ class FocusedFXParamValueDisplay : public Action
 public:
     virtual void RequestUpdate(ActionContext* context) override
     {
-        int trackNum = 0;
         int fxSlotNum = 0;
         int fxParamNum = 0;
         
-        if(DAW::GetLastTouchedFX(&trackNum, &fxSlotNum, &fxParamNum))
-        {
-            if(MediaTrack* track = context->GetTrackNavigationManager()->GetTrackFromId(trackNum))
-            {
-                char fxParamValue[128];
-                DAW::TrackFX_GetFormattedParamValue(track, fxSlotNum, fxParamNum, fxParamValue, sizeof(fxParamValue));
-                context->UpdateWidgetValue(string(fxParamValue));
-            }
-        }
+        if(MediaTrack* track = context->GetTrackNavigationManager()->GetLastTouchedFXTrack(&fxSlotNum, &fxParamNum))
+            context->UpdateWidgetValue(string(context->GetFXParams()->GetFormattedValue(track, fxSlotNum, fxParamNum)));
         else
             context->ClearWidget();
     }
@@ -649,21 +599,12 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            char buf[BUFSZ];
+            const char* name = context->GetTrackAppearances()->GetName(track);
             
-            if(context->GetSurface()->GetIsEuConFXAreaFocused())
-            {
-                if(track == context->GetTrackNavigationManager()->GetSelectedTrack())
-                    DAW::GetTrackName(track, buf, sizeof(buf));
-                else
-                    buf[0] = 0;
-            }
-            else
-            {
-                DAW::GetTrackName(track, buf, sizeof(buf));
-            }
+            if(context->GetSurface()->GetIsEuConFXAreaFocused() && track != context->GetTrackNavigationManager()->GetSelectedTrack())
+                name = "";
             
-            context->UpdateWidgetValue(string(buf));
+            context->UpdateWidgetValue(string(name));
         }
         else
             context->ClearWidget();
@@ -680,7 +621,7 @@ public:
         if(MediaTrack* track = context->GetTrack())
         {
             char trackVolume[128];
-            snprintf(trackVolume, sizeof(trackVolume), "%7.2lf", VAL2DB(DAW::GetMediaTrackInfo_Value(track, "D_VOL")));
+            snprintf(trackVolume, sizeof(trackVolume), "%7.2lf", VAL2DB(context->GetTrackStates()->GetVolume(track)));
             context->UpdateWidgetValue(string(trackVolume));
         }
         else
@@ -699,7 +640,7 @@ public:
         {
             bool left = false;
             
-            double panVal = DAW::GetMediaTrackInfo_Value(track, "D_PAN");
+            double panVal = context->GetTrackStates()->GetPan(track);
             
             if(panVal < 0)
             {
@@ -756,7 +697,7 @@ public:
         {
             bool reversed = false;
             
-            double widthVal = DAW::GetMediaTrackInfo_Value(track, "D_WIDTH");
+            double widthVal = context->GetTrackStates()->GetWidth(track);
             
             if(widthVal < 0)
             {
@@ -898,7 +839,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(DAW::GetMediaTrackInfo_Value(track, "I_SELECTED"));
+            context->UpdateWidgetValue(context->GetTrackStates()->GetSelected(track));
         else
             context->ClearWidget();
     }
@@ -909,7 +850,7 @@ public:
 
         if(MediaTrack* track = context->GetTrack())
         {
-            DAW::CSurf_SetSurfaceSelected(track, DAW::CSurf_OnSelectedChange(track, ! DAW::GetMediaTrackInfo_Value(track, "I_SELECTED")), NULL);
+            DAW::CSurf_SetSurfaceSelected(track, DAW::CSurf_OnSelectedChange(track, ! context->GetTrackStates()->GetSelected(track)), NULL);
             context->GetPage()->OnTrackSelectionBySurface(track);
         }
     }
@@ -923,7 +864,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(DAW::GetMediaTrackInfo_Value(track, "I_SELECTED"));
+            context->UpdateWidgetValue(context->GetTrackStates()->GetSelected(track));
         else
             context->ClearWidget();
     }
@@ -948,7 +889,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(DAW::GetMediaTrackInfo_Value(track, "I_SELECTED"));
+            context->UpdateWidgetValue(context->GetTrackStates()->GetSelected(track));
         else
             context->ClearWidget();
     }
@@ -1012,7 +953,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(DAW::GetMediaTrackInfo_Value(track, "I_RECARM"));
+            context->UpdateWidgetValue(context->GetTrackStates()->GetRecordArm(track));
         else
             context->ClearWidget();
     }
@@ -1023,7 +964,7 @@ public:
         
         if(MediaTrack* track = context->GetTrack())
         {
-            DAW::CSurf_SetSurfaceRecArm(track, DAW::CSurf_OnRecArmChange(track, ! DAW::GetMediaTrackInfo_Value(track, "I_RECARM")), NULL);
+            DAW::CSurf_SetSurfaceRecArm(track, DAW::CSurf_OnRecArmChange(track, ! context->GetTrackStates()->GetRecordArm(track)), NULL);
         }
     }
 };
@@ -1036,11 +977,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-        {
-            bool mute = false;
-            DAW::GetTrackUIMute(track, &mute);
-            context->UpdateWidgetValue(mute);
-        }
+            context->UpdateWidgetValue(context->GetTrackStates()->GetUIMute(track));
         else
             context->ClearWidget();
     }
@@ -1051,9 +988,7 @@ public:
         
         if(MediaTrack* track = context->GetTrack())
         {
-            bool mute = false;
-            DAW::GetTrackUIMute(track, &mute);
-            DAW::CSurf_SetSurfaceMute(track, DAW::CSurf_OnMuteChange(track, ! mute), NULL);
+            DAW::CSurf_SetSurfaceMute(track, DAW::CSurf_OnMuteChange(track, ! context->GetTrackStates()->GetUIMute(track)), NULL);
         }
     }
 };
@@ -1066,7 +1001,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(DAW::GetMediaTrackInfo_Value(track, "I_SOLO"));
+            context->UpdateWidgetValue(context->GetTrackStates()->GetSolo(track));
         else
             context->ClearWidget();
     }
@@ -1077,7 +1012,7 @@ public:
         
         if(MediaTrack* track = context->GetTrack())
         {
-            DAW::CSurf_SetSurfaceSolo(track, DAW::CSurf_OnSoloChange(track, ! DAW::GetMediaTrackInfo_Value(track, "I_SOLO")), NULL);
+            DAW::CSurf_SetSurfaceSolo(track, DAW::CSurf_OnSoloChange(track, ! context->GetTrackStates()->GetSolo(track)), NULL);
         }
     }
 };
@@ -1131,7 +1066,7 @@ public:
     {
         if(MediaTrack* selectedTrack = context->GetTrackNavigationManager()->GetSelectedTrack())
         {
-            if(context->GetIntParam() == DAW::GetMediaTrackInfo_Value(selectedTrack, "I_AUTOMODE"))
+            if(context->GetIntParam() == context->GetTrackStates()->GetAutoMode(selectedTrack))
                 context->UpdateWidgetValue(1.0);
             else
                 context->UpdateWidgetValue(0.0);
@@ -1312,7 +1247,7 @@ public:
     void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(volToNormalized(DAW::Track_GetPeakInfo(track, context->GetIntParam())));
+            context->UpdateWidgetValue(peakToNormalizedMeter(DAW::Track_GetPeakInfo(track, context->GetIntParam())));
         else
             context->ClearWidget();
     }
@@ -1329,7 +1264,7 @@ public:
         {
             double lrVol = (DAW::Track_GetPeakInfo(track, 0) + DAW::Track_GetPeakInfo(track, 1)) / 2.0;
             
-            context->UpdateWidgetValue(volToNormalized(lrVol));
+            context->UpdateWidgetValue(peakToNormalizedMeter(lrVol));
         }
         else
             context->ClearWidget();
@@ -1350,7 +1285,7 @@ public:
             
             double lrVol =  lVol > rVol ? lVol : rVol;
             
-            context->UpdateWidgetValue(volToNormalized(lrVol));
+            context->UpdateWidgetValue(peakToNormalizedMeter(lrVol));
         }
         else
             context->ClearWidget();
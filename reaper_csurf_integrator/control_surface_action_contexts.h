@@ -35,6 +35,18 @@ public:
         if(value != 0)
             DAW::SendCommandMessage(context->GetCommandId());
     }
+    
+    virtual void DoString(ActionContext* context, string value) override
+    {
+        // A command id, or a named command such as _SWS_ABOUT
+        int commandId = atoi(value.c_str());
+        
+        if(commandId == 0)
+            commandId = DAW::NamedCommandLookup(value.c_str());
+        
+        if(commandId != 0)
+            DAW::SendCommandMessage(commandId);
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -47,7 +59,7 @@ public:
         if(MediaTrack* track = context->GetTrack())
         {
             double min, max = 0.0;
-            double currentValue = DAW::TrackFX_GetParam(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max);
+            double currentValue = context->GetFXParams()->GetValue(track, context->GetSlotIndex(), context->GetParamIndex(), &min, &max);
             
             if(context->GetShouldUseDisplayStyle())
                 context->UpdateWidgetValue(context->GetDisplayStyle(), currentValue);
@@ -11,6 +11,10 @@
 #include "control_surface_manager_actions.h"
 #include "control_surface_integrator_ui.h"
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
 extern reaper_plugin_info_t *g_reaper_plugin_info;
 
 string GetLineEnding()
@@ -50,107 +54,1810 @@ static map<int, MidiOutputPort*> midiOutputs_;
 
 static midi_Input* GetMidiInputForPort(int inputPort)
 {
-    if(midiInputs_.count(inputPort) > 0)
-        return midiInputs_[inputPort]->midiInput_; // return existing
+    if(midiInputs_.count(inputPort) > 0)
+        return midiInputs_[inputPort]->midiInput_; // return existing
+    
+    // otherwise make new
+    midi_Input* newInput = DAW::CreateMIDIInput(inputPort);
+    
+    if(newInput)
+    {
+        newInput->start();
+        midiInputs_[inputPort] = new MidiInputPort(inputPort, newInput);
+        return newInput;
+    }
+    
+    return nullptr;
+}
+
+static midi_Output* GetMidiOutputForPort(int outputPort)
+{
+    if(midiOutputs_.count(outputPort) > 0)
+        return midiOutputs_[outputPort]->midiOutput_; // return existing
+    
+    // otherwise make new
+    midi_Output* newOutput = DAW::CreateMIDIOutput(outputPort, false, NULL);
+    
+    if(newOutput)
+    {
+        midiOutputs_[outputPort] = new MidiOutputPort(outputPort, newOutput);
+        return newOutput;
+    }
+    
+    return nullptr;
+}
+
+void ShutdownMidiIO()
+{
+    for(auto [index, input] : midiInputs_)
+        input->midiInput_->stop();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OSC I/O Manager
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static map<string, oscpkt::UdpSocket*> inputSockets_;
+static map<string, oscpkt::UdpSocket*> outputSockets_;
+static map<string, oscpkt::UdpSocket*> clientOutputSockets_;
+
+static oscpkt::UdpSocket* GetInputSocketForPort(string surfaceName, int inputPort)
+{
+    if(inputSockets_.count(surfaceName) > 0)
+        return inputSockets_[surfaceName]; // return existing
+    
+    // otherwise make new
+    oscpkt::UdpSocket* newInputSocket = new oscpkt::UdpSocket();
+    
+    if(newInputSocket)
+    {
+        newInputSocket->bindTo(inputPort);
+        
+        if (! newInputSocket->isOk())
+        {
+            //cerr << "Error opening port " << PORT_NUM << ": " << inSocket_.errorMessage() << "\n";
+            return nullptr;
+        }
+        
+        inputSockets_[surfaceName] = newInputSocket;
+        
+        return inputSockets_[surfaceName];
+    }
+    
+    return nullptr;
+}
+
+// Multi-client surfaces send with sendto from one unconnected socket to each client in turn
+static oscpkt::UdpSocket* GetOutputSocketForClients(string surfaceName)
+{
+    if(clientOutputSockets_.count(surfaceName) > 0)
+        return clientOutputSockets_[surfaceName]; // return existing
+    
+    // otherwise make new
+    oscpkt::UdpSocket* newOutputSocket = new oscpkt::UdpSocket();
+    
+    if(newOutputSocket)
+    {
+        newOutputSocket->bindTo(0); // any free port, clients reply to the surface's input port
+        
+        if ( ! newOutputSocket->isOk())
+            return nullptr;
+        
+        clientOutputSockets_[surfaceName] = newOutputSocket;
+        
+        return clientOutputSockets_[surfaceName];
+    }
+    
+    return nullptr;
+}
+
+static oscpkt::UdpSocket* GetOutputSocketForAddressAndPort(string surfaceName, string address, int outputPort)
+{
+    if(outputSockets_.count(surfaceName) > 0)
+        return outputSockets_[surfaceName]; // return existing
+    
+    // otherwise make new
+    oscpkt::UdpSocket* newOutputSocket = new oscpkt::UdpSocket();
+    
+    if(newOutputSocket)
+    {
+        if( ! newOutputSocket->connectTo(address, outputPort))
+        {
+            //cerr << "Error connecting " << remoteDeviceIP_ << ": " << outSocket_.errorMessage() << "\n";
+            return nullptr;
+        }
+        
+        newOutputSocket->bindTo(outputPort);
+        
+        if ( ! newOutputSocket->isOk())
+        {
+            //cerr << "Error opening port " << outPort_ << ": " << outSocket_.errorMessage() << "\n";
+            return nullptr;
+        }
+
+        outputSockets_[surfaceName] = newOutputSocket;
+        
+        return outputSockets_[surfaceName];
+    }
+    
+    return nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OSCAddressMatcher
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Splits off the first segment of an address, "/a/b" gives "a" and leaves "/b"
+static string_view PopOSCSegment(string_view &path)
+{
+    if(path.size() > 0 && path[0] == '/')
+        path.remove_prefix(1);
+    
+    size_t end = path.find('/');
+    string_view segment = path.substr(0, end);
+    path.remove_prefix(end == string_view::npos ? path.size() : end);
+    
+    return segment;
+}
+
+bool OSCAddressMatcher::MatchSegment(string_view pattern, string_view text)
+{
+    while(pattern.size() > 0)
+    {
+        char c = pattern[0];
+        
+        if(c == '*')
+        {
+            pattern.remove_prefix(1);
+            
+            for(size_t i = 0; i <= text.size(); i++)
+                if(MatchSegment(pattern, text.substr(i)))
+                    return true;
+            
+            return false;
+        }
+        
+        if(text.size() == 0)
+            return false;
+        
+        if(c == '[')
+        {
+            size_t end = pattern.find(']');
+            
+            if(end == string_view::npos)
+                return false;
+            
+            string_view set = pattern.substr(1, end - 1);
+            bool isNegated = set.size() > 0 && set[0] == '!';
+            bool isInSet = false;
+            
+            if(isNegated)
+                set.remove_prefix(1);
+            
+            for(size_t i = 0; i < set.size(); i++)
+            {
+                if(i + 2 < set.size() && set[i + 1] == '-')
+                {
+                    if(text[0] >= set[i] && text[0] <= set[i + 2])
+                        isInSet = true;
+                    
+                    i += 2;
+                }
+                else if(text[0] == set[i])
+                    isInSet = true;
+            }
+            
+            if(isInSet == isNegated)
+                return false;
+            
+            pattern.remove_prefix(end + 1);
+            text.remove_prefix(1);
+        }
+        else if(c == '{')
+        {
+            size_t end = pattern.find('}');
+            
+            if(end == string_view::npos)
+                return false;
+            
+            string_view alternatives = pattern.substr(1, end - 1);
+            string_view rest = pattern.substr(end + 1);
+            
+            while(true)
+            {
+                size_t comma = alternatives.find(',');
+                string_view alternative = alternatives.substr(0, comma);
+                
+                if(text.substr(0, alternative.size()) == alternative && MatchSegment(rest, text.substr(alternative.size())))
+                    return true;
+                
+                if(comma == string_view::npos)
+                    return false;
+                
+                alternatives.remove_prefix(comma + 1);
+            }
+        }
+        else if(c == '?' || c == text[0])
+        {
+            pattern.remove_prefix(1);
+            text.remove_prefix(1);
+        }
+        else
+            return false;
+    }
+    
+    return text.size() == 0;
+}
+
+bool OSCAddressMatcher::MatchPath(string_view pattern, string_view path)
+{
+    while(pattern.size() > 0 && path.size() > 0)
+        if( ! MatchSegment(PopOSCSegment(pattern), PopOSCSegment(path)))
+            return false;
+    
+    return pattern.size() == 0 && path.size() == 0;
+}
+
+int OSCAddressMatcher::FindLiteralChild(int node, string_view segment)
+{
+    const vector<pair<string, int>> &children = nodes_[node].literalChildren;
+    
+    auto child = lower_bound(children.begin(), children.end(), segment, [](const pair<string, int> &child, string_view segment) { return string_view(child.first) < segment; });
+    
+    return child != children.end() && string_view(child->first) == segment ? child->second : -1;
+}
+
+void OSCAddressMatcher::Add(const string &address, int addressId)
+{
+    string_view path(address);
+    int node = 0;
+    
+    while(path.size() > 0)
+    {
+        string_view segment = PopOSCSegment(path);
+        bool isPattern = IsPattern(segment);
+        vector<pair<string, int>> &children = isPattern ? nodes_[node].patternChildren : nodes_[node].literalChildren;
+        
+        int child = -1;
+        
+        for(auto &[childSegment, childNode] : children)
+            if(childSegment == segment)
+                child = childNode;
+        
+        if(child < 0)
+        {
+            child = nodes_.size();
+            nodes_.push_back(Node());
+            
+            // nodes_ may have moved, so look the children up again
+            vector<pair<string, int>> &siblings = isPattern ? nodes_[node].patternChildren : nodes_[node].literalChildren;
+            siblings.push_back(make_pair(string(segment), child));
+            
+            if( ! isPattern)
+                sort(siblings.begin(), siblings.end());
+        }
+        
+        hasPatterns_ = hasPatterns_ || isPattern;
+        node = child;
+    }
+    
+    nodes_[node].addressId = addressId;
+    
+    if( ! IsPattern(address))
+        literalAddresses_.push_back(make_pair(address, addressId));
+}
+
+void OSCAddressMatcher::MatchPatterns(int node, string_view path, int* addressIds, int maxAddressIds, int &count)
+{
+    if(path.size() == 0)
+    {
+        if(nodes_[node].addressId >= 0 && count < maxAddressIds)
+            addressIds[count++] = nodes_[node].addressId;
+        
+        return;
+    }
+    
+    string_view segment = PopOSCSegment(path);
+    
+    int child = FindLiteralChild(node, segment);
+    
+    if(child >= 0)
+        MatchPatterns(child, path, addressIds, maxAddressIds, count);
+    
+    for(auto &[childSegment, childNode] : nodes_[node].patternChildren)
+        if(MatchSegment(childSegment, segment))
+            MatchPatterns(childNode, path, addressIds, maxAddressIds, count);
+}
+
+int OSCAddressMatcher::Match(string_view address, int* addressIds, int maxAddressIds)
+{
+    if(maxAddressIds < 1)
+        return 0;
+    
+    if(IsPattern(address)) // the sender addressed several widgets at once
+    {
+        int count = 0;
+        
+        for(auto &[literalAddress, addressId] : literalAddresses_)
+            if(count < maxAddressIds && MatchPath(address, literalAddress))
+                addressIds[count++] = addressId;
+        
+        return count;
+    }
+    
+    // Exact match, one binary search per segment
+    string_view path = address;
+    int node = 0;
+    
+    while(node >= 0 && path.size() > 0)
+        node = FindLiteralChild(node, PopOSCSegment(path));
+    
+    if(node >= 0 && nodes_[node].addressId >= 0)
+    {
+        addressIds[0] = nodes_[node].addressId;
+        return 1;
+    }
+    
+    int count = 0;
+    
+    if(hasPatterns_)
+        MatchPatterns(0, address, addressIds, maxAddressIds, count);
+    
+    return count;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OSCArguments
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OSCArguments::Read(const oscpkt::Message &message)
+{
+    // Strings and blobs are read straight out of the message storage, nothing here allocates
+    numArguments = 0;
+    stringArgumentIndex = -1;
+    isStringTruncated = false;
+    
+    oscpkt::Message::ArgReader reader = message.arg();
+    
+    while(reader.isOk() && reader.nbArgRemaining() > 0 && numArguments < MaxOSCArguments)
+    {
+        double &value = values[numArguments];
+        value = 0.0;
+        isNumeric[numArguments] = reader.isFloat() || reader.isInt32() || reader.isInt64() || reader.isDouble() || reader.isBool();
+        
+        if(reader.isFloat())
+        {
+            float floatValue = 0.0;
+            reader.popFloat(floatValue);
+            value = floatValue;
+        }
+        else if(reader.isInt32())
+        {
+            int32_t intValue = 0;
+            reader.popInt32(intValue);
+            value = intValue;
+        }
+        else if(reader.isInt64())
+        {
+            int64_t intValue = 0;
+            reader.popInt64(intValue);
+            value = intValue;
+        }
+        else if(reader.isDouble())
+            reader.popDouble(value);
+        else if(reader.isBool())
+        {
+            bool boolValue = false;
+            reader.popBool(boolValue);
+            value = boolValue ? 1.0 : 0.0;
+        }
+        else if(reader.isStr())
+        {
+            const char* text = nullptr;
+            reader.popStr(text);
+            
+            if(stringArgumentIndex < 0 && text != nullptr)
+            {
+                stringArgumentIndex = numArguments;
+                isStringTruncated = snprintf(stringValue, sizeof(stringValue), "%s", text) >= (int)sizeof(stringValue);
+            }
+        }
+        else if(reader.isBlob())
+        {
+            const char* data = nullptr;
+            size_t size = 0;
+            reader.popBlob(data, size); // holds its place, no action takes raw bytes
+        }
+        else
+            reader.pop();
+        
+        if(reader.isOk())
+            numArguments++;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OSCInputThread
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Run() used to poll each input socket with its own select() on the main thread, now it only drains decoded messages.
+static const int OSCInputWaitMilliseconds = 50; // also bounds how long Shutdown waits for the thread
+
+static const double OSCClientReportInterval = 1000.0; // ms, how often a sender is passed on to a multi-client surface
+static const int MaxOSCReportedClients = 64;
+
+struct OSCInputTarget
+{
+    OSCInputQueue* queue = nullptr;
+    OSCAddressMatcher addressMatcher;
+};
+
+struct OSCInputEntry
+{
+    oscpkt::UdpSocket* socket = nullptr;
+    vector<OSCInputTarget*> targets; // one per page with a surface on the socket
+    OSCInputTarget* activeTarget = nullptr; // the current page's, nullptr drops what arrives
+    vector<pair<oscpkt::SockAddr, double>> reportedClients; // when each sender was last passed on to activeTarget
+};
+
+static WDL_Mutex oscInputMutex_; // guards oscInputEntries_, held by the thread while it decodes
+static map<int, OSCInputEntry> oscInputEntries_; // by socket handle
+static thread oscInputThread_;
+static atomic<bool> oscInputShouldRun_(false);
+
+#ifdef __linux__
+static int oscInputEpoll_ = -1;
+#endif
+
+static void DecodeOSCPacket(OSCInputEntry &entry, oscpkt::PacketReader &packetReader, const void* data, int size, double timestamp)
+{
+    OSCInputTarget* target = entry.activeTarget;
+    
+    if(target == nullptr)
+        return;
+    
+    packetReader.init(data, size);
+    oscpkt::Message *message;
+    
+    int addressIds[MaxOSCMatches];
+    
+    while (packetReader.isOk() && (message = packetReader.popMessage()) != 0)
+    {
+        OSCInputRecord record;
+        
+        record.arguments.Read(*message);
+        
+        if(record.arguments.numArguments == 0 && message->addressPattern() != OSCResyncAddress)
+            continue;
+        
+        record.timestamp = timestamp;
+        
+        int numMatches = target->addressMatcher.Match(message->addressPattern(), addressIds, MaxOSCMatches);
+        
+        if(numMatches == 0)
+        {
+            snprintf(record.address, sizeof(record.address), "%s", message->addressPattern().c_str());
+            target->queue->Push(record);
+        }
+        
+        for(int i = 0; i < numMatches; i++)
+        {
+            record.addressId = addressIds[i];
+            target->queue->Push(record);
+        }
+    }
+}
+
+static void ReportOSCClient(OSCInputEntry &entry, const oscpkt::SockAddr &origin, double timestamp)
+{
+    if(entry.activeTarget == nullptr)
+        return;
+    
+    OSCInputQueue* queue = entry.activeTarget->queue;
+    
+    for(auto &[client, lastReported] : entry.reportedClients)
+    {
+        if(client.actualLen() == origin.actualLen() && memcmp(&client.addr(), &origin.addr(), origin.actualLen()) == 0)
+        {
+            if(timestamp - lastReported > OSCClientReportInterval && queue->PushClient(origin))
+                lastReported = timestamp;
+            
+            return;
+        }
+    }
+    
+    if(entry.reportedClients.size() >= MaxOSCReportedClients)
+        entry.reportedClients.clear(); // start over, at worst everyone is reported once more
+    
+    if(queue->PushClient(origin))
+        entry.reportedClients.push_back(make_pair(origin, timestamp));
+}
+
+static void DrainOSCSocket(OSCInputEntry &entry, oscpkt::PacketReader &packetReader)
+{
+#ifdef __linux__
+    // epoll already said it is readable, read until the socket is empty without a select per packet
+    static char buffer[1024 * 64];
+    oscpkt::SockAddr origin;
+    socklen_t originLength = origin.maxLen();
+    int size = 0;
+    
+    while((size = (int)recvfrom(entry.socket->socketHandle(), buffer, sizeof(buffer), MSG_DONTWAIT, &origin.addr(), &originLength)) > 0)
+    {
+        double timestamp = CSIProfiler::GetTimestamp();
+        
+        ReportOSCClient(entry, origin, timestamp);
+        DecodeOSCPacket(entry, packetReader, buffer, size, timestamp);
+        originLength = origin.maxLen();
+    }
+#else
+    while(entry.socket->receiveNextPacket(0))
+    {
+        double timestamp = CSIProfiler::GetTimestamp();
+        
+        ReportOSCClient(entry, entry.socket->packetOrigin(), timestamp);
+        DecodeOSCPacket(entry, packetReader, entry.socket->packetData(), entry.socket->packetSize(), timestamp);
+    }
+#endif
+}
+
+static void RunOSCInput()
+{
+    oscpkt::PacketReader packetReader;
+    
+    while(oscInputShouldRun_)
+    {
+#ifdef __linux__
+        epoll_event events[16];
+        int numEvents = epoll_wait(oscInputEpoll_, events, 16, OSCInputWaitMilliseconds);
+        
+        WDL_MutexLock lock(&oscInputMutex_);
+        
+        for(int i = 0; i < numEvents; i++)
+            if(oscInputEntries_.count(events[i].data.fd) > 0)
+                DrainOSCSocket(oscInputEntries_[events[i].data.fd], packetReader);
+#else
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        int maxHandle = -1;
+        
+        {
+            WDL_MutexLock lock(&oscInputMutex_);
+            
+            for(auto &[handle, entry] : oscInputEntries_)
+            {
+                FD_SET(handle, &readSet);
+                maxHandle = max(maxHandle, handle);
+            }
+        }
+        
+        struct timeval timeout = { 0, OSCInputWaitMilliseconds * 1000 };
+        
+        if(maxHandle < 0 || select(maxHandle + 1, &readSet, 0, 0, &timeout) <= 0)
+        {
+            if(maxHandle < 0)
+                this_thread::sleep_for(chrono::milliseconds(OSCInputWaitMilliseconds));
+            
+            continue;
+        }
+        
+        WDL_MutexLock lock(&oscInputMutex_);
+        
+        for(auto &[handle, entry] : oscInputEntries_)
+            if(FD_ISSET(handle, &readSet))
+                DrainOSCSocket(entry, packetReader);
+#endif
+    }
+}
+
+void OSCInputThread::Register(oscpkt::UdpSocket* socket, OSCInputQueue* queue, const vector<string> &addresses)
+{
+    WDL_MutexLock lock(&oscInputMutex_);
+    
+    int handle = socket->socketHandle();
+#ifdef __linux__
+    bool isNew = oscInputEntries_.count(handle) < 1;
+#endif
+    
+    // Fed once its page is entered, see Activate
+    OSCInputEntry &entry = oscInputEntries_[handle];
+    entry.socket = socket;
+    
+    OSCInputTarget* target = new OSCInputTarget();
+    target->queue = queue;
+    
+    for(int i = 0; i < addresses.size(); i++)
+        target->addressMatcher.Add(addresses[i], i);
+    
+    entry.targets.push_back(target);
+    
+#ifdef __linux__
+    if(oscInputEpoll_ < 0)
+        oscInputEpoll_ = epoll_create1(0);
+    
+    if(isNew)
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = handle;
+        epoll_ctl(oscInputEpoll_, EPOLL_CTL_ADD, handle, &event);
+    }
+#endif
+    
+    if( ! oscInputShouldRun_)
+    {
+        oscInputShouldRun_ = true;
+        oscInputThread_ = thread(RunOSCInput);
+    }
+}
+
+static OSCInputEntry* FindOSCInputEntry(OSCInputQueue* queue, int &targetIndex)
+{
+    for(auto &[handle, entry] : oscInputEntries_)
+    {
+        for(targetIndex = 0; targetIndex < entry.targets.size(); targetIndex++)
+            if(entry.targets[targetIndex]->queue == queue)
+                return &entry;
+    }
+    
+    return nullptr;
+}
+
+void OSCInputThread::Unregister(OSCInputQueue* queue)
+{
+    WDL_MutexLock lock(&oscInputMutex_);
+    
+    int targetIndex = 0;
+    OSCInputEntry* entry = FindOSCInputEntry(queue, targetIndex);
+    
+    if(entry == nullptr)
+        return;
+    
+    OSCInputTarget* target = entry->targets[targetIndex];
+    
+    if(entry->activeTarget == target)
+        entry->activeTarget = nullptr;
+    
+    entry->targets.erase(entry->targets.begin() + targetIndex);
+    delete target;
+    
+    if(entry->targets.size() == 0)
+    {
+        int handle = entry->socket->socketHandle();
+#ifdef __linux__
+        epoll_ctl(oscInputEpoll_, EPOLL_CTL_DEL, handle, nullptr);
+#endif
+        oscInputEntries_.erase(handle);
+    }
+}
+
+void OSCInputThread::Activate(OSCInputQueue* queue)
+{
+    WDL_MutexLock lock(&oscInputMutex_);
+    
+    int targetIndex = 0;
+    
+    if(OSCInputEntry* entry = FindOSCInputEntry(queue, targetIndex))
+    {
+        entry->activeTarget = entry->targets[targetIndex];
+        entry->reportedClients.clear(); // the new page's surface hears about every sender again
+    }
+}
+
+void OSCInputThread::Deactivate(OSCInputQueue* queue)
+{
+    WDL_MutexLock lock(&oscInputMutex_);
+    
+    int targetIndex = 0;
+    OSCInputEntry* entry = FindOSCInputEntry(queue, targetIndex);
+    
+    if(entry != nullptr && entry->activeTarget == entry->targets[targetIndex])
+        entry->activeTarget = nullptr;
+}
+
+void OSCInputThread::Shutdown()
+{
+    if(oscInputShouldRun_)
+    {
+        oscInputShouldRun_ = false;
+        oscInputThread_.join();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CSITrace
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Surfaces write fixed size records into a bounded lock free ring, the formatter thread turns them into text.
+// Nothing in the hot path allocates, formats or touches the console.
+static const int TraceRingSize = 16384; // must be a power of 2
+static const int TraceHistorySize = 16384;
+static const int TraceMaxConsoleText = 1024 * 1024;
+
+struct TraceSlot
+{
+    atomic<size_t> sequence;
+    TraceRecord record;
+};
+
+atomic<int> CSITrace::enabledDirections_(0);
+
+static TraceSlot traceRing_[TraceRingSize];
+static atomic<size_t> traceWritePosition_(0);
+static size_t traceReadPosition_ = 0; // formatter thread only
+static atomic<int> traceDropped_(0);
+static atomic<int> traceConsoleDirections_(0);
+
+static WDL_Mutex traceMutex_; // guards everything below
+static vector<string> traceNames_;
+static map<string, int> traceIdsByName_;
+static vector<TraceRecord> traceHistory_;
+static int traceHistoryPosition_ = 0;
+static string traceConsoleText_;
+
+static thread traceFormatter_;
+static atomic<bool> traceFormatterShouldRun_(false);
+
+static void PushTraceRecord(const TraceRecord &record)
+{
+    size_t position = traceWritePosition_.load(memory_order_relaxed);
+    
+    while(true)
+    {
+        TraceSlot &slot = traceRing_[position & (TraceRingSize - 1)];
+        intptr_t difference = (intptr_t)slot.sequence.load(memory_order_acquire) - (intptr_t)position;
+        
+        if(difference == 0)
+        {
+            if(traceWritePosition_.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+            {
+                slot.record = record;
+                slot.sequence.store(position + 1, memory_order_release);
+                return;
+            }
+        }
+        else if(difference < 0)
+        {
+            traceDropped_++; // formatter is behind, losing a trace line beats stalling the surface
+            return;
+        }
+        else
+            position = traceWritePosition_.load(memory_order_relaxed);
+    }
+}
+
+static bool PopTraceRecord(TraceRecord &record)
+{
+    TraceSlot &slot = traceRing_[traceReadPosition_ & (TraceRingSize - 1)];
+    
+    if(slot.sequence.load(memory_order_acquire) != traceReadPosition_ + 1)
+        return false;
+    
+    record = slot.record;
+    slot.sequence.store(traceReadPosition_ + TraceRingSize, memory_order_release);
+    traceReadPosition_++;
+    
+    return true;
+}
+
+static TraceDirection GetTraceDirection(int kind)
+{
+    if(kind == TraceWidgetInput || kind == TraceMidiInput || kind == TraceOSCInput || kind == TraceEuConInput)
+        return TraceInput;
+    else
+        return TraceOutput;
+}
+
+// Call with traceMutex_ held
+static void FormatTraceRecord(const TraceRecord &record, char *buffer, int bufferSize)
+{
+    const char* surfaceName = record.surfaceId < traceNames_.size() ? traceNames_[record.surfaceId].c_str() : "";
+    const char* widgetName = record.widgetId < traceNames_.size() ? traceNames_[record.widgetId].c_str() : "";
+    const char* address = record.data;
+    const char* text = record.data + strlen(record.data) + 1;
+    const unsigned char* bytes = (const unsigned char*)record.data;
+    
+    switch(record.kind)
+    {
+        case TraceWidgetInput:
+            snprintf(buffer, bufferSize, "IN <- %s %s %f\n", surfaceName, widgetName, record.value);
+            break;
+            
+        case TraceMidiInput:
+            snprintf(buffer, bufferSize, "IN <- %s %02x  %02x  %02x \n", surfaceName, bytes[0], bytes[1], bytes[2]);
+            break;
+            
+        case TraceMidiOutput:
+            snprintf(buffer, bufferSize, "OUT->%s  %02x  %02x  %02x \n", surfaceName, bytes[0], bytes[1], bytes[2]);
+            break;
+            
+        case TraceSysExOutput:
+        {
+            int length = snprintf(buffer, bufferSize, "OUT->%s SysEx", surfaceName);
+            
+            for(int i = 0; i < record.size && length < bufferSize - 4; i++)
+                length += snprintf(buffer + length, bufferSize - length, " %02x", bytes[i]);
+            
+            snprintf(buffer + length, bufferSize - length, "\n");
+            break;
+        }
+            
+        case TraceOSCInput:
+        case TraceEuConInput:
+            if(record.hasValue)
+                snprintf(buffer, bufferSize, "IN <- %s %s  %f  \n", surfaceName, address, record.value);
+            else
+                snprintf(buffer, bufferSize, "IN <- %s %s  %s  \n", surfaceName, address, text);
+            break;
+            
+        case TraceOSCOutput:
+        case TraceEuConOutput:
+            if(record.hasValue)
+                snprintf(buffer, bufferSize, "OUT->%s %s %f\n", surfaceName, address, record.value);
+            else
+                snprintf(buffer, bufferSize, "OUT->%s %s %s\n", surfaceName, address, text);
+            break;
+            
+        case TraceZoneLoad:
+            snprintf(buffer, bufferSize, "%s->LoadingZone---->%s\n", address, surfaceName);
+            break;
+            
+        default:
+            buffer[0] = 0;
+            break;
+    }
+    
+    if(record.isTruncated)
+    {
+        int length = strlen(buffer);
+        
+        if(length > 0 && buffer[length - 1] == '\n')
+            length--;
+        
+        snprintf(buffer + length, bufferSize - length, " [truncated]\n");
+    }
+}
+
+static void DrainTraceRing()
+{
+    TraceRecord record;
+    char buffer[BUFSZ];
+    int consoleDirections = traceConsoleDirections_.load();
+    
+    WDL_MutexLock lock(&traceMutex_);
+    
+    while(PopTraceRecord(record))
+    {
+        if(traceHistory_.size() < TraceHistorySize)
+            traceHistory_.push_back(record);
+        else
+            traceHistory_[traceHistoryPosition_] = record;
+        
+        traceHistoryPosition_ = (traceHistoryPosition_ + 1) % TraceHistorySize;
+        
+        if((consoleDirections & GetTraceDirection(record.kind)) && traceConsoleText_.size() < TraceMaxConsoleText)
+        {
+            FormatTraceRecord(record, buffer, sizeof(buffer));
+            traceConsoleText_ += buffer;
+        }
+    }
+}
+
+static void RunTraceFormatter()
+{
+    while(traceFormatterShouldRun_)
+    {
+        DrainTraceRing();
+        this_thread::sleep_for(chrono::milliseconds(20));
+    }
+}
+
+void CSITrace::SetEnabled(int directions, int consoleDirections)
+{
+    static bool isRingInitialized = false;
+    
+    if( ! isRingInitialized)
+    {
+        isRingInitialized = true;
+        
+        for(size_t i = 0; i < TraceRingSize; i++)
+            traceRing_[i].sequence.store(i);
+    }
+    
+    traceConsoleDirections_ = consoleDirections;
+    enabledDirections_ = directions;
+    
+    if(directions != 0 && ! traceFormatterShouldRun_)
+    {
+        traceFormatterShouldRun_ = true;
+        traceFormatter_ = thread(RunTraceFormatter);
+    }
+    else if(directions == 0)
+        Shutdown();
+}
+
+void CSITrace::Shutdown()
+{
+    enabledDirections_ = 0;
+    
+    if(traceFormatterShouldRun_)
+    {
+        traceFormatterShouldRun_ = false;
+        traceFormatter_.join();
+        DrainTraceRing();
+    }
+}
+
+int CSITrace::RegisterName(string name)
+{
+    WDL_MutexLock lock(&traceMutex_);
+    
+    if(traceIdsByName_.count(name) > 0)
+        return traceIdsByName_[name];
+    
+    if(traceNames_.size() >= 0xffff)
+        return 0;
+    
+    traceNames_.push_back(name);
+    traceIdsByName_[name] = traceNames_.size() - 1;
+    
+    return traceNames_.size() - 1;
+}
+
+string CSITrace::GetName(int id)
+{
+    WDL_MutexLock lock(&traceMutex_);
+    
+    return id < traceNames_.size() ? traceNames_[id] : "";
+}
+
+static TraceRecord MakeTraceRecord(TraceKind kind, int surfaceId, int widgetId)
+{
+    TraceRecord record;
+    
+    record.timestamp = CSIProfiler::GetTimestamp();
+    record.value = 0.0;
+    record.kind = kind;
+    record.surfaceId = surfaceId;
+    record.widgetId = widgetId;
+    record.size = 0;
+    record.hasValue = false;
+    record.isTruncated = false;
+    record.data[0] = 0;
+    
+    return record;
+}
+
+// Packs address and text NUL separated, truncating and flagging whatever doesn't fit
+static void SetTraceRecordText(TraceRecord &record, const char* address, const char* text)
+{
+    int length = 0;
+    
+    while(*address && length < sizeof(record.data) - 2)
+        record.data[length++] = *address++;
+    
+    record.data[length++] = 0;
+    
+    while(text && *text && length < sizeof(record.data) - 1)
+        record.data[length++] = *text++;
+    
+    record.data[length] = 0;
+    record.size = length;
+    record.isTruncated = *address != 0 || (text && *text != 0);
+}
+
+void CSITrace::Record(TraceKind kind, int surfaceId, int widgetId, double value)
+{
+    TraceRecord record = MakeTraceRecord(kind, surfaceId, widgetId);
+    record.value = value;
+    record.hasValue = true;
+    PushTraceRecord(record);
+}
+
+void CSITrace::Record(TraceKind kind, int surfaceId, int widgetId, const unsigned char* bytes, int size)
+{
+    TraceRecord record = MakeTraceRecord(kind, surfaceId, widgetId);
+    
+    if(size > sizeof(record.data))
+    {
+        size = sizeof(record.data);
+        record.isTruncated = true;
+    }
+    
+    memcpy(record.data, bytes, size);
+    record.size = size;
+    PushTraceRecord(record);
+}
+
+void CSITrace::Record(TraceKind kind, int surfaceId, int widgetId, const char* address, double value)
+{
+    TraceRecord record = MakeTraceRecord(kind, surfaceId, widgetId);
+    SetTraceRecordText(record, address, nullptr);
+    record.value = value;
+    record.hasValue = true;
+    PushTraceRecord(record);
+}
+
+void CSITrace::Record(TraceKind kind, int surfaceId, int widgetId, const char* address, const char* text)
+{
+    TraceRecord record = MakeTraceRecord(kind, surfaceId, widgetId);
+    SetTraceRecordText(record, address, text);
+    PushTraceRecord(record);
+}
+
+void CSITrace::FlushToConsole()
+{
+    if(traceConsoleDirections_.load(memory_order_relaxed) == 0)
+        return;
+    
+    string text;
+    
+    {
+        WDL_MutexLock lock(&traceMutex_);
+        text.swap(traceConsoleText_);
+    }
+    
+    if(int dropped = traceDropped_.exchange(0))
+        text += "TRACE: " + to_string(dropped) + " records dropped\n";
+    
+    if(text.size() > 0)
+        DAW::ShowConsoleMsg(text.c_str());
+}
+
+void CSITrace::DumpToFile(string filePath, double sinceTimestamp)
+{
+    ofstream traceFile(filePath);
+    
+    if( ! traceFile.is_open())
+    {
+        DAW::ShowConsoleMsg(("Could not open " + filePath + " for writing\n").c_str());
+        return;
+    }
+    
+    DrainTraceRing();
+    
+    WDL_MutexLock lock(&traceMutex_);
+    
+    char buffer[BUFSZ];
+    int start = traceHistory_.size() < TraceHistorySize ? 0 : traceHistoryPosition_;
+    
+    for(int i = 0; i < traceHistory_.size(); i++)
+    {
+        const TraceRecord &record = traceHistory_[(start + i) % traceHistory_.size()];
+        
+        if(record.timestamp < sinceTimestamp)
+            continue;
+        
+        FormatTraceRecord(record, buffer, sizeof(buffer));
+        traceFile << fixed << setprecision(3) << record.timestamp << " " << buffer;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CSIProfiler
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+atomic<bool> CSIProfiler::isEnabled_(false);
+double CSIProfiler::inputTimestamp_ = 0.0;
+thread::id CSIProfiler::profiledThread_;
+int CSIProfiler::currentPhase_ = NumProfilePhases;
+int CSIProfiler::phaseDepths_[NumProfilePhases];
+long long CSIProfiler::dawCallCount_ = 0;
+long long CSIProfiler::dawCalls_[NumProfilePhases + 1][MaxDAWApis];
+atomic<long long> CSIProfiler::allocationCount_(0);
+
+static WDL_Mutex dawApiMutex_; // the first call of a facade method can come from any thread
+static const char* dawApiNames_[MaxDAWApis];
+static atomic<int> numDAWApis_(0);
+
+#ifdef CSI_COUNT_ALLOCATIONS
+// Opt in, replacing the global allocator costs a counter check on every allocation in the plugin
+void* operator new(size_t size)
+{
+    CSIProfiler::CountAllocation();
+    
+    if(void* p = malloc(size > 0 ? size : 1))
+        return p;
+    
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    CSIProfiler::CountAllocation();
+    
+    if(void* p = malloc(size > 0 ? size : 1))
+        return p;
+    
+    throw bad_alloc();
+}
+
+// Kept out of line, GCC otherwise sees free() meet the pointer from the operator new above and warns of a mismatch
+[[gnu::noinline]] void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t size) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t size) noexcept { operator delete(p); }
+#endif
+
+static map<pair<int, const void*>, LatencyHistogram> actionLatencies_;
+static map<int, LatencyHistogram> feedbackLatencies_;
+static map<pair<int, int>, PhaseStats> phaseStats_;
+
+struct OSCOutputStats
+{
+    long long packets = 0;
+    long long bytes = 0;
+    long long messages = 0;
+    int maxBytes = 0;
+};
+
+static map<int, OSCOutputStats> oscOutputStats_;
+
+struct EuConInputStats
+{
+    long long ticks = 0;
+    long long messages = 0;
+    long long dispatched = 0;
+    int maxDepth = 0;
+    int dropped = 0;
+};
+
+static map<int, EuConInputStats> euConInputStats_;
+
+static const char* const ProfilePhaseNames[NumProfilePhases] =
+{
+    "Run",
+    "RebuildTrackList",
+    "HandleExternalInput",
+    "RequestUpdate",
+    "ProcessMidiMessage",
+    "ZoneActivate",
+    "ProcessZoneFile",
+};
+
+void CSIProfiler::SetEnabled(bool isEnabled)
+{
+    if(isEnabled)
+    {
+        actionLatencies_.clear();
+        feedbackLatencies_.clear();
+        phaseStats_.clear();
+        oscOutputStats_.clear();
+        euConInputStats_.clear();
+        memset(dawCalls_, 0, sizeof(dawCalls_));
+        profiledThread_ = this_thread::get_id();
+    }
+    
+    inputTimestamp_ = 0.0;
+    isEnabled_ = isEnabled;
+}
+
+void CSIProfiler::RecordActionLatency(int surfaceId, const void* action)
+{
+    if(inputTimestamp_ != 0.0) // deferred actions have no input to measure from
+        actionLatencies_[make_pair(surfaceId, action)].Add(GetTimestamp() - inputTimestamp_);
+}
+
+void CSIProfiler::RecordFeedbackLatency(int surfaceId, double inputTimestamp)
+{
+    feedbackLatencies_[surfaceId].Add(GetTimestamp() - inputTimestamp);
+}
+
+void CSIProfiler::RecordPhase(ProfilePhase phase, int surfaceId, double nanoseconds, long long dawCalls, long long allocations)
+{
+    PhaseStats &stats = phaseStats_[make_pair((int)phase, surfaceId)];
+    
+    stats.calls++;
+    stats.totalNanoseconds += nanoseconds;
+    stats.dawCalls += dawCalls;
+    stats.allocations += allocations;
+    
+    if(nanoseconds > stats.maxNanoseconds)
+        stats.maxNanoseconds = nanoseconds;
+    
+    if(dawCalls > stats.maxDAWCalls)
+        stats.maxDAWCalls = dawCalls;
+    
+    if(allocations > stats.maxAllocations)
+        stats.maxAllocations = allocations;
+}
+
+PhaseStats CSIProfiler::GetPhaseStats(ProfilePhase phase)
+{
+    PhaseStats totals;
+    
+    for(auto [key, stats] : phaseStats_)
+    {
+        if(key.first != phase)
+            continue;
+        
+        totals.calls += stats.calls;
+        totals.totalNanoseconds += stats.totalNanoseconds;
+        totals.dawCalls += stats.dawCalls;
+        totals.allocations += stats.allocations;
+        totals.maxNanoseconds = fmax(totals.maxNanoseconds, stats.maxNanoseconds);
+        totals.maxDAWCalls = stats.maxDAWCalls > totals.maxDAWCalls ? stats.maxDAWCalls : totals.maxDAWCalls;
+        totals.maxAllocations = stats.maxAllocations > totals.maxAllocations ? stats.maxAllocations : totals.maxAllocations;
+    }
+    
+    return totals;
+}
+
+void CSIProfiler::RecordOSCPacket(int surfaceId, int bytes, int messages)
+{
+    OSCOutputStats &stats = oscOutputStats_[surfaceId];
+    
+    stats.packets++;
+    stats.bytes += bytes;
+    stats.messages += messages;
+    
+    if(bytes > stats.maxBytes)
+        stats.maxBytes = bytes;
+}
+
+void CSIProfiler::RecordEuConInput(int surfaceId, int messages, int dispatched, int depth, int dropped)
+{
+    EuConInputStats &stats = euConInputStats_[surfaceId];
+    
+    stats.ticks++;
+    stats.messages += messages;
+    stats.dispatched += dispatched;
+    stats.dropped = dropped; // the queue keeps a running count
+    
+    if(depth > stats.maxDepth)
+        stats.maxDepth = depth;
+}
+
+int CSIProfiler::RegisterDAWApi(const char* name)
+{
+    WDL_MutexLock lock(&dawApiMutex_);
+    
+    int numDAWApis = numDAWApis_.load();
+    
+    for(int api = 0; api < numDAWApis; api++)
+        if(strcmp(dawApiNames_[api], name) == 0)
+            return api;
+    
+    if(numDAWApis < MaxDAWApis - 1)
+    {
+        dawApiNames_[numDAWApis] = name;
+        numDAWApis_ = numDAWApis + 1;
+        return numDAWApis;
+    }
+    
+    // Out of slots, the rest share the last one
+    dawApiNames_[MaxDAWApis - 1] = "Other";
+    numDAWApis_ = MaxDAWApis;
+    
+    return MaxDAWApis - 1;
+}
+
+static string GetPhaseKey(int phase, int surfaceId)
+{
+    return string(ProfilePhaseNames[phase]) + (surfaceId < 0 ? "" : "/" + CSITrace::GetName(surfaceId));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JSONValue
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void SkipJSONWhitespace(const string &text, size_t &position)
+{
+    while(position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\r' || text[position] == '\n'))
+        position++;
+}
+
+static bool ParseJSONValue(const string &text, size_t &position, JSONValue &value, int depth);
+
+static bool ParseJSONString(const string &text, size_t &position, string &result)
+{
+    if(position >= text.size() || text[position] != '"')
+        return false;
+    
+    position++;
+    
+    while(position < text.size() && text[position] != '"')
+    {
+        char c = text[position++];
+        
+        if(c != '\\')
+        {
+            result += c;
+            continue;
+        }
+        
+        if(position >= text.size())
+            return false;
+        
+        c = text[position++];
+        
+        switch(c)
+        {
+            case '"': case '\\': case '/': result += c; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u':
+            {
+                if(position + 4 > text.size())
+                    return false;
+                
+                unsigned int codePoint = strtoul(text.substr(position, 4).c_str(), nullptr, 16);
+                position += 4;
+                
+                // Names CSI writes are ASCII, anything wider is kept as UTF-8 without pairing surrogates
+                if(codePoint < 0x80)
+                    result += (char)codePoint;
+                else if(codePoint < 0x800)
+                {
+                    result += (char)(0xc0 | (codePoint >> 6));
+                    result += (char)(0x80 | (codePoint & 0x3f));
+                }
+                else
+                {
+                    result += (char)(0xe0 | (codePoint >> 12));
+                    result += (char)(0x80 | ((codePoint >> 6) & 0x3f));
+                    result += (char)(0x80 | (codePoint & 0x3f));
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    
+    if(position >= text.size())
+        return false;
+    
+    position++;
+    
+    return true;
+}
+
+static bool ParseJSONValue(const string &text, size_t &position, JSONValue &value, int depth)
+{
+    if(depth > 64)
+        return false;
+    
+    SkipJSONWhitespace(text, position);
+    
+    if(position >= text.size())
+        return false;
+    
+    char c = text[position];
+    
+    if(c == '{')
+    {
+        value.type = JSONValue::Object;
+        position++;
+        SkipJSONWhitespace(text, position);
+        
+        if(position < text.size() && text[position] == '}')
+        {
+            position++;
+            return true;
+        }
+        
+        while(true)
+        {
+            string key;
+            JSONValue member;
+            
+            SkipJSONWhitespace(text, position);
+            
+            if( ! ParseJSONString(text, position, key))
+                return false;
+            
+            SkipJSONWhitespace(text, position);
+            
+            if(position >= text.size() || text[position++] != ':')
+                return false;
+            
+            if( ! ParseJSONValue(text, position, member, depth + 1))
+                return false;
+            
+            value.members.push_back(make_pair(key, member));
+            
+            SkipJSONWhitespace(text, position);
+            
+            if(position < text.size() && text[position] == ',')
+                position++;
+            else if(position < text.size() && text[position] == '}')
+            {
+                position++;
+                return true;
+            }
+            else
+                return false;
+        }
+    }
+    else if(c == '[')
+    {
+        value.type = JSONValue::Array;
+        position++;
+        SkipJSONWhitespace(text, position);
+        
+        if(position < text.size() && text[position] == ']')
+        {
+            position++;
+            return true;
+        }
+        
+        while(true)
+        {
+            JSONValue element;
+            
+            if( ! ParseJSONValue(text, position, element, depth + 1))
+                return false;
+            
+            value.elements.push_back(element);
+            
+            SkipJSONWhitespace(text, position);
+            
+            if(position < text.size() && text[position] == ',')
+                position++;
+            else if(position < text.size() && text[position] == ']')
+            {
+                position++;
+                return true;
+            }
+            else
+                return false;
+        }
+    }
+    else if(c == '"')
+    {
+        value.type = JSONValue::String;
+        return ParseJSONString(text, position, value.stringValue);
+    }
+    else if(text.compare(position, 4, "true") == 0 || text.compare(position, 5, "false") == 0)
+    {
+        value.type = JSONValue::Bool;
+        value.boolValue = c == 't';
+        position += value.boolValue ? 4 : 5;
+        return true;
+    }
+    else if(text.compare(position, 4, "null") == 0)
+    {
+        value.type = JSONValue::Null;
+        position += 4;
+        return true;
+    }
+    else if(c == '-' || (c >= '0' && c <= '9'))
+    {
+        const char* start = text.c_str() + position;
+        char* end = nullptr;
+        
+        value.type = JSONValue::Number;
+        value.numberValue = strtod(start, &end);
+        
+        if(end == start)
+            return false;
+        
+        position += end - start;
+        return true;
+    }
+    
+    return false;
+}
+
+bool JSONValue::Parse(const string &text, JSONValue &value)
+{
+    size_t position = 0;
+    
+    value = JSONValue();
+    
+    if( ! ParseJSONValue(text, position, value, 0))
+    {
+        value = JSONValue();
+        return false;
+    }
+    
+    SkipJSONWhitespace(text, position);
+    
+    if(position != text.size())
+    {
+        value = JSONValue();
+        return false;
+    }
+    
+    return true;
+}
+
+bool JSONValue::ReadFile(const string &filePath, JSONValue &value)
+{
+    ifstream file(filePath);
+    
+    if( ! file.is_open())
+    {
+        value = JSONValue();
+        return false;
+    }
+    
+    stringstream contents;
+    contents << file.rdbuf();
+    
+    return Parse(contents.str(), value);
+}
+
+// Reads the nsPerOp entries back out of a file written by WriteProfile
+static map<string, double> ReadProfileBaseline(string baselinePath)
+{
+    map<string, double> baseline;
+    JSONValue profile;
+    
+    if( ! JSONValue::ReadFile(baselinePath, profile))
+        return baseline;
+    
+    if(const JSONValue* phases = profile.Find("phases"))
+        for(auto &phase : phases->elements)
+            if(phase.GetString("phase") != "")
+                baseline[phase.GetString("phase")] = phase.GetNumber("nsPerOp");
+    
+    return baseline;
+}
+
+static void WriteProfile(string profilePath)
+{
+    ofstream profileFile(profilePath);
+    
+    if( ! profileFile.is_open())
+    {
+        DAW::ShowConsoleMsg(("Could not open " + profilePath + " for writing\n").c_str());
+        return;
+    }
+    
+    profileFile << "{" << GetLineEnding() << "    \"phases\": [" << GetLineEnding();
+    
+    int count = 0;
+    
+    for(auto [key, stats] : phaseStats_)
+    {
+        profileFile << "        { \"phase\": \"" << GetPhaseKey(key.first, key.second) << "\", \"calls\": " << stats.calls;
+        profileFile << ", \"nsPerOp\": " << fixed << setprecision(1) << stats.totalNanoseconds / stats.calls << ", \"maxNs\": " << stats.maxNanoseconds;
+        profileFile << ", \"dawCallsPerOp\": " << (double)stats.dawCalls / stats.calls << ", \"maxDAWCalls\": " << stats.maxDAWCalls;
+        profileFile << ", \"allocationsPerOp\": " << (double)stats.allocations / stats.calls << ", \"maxAllocations\": " << stats.maxAllocations << " }";
+        profileFile << (++count < phaseStats_.size() ? "," : "") << GetLineEnding();
+    }
+    
+    profileFile << "    ]," << GetLineEnding() << "    \"dawCalls\": [" << GetLineEnding();
+    
+    bool isFirst = true;
+    
+    for(int api = 0; api < numDAWApis_; api++)
+    {
+        for(int phase = 0; phase <= NumProfilePhases; phase++)
+        {
+            if(CSIProfiler::GetDAWCalls(phase, api) == 0)
+                continue;
+            
+            profileFile << (isFirst ? "" : ",") << (isFirst ? "" : GetLineEnding());
+            profileFile << "        { \"api\": \"" << dawApiNames_[api] << "\", \"phase\": \"" << (phase < NumProfilePhases ? ProfilePhaseNames[phase] : "None") << "\", \"calls\": " << CSIProfiler::GetDAWCalls(phase, api) << " }";
+            isFirst = false;
+        }
+    }
+    
+    profileFile << GetLineEnding() << "    ]" << GetLineEnding() << "}" << GetLineEnding();
+}
+
+static void ReportLatencyHistogram(const string &surfaceName, const string &name, LatencyHistogram &histogram)
+{
+    char buffer[BUFSZ];
+    snprintf(buffer, sizeof(buffer), "%-20s %-36s %8d %9.3f %9.3f %9.3f %9.3f\n", surfaceName.c_str(), name.c_str(), histogram.count, histogram.total / histogram.count, histogram.GetPercentile(0.5), histogram.GetPercentile(0.95), histogram.maximum);
+    DAW::ShowConsoleMsg(buffer);
+}
+
+void CSIProfiler::Report(map<const void*, string> &actionNames, string profilePath, string baselinePath)
+{
+    char buffer[BUFSZ];
+    
+    map<string, double> baseline = ReadProfileBaseline(baselinePath);
+    
+    snprintf(buffer, sizeof(buffer), "\nCSI phase timing -- inclusive of nested phases, change is against %s\n%-44s %10s %12s %12s %8s %10s %10s %10s\n", baseline.size() > 0 ? baselinePath.c_str() : "no baseline", "Phase", "Calls", "ns/op", "Max ns", "Change", "DAW/op", "Max DAW", "Allocs/op");
+    DAW::ShowConsoleMsg(buffer);
+    
+    for(auto [key, stats] : phaseStats_)
+    {
+        string phaseKey = GetPhaseKey(key.first, key.second);
+        double nsPerOp = stats.totalNanoseconds / stats.calls;
+        char change[32] = "";
+        char allocations[32] = "-";
+        
+        if(baseline.count(phaseKey) > 0 && baseline[phaseKey] > 0.0)
+            snprintf(change, sizeof(change), "%+7.1f%%", (nsPerOp / baseline[phaseKey] - 1.0) * 100.0);
+        
+#ifdef CSI_COUNT_ALLOCATIONS
+        snprintf(allocations, sizeof(allocations), "%.1f", (double)stats.allocations / stats.calls);
+#endif
+        
+        snprintf(buffer, sizeof(buffer), "%-44s %10lld %12.0f %12.0f %8s %10.1f %10lld %10s\n", phaseKey.c_str(), stats.calls, nsPerOp, stats.maxNanoseconds, change, (double)stats.dawCalls / stats.calls, stats.maxDAWCalls, allocations);
+        DAW::ShowConsoleMsg(buffer);
+    }
+    
+    // DAW calls are attributed to the innermost phase they were made in, per tick means per Run
+    long long runTicks = phaseStats_.count(make_pair((int)ProfileRun, -1)) > 0 ? phaseStats_[make_pair((int)ProfileRun, -1)].calls : 0;
+    
+    snprintf(buffer, sizeof(buffer), "\nCSI DAW calls -- by innermost phase, over %lld Run ticks\n%-40s %-24s %12s %12s\n", runTicks, "DAW API", "Phase", "Calls", "Per tick");
+    DAW::ShowConsoleMsg(buffer);
+    
+    for(int api = 0; api < numDAWApis_; api++)
+    {
+        for(int phase = 0; phase <= NumProfilePhases; phase++)
+        {
+            if(dawCalls_[phase][api] == 0)
+                continue;
+            
+            snprintf(buffer, sizeof(buffer), "%-40s %-24s %12lld %12.1f\n", dawApiNames_[api], phase < NumProfilePhases ? ProfilePhaseNames[phase] : "None", dawCalls_[phase][api], runTicks > 0 ? (double)dawCalls_[phase][api] / runTicks : 0.0);
+            DAW::ShowConsoleMsg(buffer);
+        }
+    }
+    
+    WriteProfile(profilePath);
+    
+    if(oscOutputStats_.size() > 0)
+    {
+        snprintf(buffer, sizeof(buffer), "\nCSI OSC output\n%-20s %10s %12s %12s %10s %12s %10s\n", "Surface", "Packets", "Bytes", "Messages", "Msgs/pkt", "Packets/tick", "Max bytes");
+        DAW::ShowConsoleMsg(buffer);
+        
+        for(auto [surfaceId, stats] : oscOutputStats_)
+        {
+            snprintf(buffer, sizeof(buffer), "%-20s %10lld %12lld %12lld %10.1f %12.2f %10d\n", CSITrace::GetName(surfaceId).c_str(), stats.packets, stats.bytes, stats.messages, (double)stats.messages / stats.packets, runTicks > 0 ? (double)stats.packets / runTicks : 0.0, stats.maxBytes);
+            DAW::ShowConsoleMsg(buffer);
+        }
+    }
+    
+    if(euConInputStats_.size() > 0)
+    {
+        snprintf(buffer, sizeof(buffer), "\nCSI EuCon input\n%-20s %10s %12s %12s %12s %10s %10s\n", "Surface", "Ticks", "Messages", "Dispatched", "Coalesced %", "Max depth", "Dropped");
+        DAW::ShowConsoleMsg(buffer);
+        
+        for(auto [surfaceId, stats] : euConInputStats_)
+        {
+            snprintf(buffer, sizeof(buffer), "%-20s %10lld %12lld %12lld %12.1f %10d %10d\n", CSITrace::GetName(surfaceId).c_str(), stats.ticks, stats.messages, stats.dispatched, stats.messages > 0 ? 100.0 * (stats.messages - stats.dispatched) / stats.messages : 0.0, stats.maxDepth, stats.dropped);
+            DAW::ShowConsoleMsg(buffer);
+        }
+    }
+    
+    snprintf(buffer, sizeof(buffer), "\nCSI latency (ms) -- p50/p95 are bucket upper bounds\n%-20s %-36s %8s %9s %9s %9s %9s\n", "Surface", "Input -> action done", "Count", "Mean", "p50", "p95", "Max");
+    DAW::ShowConsoleMsg(buffer);
+    
+    for(auto [key, histogram] : actionLatencies_)
+        ReportLatencyHistogram(CSITrace::GetName(key.first), actionNames.count(key.second) > 0 ? actionNames[key.second] : "Unknown", histogram);
+    
+    snprintf(buffer, sizeof(buffer), "\n%-20s %-36s\n", "Surface", "Input -> feedback sent");
+    DAW::ShowConsoleMsg(buffer);
+    
+    for(auto [surfaceId, histogram] : feedbackLatencies_)
+        ReportLatencyHistogram(CSITrace::GetName(surfaceId), "Feedback", histogram);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CSIRecorder
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const char RecordingSignature[8] = { 'C', 'S', 'I', 'R', 'E', 'C', '1', 0 };
+static const int RecordingFlushSize = 65536;
+
+atomic<bool> CSIRecorder::isRecording_(false);
+
+static ofstream recordingFile_;
+static vector<unsigned char> recordingBuffer_;
+static map<int, unsigned short> recordingSurfaceIds_;
+static double recordingStartTimestamp_ = 0.0;
+static int recordingTick_ = 0;
+static int recordingLastWrittenTick_ = -1;
+
+static void AppendRecord(unsigned short surfaceId, RecordKind kind, double timestamp, const void* prefix, int prefixSize, const void* payload, int size)
+{
+    RecordHeader header = { timestamp, surfaceId, (unsigned char)kind, 0, (unsigned int)(prefixSize + size) };
     
-    // otherwise make new
-    midi_Input* newInput = DAW::CreateMIDIInput(inputPort);
+    const unsigned char* headerBytes = (const unsigned char*)&header;
+    recordingBuffer_.insert(recordingBuffer_.end(), headerBytes, headerBytes + sizeof(header));
+    recordingBuffer_.insert(recordingBuffer_.end(), (const unsigned char*)prefix, (const unsigned char*)prefix + prefixSize);
+    recordingBuffer_.insert(recordingBuffer_.end(), (const unsigned char*)payload, (const unsigned char*)payload + size);
     
-    if(newInput)
+    if(recordingBuffer_.size() >= RecordingFlushSize)
     {
-        newInput->start();
-        midiInputs_[inputPort] = new MidiInputPort(inputPort, newInput);
-        return newInput;
+        recordingFile_.write((const char*)recordingBuffer_.data(), recordingBuffer_.size());
+        recordingBuffer_.clear();
     }
-    
-    return nullptr;
 }
 
-static midi_Output* GetMidiOutputForPort(int outputPort)
+bool CSIRecorder::Start(string filePath)
 {
-    if(midiOutputs_.count(outputPort) > 0)
-        return midiOutputs_[outputPort]->midiOutput_; // return existing
+    Stop();
     
-    // otherwise make new
-    midi_Output* newOutput = DAW::CreateMIDIOutput(outputPort, false, NULL);
+    recordingFile_.open(filePath, ios::out | ios::binary | ios::trunc);
     
-    if(newOutput)
+    if( ! recordingFile_.is_open())
     {
-        midiOutputs_[outputPort] = new MidiOutputPort(outputPort, newOutput);
-        return newOutput;
+        DAW::ShowConsoleMsg(("Could not open " + filePath + " for writing\n").c_str());
+        return false;
     }
     
-    return nullptr;
+    recordingFile_.write(RecordingSignature, sizeof(RecordingSignature));
+    recordingSurfaceIds_.clear();
+    recordingStartTimestamp_ = CSIProfiler::GetTimestamp();
+    recordingTick_ = 0;
+    recordingLastWrittenTick_ = -1;
+    isRecording_ = true;
+    
+    return true;
 }
 
-void ShutdownMidiIO()
+void CSIRecorder::Stop()
 {
-    for(auto [index, input] : midiInputs_)
-        input->midiInput_->stop();
+    if( ! isRecording_)
+        return;
+    
+    isRecording_ = false;
+    recordingFile_.write((const char*)recordingBuffer_.data(), recordingBuffer_.size());
+    recordingFile_.close();
+    recordingBuffer_.clear();
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// OSC I/O Manager
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static map<string, oscpkt::UdpSocket*> inputSockets_;
-static map<string, oscpkt::UdpSocket*> outputSockets_;
+void CSIRecorder::BeginTick()
+{
+    recordingTick_++;
+}
 
-static oscpkt::UdpSocket* GetInputSocketForPort(string surfaceName, int inputPort)
+void CSIRecorder::Record(int surfaceId, RecordKind kind, double timestamp, const void* prefix, int prefixSize, string text)
 {
-    if(inputSockets_.count(surfaceName) > 0)
-        return inputSockets_[surfaceName]; // return existing
-    
-    // otherwise make new
-    oscpkt::UdpSocket* newInputSocket = new oscpkt::UdpSocket();
-    
-    if(newInputSocket)
+    if(recordingSurfaceIds_.count(surfaceId) < 1)
     {
-        newInputSocket->bindTo(inputPort);
-        
-        if (! newInputSocket->isOk())
-        {
-            //cerr << "Error opening port " << PORT_NUM << ": " << inSocket_.errorMessage() << "\n";
-            return nullptr;
-        }
-        
-        inputSockets_[surfaceName] = newInputSocket;
+        unsigned short recordingSurfaceId = recordingSurfaceIds_.size();
+        string name = CSITrace::GetName(surfaceId);
         
-        return inputSockets_[surfaceName];
+        recordingSurfaceIds_[surfaceId] = recordingSurfaceId;
+        AppendRecord(recordingSurfaceId, RecordSurfaceName, 0.0, nullptr, 0, name.c_str(), name.size());
     }
     
-    return nullptr;
+    // Tick markers keep the per tick batching so a replay can reproduce it exactly
+    if(recordingLastWrittenTick_ != recordingTick_)
+    {
+        recordingLastWrittenTick_ = recordingTick_;
+        AppendRecord(0, RecordTick, timestamp - recordingStartTimestamp_, &recordingTick_, sizeof(recordingTick_), nullptr, 0);
+    }
+    
+    AppendRecord(recordingSurfaceIds_[surfaceId], kind, timestamp - recordingStartTimestamp_, prefix, prefixSize, text.data(), text.size());
 }
 
-static oscpkt::UdpSocket* GetOutputSocketForAddressAndPort(string surfaceName, string address, int outputPort)
+void CSIRecorder::Record(int surfaceId, RecordKind kind, double timestamp, const void* payload, int size)
 {
-    if(outputSockets_.count(surfaceName) > 0)
-        return outputSockets_[surfaceName]; // return existing
+    Record(surfaceId, kind, timestamp, payload, size, "");
+}
+
+bool CSIRecorder::Load(string filePath, vector<RecordedEvent> &events)
+{
+    ifstream file(filePath, ios::in | ios::binary);
     
-    // otherwise make new
-    oscpkt::UdpSocket* newOutputSocket = new oscpkt::UdpSocket();
+    char signature[sizeof(RecordingSignature)];
     
-    if(newOutputSocket)
+    if( ! file.read(signature, sizeof(signature)) || memcmp(signature, RecordingSignature, sizeof(signature)))
     {
-        if( ! newOutputSocket->connectTo(address, outputPort))
-        {
-            //cerr << "Error connecting " << remoteDeviceIP_ << ": " << outSocket_.errorMessage() << "\n";
-            return nullptr;
-        }
+        DAW::ShowConsoleMsg((filePath + " is not a CSI recording\n").c_str());
+        return false;
+    }
+    
+    vector<string> surfaceNames;
+    int tick = 0;
+    RecordHeader header;
+    
+    while(file.read((char*)&header, sizeof(header)))
+    {
+        vector<unsigned char> payload(header.size);
         
-        newOutputSocket->bindTo(outputPort);
+        if(header.size > 0 && ! file.read((char*)payload.data(), header.size))
+            break;
         
-        if ( ! newOutputSocket->isOk())
+        if(header.kind == RecordSurfaceName)
         {
-            //cerr << "Error opening port " << outPort_ << ": " << outSocket_.errorMessage() << "\n";
-            return nullptr;
+            if(surfaceNames.size() <= header.surfaceId)
+                surfaceNames.resize(header.surfaceId + 1);
+            
+            surfaceNames[header.surfaceId] = string(payload.begin(), payload.end());
         }
-
-        outputSockets_[surfaceName] = newOutputSocket;
-        
-        return outputSockets_[surfaceName];
+        else if(header.kind == RecordTick && header.size == sizeof(int))
+            memcpy(&tick, payload.data(), sizeof(int));
+        else if(header.surfaceId < surfaceNames.size())
+            events.push_back(RecordedEvent { header.timestamp, tick, (RecordKind)header.kind, surfaceNames[header.surfaceId], payload });
     }
     
-    return nullptr;
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -196,6 +1903,45 @@ static void listZoneFiles(const string &path, vector<string> &results)
     }
 }
 
+// FX zones are named for their FX, e.g. "VST: ReaEQ (Cockos)" or "JS: 1175 Compressor"
+static bool IsFXZoneName(const string &zoneName)
+{
+    size_t colon = zoneName.find(": ");
+    
+    return colon != string::npos && colon > 0 && zoneName.find(' ') > colon;
+}
+
+// Only reads the Zone lines, comments aside. Returns the FX name when the file holds exactly one Zone and that Zone is for an FX,
+// a file with any other Zone in it is parsed up front as before, so every Zone in it can be found by name.
+static string GetFXZoneName(const string &filePath)
+{
+    string fxName = "";
+    int numZones = 0;
+    
+    ifstream file(filePath);
+    
+    for (string line; getline(file, line) ; )
+    {
+        line = line.substr(0, line.find("//"));
+        
+        size_t start = line.find_first_not_of(" \t\r");
+        
+        if(start == string::npos || line.compare(start, 4, "Zone") != 0 || start + 4 >= line.size() || (line[start + 4] != ' ' && line[start + 4] != '\t'))
+            continue;
+        
+        vector<string> tokens(GetTokens(line.substr(start)));
+        
+        numZones++;
+        
+        if(numZones > 1 || tokens.size() < 2 || ! IsFXZoneName(tokens[1]))
+            return "";
+        
+        fxName = tokens[1];
+    }
+    
+    return fxName;
+}
+
 static void GetWidgetNameAndProperties(string line, string &widgetName, string &modifier, bool &isPressRelease, bool &isInverted, bool &shouldToggle, double &delayAmount)
 {
     istringstream modified_role(line);
@@ -241,6 +1987,8 @@ static void GetWidgetNameAndProperties(string line, string &widgetName, string &
 
 static void ProcessZoneFile(string filePath, ControlSurface* surface)
 {
+    ProfileScope profileScope(ProfileProcessZoneFile, surface->GetTraceId());
+    
     vector<string> includedZones;
     bool isInIncludedZonesSection = false;
     
@@ -653,87 +2401,441 @@ static void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, ve
                 feedbackProcessor->SetRefreshInterval(strToDouble(tokenLines[i][2]));
         }
         
-        if(feedbackProcessor != nullptr)
-            widget->AddFeedbackProcessor(feedbackProcessor);
+        if(feedbackProcessor != nullptr)
+            widget->AddFeedbackProcessor(feedbackProcessor);
+    }
+}
+
+static void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, vector<string> tokens,  OSC_ControlSurface* surface, vector<Widget*> &widgets)
+{
+    if(tokens.size() < 2)
+        return;
+    
+    Widget* widget = new Widget(surface, tokens[1]);
+    
+    if(! widget)
+        return;
+    
+    surface->AddWidget(widget);
+
+    vector<vector<string>> tokenLines;
+
+    for (string line; getline(surfaceTemplateFile, line) ; )
+    {
+        line = regex_replace(line, regex(TabChars), " ");
+        line = regex_replace(line, regex(CRLFChars), "");
+
+        lineNumber++;
+        
+        if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
+            continue;
+        
+        vector<string> tokens(GetTokens(line));
+        
+        if(tokens[0] == "WidgetEnd")    // finito baybay - Widget list complete
+            break;
+        
+        tokenLines.push_back(tokens);
+    }
+
+    for(auto tokenLine : tokenLines)
+    {
+        if(tokenLine.size() > 2 && tokenLine[0] == "Control") // Control /xy 1 -- the widget follows the 2nd argument
+            new OSC_CSIMessageGenerator(surface, widget, tokenLine[1], atoi(tokenLine[2].c_str()));
+        else if(tokenLine.size() > 1 && tokenLine[0] == "Control")
+            new OSC_CSIMessageGenerator(surface, widget, tokenLine[1], 0);
+        else if(tokenLine.size() > 1 && tokenLine[0] == "FB_Processor")
+            widget->AddFeedbackProcessor(new OSC_FeedbackProcessor(surface, widget, tokenLine[1]));
+    }
+}
+
+static void ProcessWidgetFile(string filePath, ControlSurface* surface, vector<Widget*> &widgets)
+{
+    int lineNumber = 0;
+    
+    try
+    {
+        ifstream file(filePath);
+        
+        for (string line; getline(file, line) ; )
+        {
+            line = regex_replace(line, regex(TabChars), " ");
+            line = regex_replace(line, regex(CRLFChars), "");
+            
+            lineNumber++;
+            
+            if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
+                continue;
+            
+            vector<string> tokens(GetTokens(line));
+            
+            if(tokens.size() > 0 && tokens[0] == "Widget")
+            {
+                if(filePath[filePath.length() - 3] == 'm')
+                    ProcessMidiWidget(lineNumber, file, tokens, (Midi_ControlSurface*)surface, widgets);
+                if(filePath[filePath.length() - 3] == 'o')
+                    ProcessOSCWidget(lineNumber, file, tokens, (OSC_ControlSurface*)surface, widgets);
+            }
+        }
+    }
+    catch (exception &e)
+    {
+        char buffer[250];
+        snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", filePath.c_str(), lineNumber);
+        DAW::ShowConsoleMsg(buffer);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TimeDisplayFormatter
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+void TimeDisplayFormatter::Update()
+{
+    if(isCurrent_)
+        return;
+    
+    isCurrent_ = true;
+    hasBeats_ = false;
+    
+    position_ = (DAW::GetPlayState() & 1) ? DAW::GetPlayPosition() : DAW::GetCursorPosition();
+    
+    timeMode_ = 0;
+    
+    if(timeMode2Ptr_ && *timeMode2Ptr_ >= 0) // transport
+        timeMode_ = *timeMode2Ptr_;
+    else if(timeModePtr_) // ruler
+        timeMode_ = *timeModePtr_;
+}
+
+void TimeDisplayFormatter::UpdateBeats()
+{
+    if(hasBeats_)
+        return;
+    
+    hasBeats_ = true;
+    beatsInMeasure_ = DAW::TimeMap2_timeToBeats(NULL, position_, &measures_, NULL, &fullBeats_, NULL) + 0.000000000001;
+}
+
+double TimeDisplayFormatter::GetKey(int mode, double unitsPerSecond, double unitsPerBeat)
+{
+    if(mode == 4) // Samples, every new position is new text
+        return position_;
+    
+    if(mode == 1 || mode == 2) // Bars/Beats
+    {
+        UpdateBeats();
+        return floor(fullBeats_ * unitsPerBeat);
+    }
+    
+    if(mode == 5) // Frames
+        return floor((position_ + GetTimeOffset()) * DAW::TimeMap_curFrameRate(NULL, NULL));
+    
+    return floor((position_ + GetTimeOffset()) * unitsPerSecond);
+}
+
+const char* TimeDisplayFormatter::GetText(int mode)
+{
+    if(mode < 0 || mode > 5)
+        mode = 0;
+    
+    Update();
+    
+    CachedText &cachedText = texts_[mode];
+    double key = GetKey(mode, 1000.0, 100.0);
+    
+    if(cachedText.mode != mode || cachedText.key != key)
+    {
+        cachedText.mode = mode;
+        cachedText.key = key;
+        
+        double position = position_;
+        
+        if(mode == 0 || mode == 3 || mode == 5)
+            position += GetTimeOffset();
+        
+        DAW::format_timestr_pos(position, cachedText.text, sizeof(cachedText.text), mode);
+    }
+    
+    return cachedText.text;
+}
+
+const unsigned char* TimeDisplayFormatter::GetMCUDigits()
+{
+    Update();
+    
+    double key = GetKey(timeMode_, timeMode_ == 3 ? 100.0 : 1000.0, 1000.0);
+    
+    if(mcuDigits_.mode != timeMode_ || mcuDigits_.key != key)
+    {
+        mcuDigits_.mode = timeMode_;
+        mcuDigits_.key = key;
+        FormatMCUDigits((unsigned char*)mcuDigits_.text);
+    }
+    
+    return (const unsigned char*)mcuDigits_.text;
+}
+
+void TimeDisplayFormatter::FormatMCUDigits(unsigned char* bla)
+{
+    const int numDigits = 10;
+    
+    memset(bla, 0, numDigits);
+    
+    double pp = position_;
+    int tmode = timeMode_;
+    
+    if (tmode==3) // seconds
+    {
+        pp += GetTimeOffset();
+        char buf[64];
+        snprintf(buf, sizeof(buf),"%d %02d",(int)pp, ((int)(pp*100.0))%100);
+        if (strlen(buf)>numDigits) memcpy(bla,buf+strlen(buf)-numDigits,numDigits);
+        else
+            memcpy(bla+numDigits-strlen(buf),buf,strlen(buf));
+        
+    }
+    else if (tmode==4) // samples
+    {
+        char buf[128];
+        DAW::format_timestr_pos(pp,buf,sizeof(buf),4);
+        if (strlen(buf)>numDigits) memcpy(bla,buf+strlen(buf)-numDigits,numDigits);
+        else
+            memcpy(bla+numDigits-strlen(buf),buf,strlen(buf));
+    }
+    else if (tmode==5) // frames
+    {
+        char buf[128];
+        DAW::format_timestr_pos(pp,buf,sizeof(buf),5);
+        char *p=buf;
+        char *op=buf;
+        int ccnt=0;
+        while (*p)
+        {
+            if (*p == ':')
+            {
+                ccnt++;
+                if (ccnt!=3)
+                {
+                    p++;
+                    continue;
+                }
+                *p=' ';
+            }
+            
+            *op++=*p++;
+        }
+        *op=0;
+        if (strlen(buf)>numDigits) memcpy(bla,buf+strlen(buf)-numDigits,numDigits);
+        else
+            memcpy(bla+numDigits-strlen(buf),buf,strlen(buf));
+    }
+    else if (tmode>0)
+    {
+        UpdateBeats();
+        
+        double beats = beatsInMeasure_;
+        double nbeats = floor(beats);
+        
+        beats -= nbeats;
+        
+        int fracbeats = (int) (1000.0 * beats);
+        
+        int nm=measures_+1+(measOffsPtr_ ? *measOffsPtr_ : 0);
+        if (nm >= 100) bla[0]='0'+(nm/100)%10;//bars hund
+        if (nm >= 10) bla[1]='0'+(nm/10)%10;//barstens
+        bla[2]='0'+(nm)%10;//bars
+        
+        int nb=(int)nbeats+1;
+        if (nb >= 10) bla[3]='0'+(nb/10)%10;//beats tens
+        bla[4]='0'+(nb)%10;//beats
+        
+        
+        bla[7]='0' + (fracbeats/100)%10;
+        bla[8]='0' + (fracbeats/10)%10;
+        bla[9]='0' + (fracbeats%10); // frames
+    }
+    else
+    {
+        pp += GetTimeOffset();
+        
+        int ipp=(int)pp;
+        int fr=(int)((pp-ipp)*1000.0);
+        
+        if (ipp >= 360000) bla[0]='0'+(ipp/360000)%10;//hours hundreds
+        if (ipp >= 36000) bla[1]='0'+(ipp/36000)%10;//hours tens
+        if (ipp >= 3600) bla[2]='0'+(ipp/3600)%10;//hours
+        
+        bla[3]='0'+(ipp/600)%6;//min tens
+        bla[4]='0'+(ipp/60)%10;//min
+        bla[5]='0'+(ipp/10)%6;//sec tens
+        bla[6]='0'+(ipp%10);//sec
+        bla[7]='0' + (fr/100)%10;
+        bla[8]='0' + (fr/10)%10;
+        bla[9]='0' + (fr%10); // frames
     }
 }
 
-static void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, vector<string> tokens,  OSC_ControlSurface* surface, vector<Widget*> &widgets)
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TrackAppearanceCache
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+void TrackAppearanceCache::Run()
 {
-    if(tokens.size() < 2)
+    if(++ticksSinceVerify_ < VerifyInterval)
         return;
     
-    Widget* widget = new Widget(surface, tokens[1]);
-    
-    if(! widget)
-        return;
+    ticksSinceVerify_ = 0;
     
-    widgets.push_back(widget);
+    for(auto &entry : appearances_)
+    {
+        entry.second.isNameCurrent = false;
+        entry.second.isColourCurrent = false;
+    }
+}
 
-    vector<vector<string>> tokenLines;
+void TrackAppearanceCache::OnTrackTitleChange(MediaTrack* track)
+{
+    auto it = appearances_.find(track);
+    
+    if(it != appearances_.end())
+        it->second.isNameCurrent = false;
+}
 
-    for (string line; getline(surfaceTemplateFile, line) ; )
+const char* TrackAppearanceCache::GetName(MediaTrack* track)
+{
+    TrackAppearance &appearance = appearances_[track];
+    
+    if( ! appearance.isNameCurrent)
     {
-        line = regex_replace(line, regex(TabChars), " ");
-        line = regex_replace(line, regex(CRLFChars), "");
-
-        lineNumber++;
-        
-        if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
-            continue;
-        
-        vector<string> tokens(GetTokens(line));
-        
-        if(tokens[0] == "WidgetEnd")    // finito baybay - Widget list complete
-            break;
+        if( ! DAW::GetTrackName(track, appearance.name, sizeof(appearance.name)))
+            appearance.name[0] = 0;
         
-        tokenLines.push_back(tokens);
+        appearance.isNameCurrent = true;
     }
+    
+    return appearance.name;
+}
 
-    for(auto tokenLine : tokenLines)
+unsigned int TrackAppearanceCache::GetColour(MediaTrack* track)
+{
+    TrackAppearance &appearance = appearances_[track];
+    
+    if( ! appearance.isColourCurrent)
     {
-        if(tokenLine.size() > 1 && tokenLine[0] == "Control")
-            new OSC_CSIMessageGenerator(surface, widget, tokenLine[1]);
-        else if(tokenLine.size() > 1 && tokenLine[0] == "FB_Processor")
-            widget->AddFeedbackProcessor(new OSC_FeedbackProcessor(surface, widget, tokenLine[1]));
+        unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
+        appearance.colour = rgb_colour ? *rgb_colour : 0;
+        appearance.isColourCurrent = true;
     }
+    
+    return appearance.colour;
 }
 
-static void ProcessWidgetFile(string filePath, ControlSurface* surface, vector<Widget*> &widgets)
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FXParamCache
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+FXParamCache::FXParam& FXParamCache::GetParam(MediaTrack* track, int slotIndex, int paramIndex)
 {
-    int lineNumber = 0;
+    if(paramIndex < 0)
+    {
+        static FXParam noParam; // a bad param number in a zone file, read from the DAW each time like before
+        noParam = FXParam();
+        return noParam;
+    }
     
-    try
+    FXSlot &slot = slots_[make_pair(track, slotIndex)];
+    
+    if(paramIndex >= (int)slot.params.size())
+        slot.params.resize(paramIndex + 1);
+    
+    return slot.params[paramIndex];
+}
+
+FXParamCache::FXParam& FXParamCache::GetCurrentParam(MediaTrack* track, int slotIndex, int paramIndex)
+{
+    FXSlot &slot = slots_[make_pair(track, slotIndex)];
+    
+    if(slot.polledTick != tick_)
     {
-        ifstream file(filePath);
-        
-        for (string line; getline(file, line) ; )
+        // Params nobody asked about since the last poll drop out until they are asked about again
+        for(int i = 0; i < (int)slot.params.size(); i++)
         {
-            line = regex_replace(line, regex(TabChars), " ");
-            line = regex_replace(line, regex(CRLFChars), "");
-            
-            lineNumber++;
-            
-            if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
-                continue;
-            
-            vector<string> tokens(GetTokens(line));
+            FXParam &param = slot.params[i];
             
-            if(tokens.size() > 0 && tokens[0] == "Widget")
+            if(param.isInUse)
             {
-                if(filePath[filePath.length() - 3] == 'm')
-                    ProcessMidiWidget(lineNumber, file, tokens, (Midi_ControlSurface*)surface, widgets);
-                if(filePath[filePath.length() - 3] == 'o')
-                    ProcessOSCWidget(lineNumber, file, tokens, (OSC_ControlSurface*)surface, widgets);
+                param.value = DAW::TrackFX_GetParam(track, slotIndex, i, &param.min, &param.max);
+                param.valueTick = tick_;
+                param.isInUse = false;
             }
         }
+        
+        slot.polledTick = tick_;
     }
-    catch (exception &e)
+    
+    FXParam &param = GetParam(track, slotIndex, paramIndex);
+    
+    if(param.valueTick != tick_)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", filePath.c_str(), lineNumber);
-        DAW::ShowConsoleMsg(buffer);
+        param.value = DAW::TrackFX_GetParam(track, slotIndex, paramIndex, &param.min, &param.max);
+        param.valueTick = tick_;
+    }
+    
+    param.isInUse = true;
+    
+    return param;
+}
+
+void FXParamCache::OnFXListChange(MediaTrack* track)
+{
+    for(auto it = slots_.begin(); it != slots_.end(); )
+    {
+        if(it->first.first == track)
+            it = slots_.erase(it);
+        else
+            ++it;
+    }
+}
+
+double FXParamCache::GetValue(MediaTrack* track, int slotIndex, int paramIndex, double* min, double* max)
+{
+    FXParam &param = GetCurrentParam(track, slotIndex, paramIndex);
+    
+    if(min)
+        *min = param.min;
+    if(max)
+        *max = param.max;
+    
+    return param.value;
+}
+
+const char* FXParamCache::GetName(MediaTrack* track, int slotIndex, int paramIndex)
+{
+    FXParam &param = GetParam(track, slotIndex, paramIndex);
+    
+    if( ! param.hasName)
+    {
+        if( ! DAW::TrackFX_GetParamName(track, slotIndex, paramIndex, param.name, sizeof(param.name)))
+            param.name[0] = 0;
+        
+        param.hasName = true;
+    }
+    
+    return param.name;
+}
+
+const char* FXParamCache::GetFormattedValue(MediaTrack* track, int slotIndex, int paramIndex)
+{
+    FXParam &param = GetCurrentParam(track, slotIndex, paramIndex);
+    
+    if( ! param.hasFormattedValue || param.formattedValue != param.value)
+    {
+        if( ! DAW::TrackFX_GetFormattedParamValue(track, slotIndex, paramIndex, param.formattedText, sizeof(param.formattedText)))
+            param.formattedText[0] = 0;
+        
+        param.formattedValue = param.value;
+        param.hasFormattedValue = true;
     }
+    
+    return param.formattedText;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -829,9 +2931,72 @@ void Manager::InitActionsDictionary()
     actions_["TrackSendVolumeDisplay"] =            new TrackSendVolumeDisplay();
 }
 
+#ifdef CSI_HEADLESS_DAW
+bool Manager::StartReplay(string filePath, bool asFastAsPossible)
+{
+    vector<RecordedEvent> events;
+    
+    if( ! CSIRecorder::Load(filePath, events) || events.size() == 0 || pages_.size() == 0)
+        return false;
+    
+    replayEvents_ = events;
+    replayPosition_ = 0;
+    replayStartTimestamp_ = CSIProfiler::GetTimestamp();
+    replayAsFastAsPossible_ = asFastAsPossible;
+    isReplaying_ = true;
+    
+    UpdateTrace();
+    DAW::SetWriteLogging(true);
+    
+    return true;
+}
+
+// Real time pace feeds whatever is due, as fast as possible feeds one recorded tick per Run so the batching matches the recording
+void Manager::ReplayTick()
+{
+    if(replayPosition_ >= replayEvents_.size())
+    {
+        FinishReplay(); // one Run after the last input so its feedback is captured
+        return;
+    }
+    
+    Page* page = pages_[currentPageIndex_];
+    int tick = replayEvents_[replayPosition_].tick;
+    double elapsed = CSIProfiler::GetTimestamp() - replayStartTimestamp_;
+    
+    while(replayPosition_ < replayEvents_.size())
+    {
+        RecordedEvent &event = replayEvents_[replayPosition_];
+        
+        if(replayAsFastAsPossible_ ? event.tick != tick : event.timestamp > elapsed)
+            break;
+        
+        if(ControlSurface* surface = page->GetSurface(event.surfaceName))
+            surface->ReplayInput(event.kind, event.payload);
+        
+        replayPosition_++;
+    }
+}
+
+void Manager::FinishReplay()
+{
+    isReplaying_ = false;
+    replayEvents_.clear();
+    
+    CSITrace::DumpToFile(string(DAW::GetResourcePath()) + "/CSI/ReplayFeedback.txt", replayStartTimestamp_);
+    DAW::DumpWriteLog(string(DAW::GetResourcePath()) + "/CSI/ReplayDAWWrites.txt");
+    DAW::SetWriteLogging(false);
+    UpdateTrace();
+    
+    DAW::ShowConsoleMsg(("Replay finished after " + to_string((int)(CSIProfiler::GetTimestamp() - replayStartTimestamp_)) + " ms\n").c_str());
+}
+#endif
+
 void Manager::Init()
 {
     pages_.clear();
+    trackAppearances_.Clear();
+    fxParams_.Clear();
 
     Page* currentPage = nullptr;
     
@@ -891,8 +3056,13 @@ void Manager::Init()
                         
                         if(tokens[0] == MidiSurfaceToken && tokens.size() == 10)
                             surface = new Midi_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), GetMidiInputForPort(inPort), GetMidiOutputForPort(outPort));
-                        else if(tokens[0] == OSCSurfaceToken && tokens.size() == 11)
-                            surface = new OSC_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), GetInputSocketForPort(tokens[1], inPort), GetOutputSocketForAddressAndPort(tokens[1], tokens[10], outPort));
+                        else if(tokens[0] == OSCSurfaceToken && (tokens.size() == 11 || tokens.size() == 12)) // optional max packet size
+                        {
+                            // The remote address may list several clients, "192.168.1.20,192.168.1.21", and/or "*" for any that send
+                            oscpkt::UdpSocket* outSocket = OSC_ControlSurface::IsClientList(tokens[10]) ? GetOutputSocketForClients(tokens[1]) : GetOutputSocketForAddressAndPort(tokens[1], tokens[10], outPort);
+                            
+                            surface = new OSC_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), GetInputSocketForPort(tokens[1], inPort), outSocket, tokens.size() == 12 ? atoi(tokens[11].c_str()) : DefaultOSCMaxPacketSize, tokens[10], outPort);
+                        }
                         else if(tokens[0] == EuConSurfaceToken && tokens.size() == 7)
                             surface = new EuCon_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[2], atoi(tokens[3].c_str()), atoi(tokens[4].c_str()), atoi(tokens[5].c_str()), atoi(tokens[6].c_str()));
 
@@ -908,6 +3078,13 @@ void Manager::Init()
         snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", iniFilePath.c_str(), lineNumber);
         DAW::ShowConsoleMsg(buffer);
     }
+    
+    // Surfaces that share a device across pages take input once their page is entered
+    if(currentPageIndex_ >= pages_.size())
+        currentPageIndex_ = 0;
+    
+    if(pages_.size() > 0)
+        pages_[currentPageIndex_]->EnterPage();
 }
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Parsing end
@@ -926,78 +3103,213 @@ void Manager::Init()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void TrackNavigator::PinChannel()
 {
-    if( ! isChannelPinned_)
+    if( ! isChannelPinned_)
+    {
+        pinnedTrack_ = GetTrack();
+        
+        isChannelPinned_ = true;
+        
+        manager_->IncChannelBias(pinnedTrack_, channelNum_);
+    }
+}
+
+void TrackNavigator::UnpinChannel()
+{
+    if(isChannelPinned_)
+    {
+        manager_->DecChannelBias(pinnedTrack_, channelNum_);
+        
+        isChannelPinned_ = false;
+        
+        pinnedTrack_ = nullptr;
+    }
+}
+
+MediaTrack* TrackNavigator::GetTrack()
+{
+    if(isChannelPinned_)
+        return pinnedTrack_;
+    else
+        return manager_->GetTrackFromChannel(channelNum_ - bias_);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MasterTrackNavigator
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+MediaTrack* MasterTrackNavigator::GetTrack()
+{
+    return DAW::GetMasterTrack(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SelectedTrackNavigator
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+MediaTrack* SelectedTrackNavigator::GetTrack()
+{
+    return page_->GetTrackNavigationManager()->GetSelectedTrack();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SendNavigator
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+MediaTrack* SendNavigator::GetTrack()
+{
+    return page_->GetTrackNavigationManager()->GetSelectedTrack();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FocusedFXNavigator
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+MediaTrack* FocusedFXNavigator::GetTrack()
+{
+    return page_->GetTrackNavigationManager()->GetFocusedFXTrack(nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TrackStateSnapshot
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+int TrackStateSnapshot::GetIndex(MediaTrack* track, TrackStateColumn column)
+{
+    auto it = lower_bound(indexes_.begin(), indexes_.end(), track, [](const pair<MediaTrack*, int> &entry, MediaTrack* track) { return entry.first < track; });
+    
+    int index = 0;
+    
+    if(it != indexes_.end() && it->first == track)
+        index = it->second;
+    else
+    {
+        index = (int)tracks_.size();
+        
+        indexes_.insert(it, make_pair(track, index));
+        tracks_.push_back(track);
+        
+        uiVolumes_.resize(tracks_.size());
+        uiPans_.resize(tracks_.size());
+        volumes_.resize(tracks_.size());
+        pans_.resize(tracks_.size());
+        widths_.resize(tracks_.size());
+        mutes_.resize(tracks_.size());
+        solos_.resize(tracks_.size());
+        selected_.resize(tracks_.size());
+        recordArms_.resize(tracks_.size());
+        autoModes_.resize(tracks_.size());
+        
+        // Columns already read this tick take the newcomer in straight away
+        for(int i = 0; i < NumTrackStateColumns; i++)
+            if(isCurrent_[i])
+                ReadColumn((TrackStateColumn)i, index, index + 1);
+    }
+    
+    if( ! isCurrent_[column])
+    {
+        ReadColumn(column, 0, (int)tracks_.size());
+        isCurrent_[column] = true;
+    }
+    
+    return index;
+}
+
+void TrackStateSnapshot::ReadColumn(TrackStateColumn column, int first, int last)
+{
+    for(int i = first; i < last; i++)
+    {
+        MediaTrack* track = tracks_[i];
+        
+        switch(column)
+        {
+            case TrackStateVolPan:
+                DAW::GetTrackUIVolPan(track, &uiVolumes_[i], &uiPans_[i]);
+                break;
+                
+            case TrackStateVolume:
+                volumes_[i] = DAW::GetMediaTrackInfo_Value(track, "D_VOL");
+                break;
+                
+            case TrackStatePan:
+                pans_[i] = DAW::GetMediaTrackInfo_Value(track, "D_PAN");
+                break;
+                
+            case TrackStateWidth:
+                widths_[i] = DAW::GetMediaTrackInfo_Value(track, "D_WIDTH");
+                break;
+                
+            case TrackStateMute:
+            {
+                bool mute = false;
+                DAW::GetTrackUIMute(track, &mute);
+                mutes_[i] = mute;
+                break;
+            }
+                
+            case TrackStateSolo:
+                solos_[i] = DAW::GetMediaTrackInfo_Value(track, "I_SOLO");
+                break;
+                
+            case TrackStateSelected:
+                selected_[i] = DAW::GetMediaTrackInfo_Value(track, "I_SELECTED");
+                break;
+                
+            case TrackStateRecordArm:
+                recordArms_[i] = DAW::GetMediaTrackInfo_Value(track, "I_RECARM");
+                break;
+                
+            case TrackStateAutoMode:
+                autoModes_[i] = (int)DAW::GetMediaTrackInfo_Value(track, "I_AUTOMODE");
+                break;
+                
+            default:
+                break;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TrackNavigationManager
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+MediaTrack* TrackNavigationManager::GetFocusedFXTrack(int* fxIndex)
+{
+    if( ! isFocusedFXCurrent_)
     {
-        pinnedTrack_ = GetTrack();
+        int trackNumber = 0;
+        int itemNumber = 0;
         
-        isChannelPinned_ = true;
+        focusedFXTrack_ = nullptr;
+        focusedFXIndex_ = 0;
         
-        manager_->IncChannelBias(pinnedTrack_, channelNum_);
+        if(DAW::GetFocusedFX(&trackNumber, &itemNumber, &focusedFXIndex_) == 1) // Track FX
+            focusedFXTrack_ = GetTrackFromId(trackNumber);
+        
+        isFocusedFXCurrent_ = true;
     }
+    
+    if(fxIndex)
+        *fxIndex = focusedFXIndex_;
+    
+    return focusedFXTrack_;
 }
 
-void TrackNavigator::UnpinChannel()
+MediaTrack* TrackNavigationManager::GetLastTouchedFXTrack(int* fxSlot, int* fxParam)
 {
-    if(isChannelPinned_)
+    if( ! isLastTouchedFXCurrent_)
     {
-        manager_->DecChannelBias(pinnedTrack_, channelNum_);
+        int trackNumber = 0;
         
-        isChannelPinned_ = false;
+        lastTouchedFXTrack_ = nullptr;
+        lastTouchedFXSlot_ = 0;
+        lastTouchedFXParam_ = 0;
         
-        pinnedTrack_ = nullptr;
+        if(DAW::GetLastTouchedFX(&trackNumber, &lastTouchedFXSlot_, &lastTouchedFXParam_))
+            lastTouchedFXTrack_ = GetTrackFromId(trackNumber);
+        
+        isLastTouchedFXCurrent_ = true;
     }
-}
-
-MediaTrack* TrackNavigator::GetTrack()
-{
-    if(isChannelPinned_)
-        return pinnedTrack_;
-    else
-        return manager_->GetTrackFromChannel(channelNum_ - bias_);
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-// MasterTrackNavigator
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-MediaTrack* MasterTrackNavigator::GetTrack()
-{
-    return DAW::GetMasterTrack(0);
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-// SelectedTrackNavigator
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-MediaTrack* SelectedTrackNavigator::GetTrack()
-{
-    return page_->GetTrackNavigationManager()->GetSelectedTrack();
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-// SendNavigator
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-MediaTrack* SendNavigator::GetTrack()
-{
-    return page_->GetTrackNavigationManager()->GetSelectedTrack();
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-// FocusedFXNavigator
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-MediaTrack* FocusedFXNavigator::GetTrack()
-{
-    int trackNumber = 0;
-    int itemNumber = 0;
-    int fxIndex = 0;
     
-    if(DAW::GetFocusedFX(&trackNumber, &itemNumber, &fxIndex) == 1) // Track FX
-        return page_->GetTrackNavigationManager()->GetTrackFromId(trackNumber);
-    else
-        return nullptr;
+    *fxSlot = lastTouchedFXSlot_;
+    *fxParam = lastTouchedFXParam_;
+    
+    return lastTouchedFXTrack_;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-// TrackNavigationManager
-////////////////////////////////////////////////////////////////////////////////////////////////////////
 void TrackNavigationManager::ForceScrollLink()
 {
     // Make sure selected track is visble on the control surface
@@ -1174,6 +3486,26 @@ TrackNavigationManager* ActionContext::GetTrackNavigationManager()
     return GetPage()->GetTrackNavigationManager();
 }
 
+TrackStateSnapshot* ActionContext::GetTrackStates()
+{
+    return GetPage()->GetTrackNavigationManager()->GetTrackStates();
+}
+
+TrackAppearanceCache* ActionContext::GetTrackAppearances()
+{
+    return TheManager->GetTrackAppearances();
+}
+
+FXParamCache* ActionContext::GetFXParams()
+{
+    return TheManager->GetFXParams();
+}
+
+const char* ActionContext::GetFXParamName(MediaTrack* track)
+{
+    return GetFXParams()->GetName(track, GetSlotIndex(), paramIndex_);
+}
+
 MediaTrack* ActionContext::GetTrack()
 {
     return zone_->GetNavigator()->GetTrack();
@@ -1218,11 +3550,11 @@ void ActionContext::UpdateWidgetValue(double value)
     {
         if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
         {
-            unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
+            unsigned int rgb_colour = GetTrackAppearances()->GetColour(track);
             
-            int r = (*rgb_colour >> 0) & 0xff;
-            int g = (*rgb_colour >> 8) & 0xff;
-            int b = (*rgb_colour >> 16) & 0xff;
+            int r = (rgb_colour >> 0) & 0xff;
+            int g = (rgb_colour >> 8) & 0xff;
+            int b = (rgb_colour >> 16) & 0xff;
             
             widget_->UpdateRGBValue(r, g, b);
         }
@@ -1250,11 +3582,11 @@ void ActionContext::UpdateWidgetValue(int param, double value)
     {
         if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
         {
-            unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
+            unsigned int rgb_colour = GetTrackAppearances()->GetColour(track);
             
-            int r = (*rgb_colour >> 0) & 0xff;
-            int g = (*rgb_colour >> 8) & 0xff;
-            int b = (*rgb_colour >> 16) & 0xff;
+            int r = (rgb_colour >> 0) & 0xff;
+            int g = (rgb_colour >> 8) & 0xff;
+            int b = (rgb_colour >> 16) & 0xff;
             
             widget_->UpdateRGBValue(r, g, b);
         }
@@ -1269,11 +3601,11 @@ void ActionContext::UpdateWidgetValue(string value)
     {
         if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
         {
-            unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
+            unsigned int rgb_colour = GetTrackAppearances()->GetColour(track);
             
-            int r = (*rgb_colour >> 0) & 0xff;
-            int g = (*rgb_colour >> 8) & 0xff;
-            int b = (*rgb_colour >> 16) & 0xff;
+            int r = (rgb_colour >> 0) & 0xff;
+            int g = (rgb_colour >> 8) & 0xff;
+            int b = (rgb_colour >> 16) & 0xff;
             
             widget_->UpdateRGBValue(r, g, b);
         }
@@ -1298,6 +3630,16 @@ void ActionContext::DoAction(double value)
         DoRangeBoundAction(value);
 }
 
+void ActionContext::DoAction(string value)
+{
+    action_->DoString(this, value);
+    GetTrackStates()->Invalidate(); // the action may have changed any track
+    GetFXParams()->Invalidate();
+    
+    if(CSIProfiler::IsEnabled())
+        CSIProfiler::RecordActionLatency(widget_->GetSurface()->GetTraceId(), action_);
+}
+
 void ActionContext::DoRelativeAction(double delta)
 {
     if(steppedValues_.size() > 0)
@@ -1363,6 +3705,11 @@ void ActionContext::DoRangeBoundAction(double value)
             value = rangeMinimum_;
         
         action_->Do(this, value);
+        GetTrackStates()->Invalidate(); // the action may have changed any track
+        GetFXParams()->Invalidate();
+        
+        if(CSIProfiler::IsEnabled())
+            CSIProfiler::RecordActionLatency(widget_->GetSurface()->GetTraceId(), action_);
     }
 }
 
@@ -1470,8 +3817,8 @@ void WidgetActionBroker::GetFormattedFXParamValue(char *buffer, int bufferSize)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void Zone::Deactivate()
 {
-    if(hwnd_ != nullptr && IsWindow(hwnd_))
-        DestroyWindow(hwnd_);
+    if(hwnd_ != nullptr)
+        DAW::DestroyWindow(hwnd_);
         
     for(auto widget : widgets_)
         widget->Deactivate();
@@ -1533,6 +3880,8 @@ void ZoneTemplate::ProcessWidgetActionTemplates(ControlSurface* surface, Zone* z
 
 void ZoneTemplate::Activate(ControlSurface* surface, vector<Zone*> &activeZones)
 {
+    ProfileScope profileScope(ProfileZoneActivate, surface->GetTraceId());
+    
     for(auto includedZoneTemplateStr : includedZoneTemplates)
         if(ZoneTemplate* includedZoneTemplate = surface->GetZoneTemplate(includedZoneTemplateStr))
             includedZoneTemplate->Activate(surface, activeZones);
@@ -1558,6 +3907,8 @@ void ZoneTemplate::Activate(ControlSurface* surface, vector<Zone*> &activeZones)
 
 void ZoneTemplate::Activate(ControlSurface*  surface, vector<Zone*> &activeZones, int slotIndex, bool shouldShowFXWindows, bool shouldUseNoAction)
 {
+    ProfileScope profileScope(ProfileZoneActivate, surface->GetTraceId());
+    
     for(auto includedZoneTemplateStr : includedZoneTemplates)
         if(ZoneTemplate* includedZoneTemplate = surface->GetZoneTemplate(includedZoneTemplateStr))
             includedZoneTemplate->Activate(surface, activeZones, slotIndex, shouldShowFXWindows, shouldUseNoAction);
@@ -1620,12 +3971,26 @@ void Widget::DoAction(double value)
 {
     LogInput(value);
     
+    if(CSIProfiler::IsEnabled())
+        pendingFeedbackInputTimestamp_ = CSIProfiler::GetInputTimestamp();
+    
+    currentWidgetActionBroker_.GetActionBundle().DoAction(value);
+}
+
+void Widget::DoAction(string value)
+{
+    if(CSIProfiler::IsEnabled())
+        pendingFeedbackInputTimestamp_ = CSIProfiler::GetInputTimestamp();
+    
     currentWidgetActionBroker_.GetActionBundle().DoAction(value);
 }
 
 void Widget::DoRelativeAction(double delta)
 {
     LogInput(delta);
+    
+    if(CSIProfiler::IsEnabled())
+        pendingFeedbackInputTimestamp_ = CSIProfiler::GetInputTimestamp();
 
     currentWidgetActionBroker_.GetActionBundle().DoRelativeAction(delta);
 }
@@ -1633,6 +3998,9 @@ void Widget::DoRelativeAction(double delta)
 void Widget::DoRelativeAction(int accelerationIndex, double delta)
 {
     LogInput(accelerationIndex);
+    
+    if(CSIProfiler::IsEnabled())
+        pendingFeedbackInputTimestamp_ = CSIProfiler::GetInputTimestamp();
 
     currentWidgetActionBroker_.GetActionBundle().DoRelativeAction(accelerationIndex, delta);
 }
@@ -1679,26 +4047,32 @@ void  Widget::ForceClear()
         processor->ForceClear();
 }
 
-void Widget::ClearCache()
+void Widget::AddFeedbackProcessor(FeedbackProcessor* feedbackProcessor)
 {
-    for(auto processor : feedbackProcessors_)
-        processor->ClearCache();
+    feedbackProcessor->SetOutputIndex(feedbackProcessors_.size());
+    feedbackProcessors_.push_back(feedbackProcessor);
 }
 
-void Widget::LogInput(double value)
+// The first feedback a widget sends after an input is taken as the echo of that input
+void Widget::LogFeedbackLatency()
 {
-    if( TheManager->GetSurfaceInDisplay())
+    if(pendingFeedbackInputTimestamp_ != 0.0)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %s %f\n", GetSurface()->GetName().c_str(), GetName().c_str(), value);
-        DAW::ShowConsoleMsg(buffer);
+        CSIProfiler::RecordFeedbackLatency(surface_->GetTraceId(), pendingFeedbackInputTimestamp_);
+        pendingFeedbackInputTimestamp_ = 0.0;
     }
 }
 
+void Widget::LogInput(double value)
+{
+    if(CSITrace::IsEnabled(TraceInput))
+        CSITrace::Record(TraceWidgetInput, surface_->GetTraceId(), traceId_, value);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // OSC_CSIMessageGenerator : public CSIMessageGenerator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-OSC_CSIMessageGenerator::OSC_CSIMessageGenerator(OSC_ControlSurface* surface, Widget* widget, string message) : CSIMessageGenerator(widget)
+OSC_CSIMessageGenerator::OSC_CSIMessageGenerator(OSC_ControlSurface* surface, Widget* widget, string message, int argumentIndex) : CSIMessageGenerator(widget), argumentIndex_(argumentIndex)
 {
     surface->AddCSIMessageGenerator(message, this);
 }
@@ -1711,6 +4085,44 @@ EuCon_CSIMessageGenerator::EuCon_CSIMessageGenerator(EuCon_ControlSurface* surfa
     surface->AddCSIMessageGenerator(message, this);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShadowState
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+ShadowState::~ShadowState()
+{
+    for(auto [key, value] : values_)
+        delete value;
+}
+
+ShadowValue* ShadowState::GetValue(Widget* widget, int outputChannel, double epsilon)
+{
+    pair<Widget*, int> key(widget, outputChannel);
+    
+    if(values_.count(key) < 1)
+        values_[key] = new ShadowValue(this, epsilon);
+    
+    return values_[key];
+}
+
+void ShadowState::InvalidateAll()
+{
+    numResyncs_++;
+    
+    for(auto [key, value] : values_)
+        value->Invalidate();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FeedbackProcessor
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+ShadowValue* FeedbackProcessor::GetShadowValue(ShadowChannel channel, double epsilon)
+{
+    if(shadowValues_[channel] == nullptr)
+        shadowValues_[channel] = widget_->GetSurface()->GetShadowState()->GetValue(widget_, outputIndex_ * NumShadowChannels + channel, epsilon);
+    
+    return shadowValues_[channel];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Midi_FeedbackProcessor
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1719,9 +4131,15 @@ void Midi_FeedbackProcessor::SendMidiMessage(MIDI_event_ex_t* midiMessage)
     surface_->SendMidiMessage(this, midiMessage);
 }
 
+// Bytes are masked the same way they end up in midi_message, so the shadow holds exactly what went out on the wire
+static int PackMidiMessage(int first, int second, int third)
+{
+    return ((first & 0xff) << 16) | ((second & 0xff) << 8) | (third & 0xff);
+}
+
 void Midi_FeedbackProcessor::SendMidiMessage(int first, int second, int third)
 {
-    if(mustForce_ || first != lastMessageSent_->midi_message[0] || second != lastMessageSent_->midi_message[1] || third != lastMessageSent_->midi_message[2])
+    if(mustForce_ || ! GetShadowValue(ShadowChannelMidi)->IsCurrent(PackMidiMessage(first, second, third)))
     {
         ForceMidiMessage(first, second, third);
     }
@@ -1734,9 +4152,7 @@ void Midi_FeedbackProcessor::SendMidiMessage(int first, int second, int third)
 
 void Midi_FeedbackProcessor::ForceMidiMessage(int first, int second, int third)
 {
-    lastMessageSent_->midi_message[0] = first;
-    lastMessageSent_->midi_message[1] = second;
-    lastMessageSent_->midi_message[2] = third;
+    GetShadowValue(ShadowChannelMidi)->Set(PackMidiMessage(first, second, third));
     surface_->SendMidiMessage(this, first, second, third);
 }
 
@@ -1745,37 +4161,36 @@ void Midi_FeedbackProcessor::ForceMidiMessage(int first, int second, int third)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void OSC_FeedbackProcessor::UpdateValue(double value)
 {
-    if(lastDoubleValue_ != value)
+    if( ! GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->IsCurrent(value))
         ForceValue(value);
 }
 
+// OSC has no slot for the param, only the value goes out, so only the value is compared
 void OSC_FeedbackProcessor::UpdateValue(int param, double value)
 {
-    if(lastDoubleValue_ != value)
-        ForceValue(value);
+    UpdateValue(value);
 }
 
 void OSC_FeedbackProcessor::UpdateValue(string value)
 {
-    if(lastStringValue_ != value)
+    if( ! GetShadowValue(ShadowChannelString)->IsCurrent(value))
         ForceValue(value);
 }
 
 void OSC_FeedbackProcessor::ForceValue(double value)
 {
-    lastDoubleValue_ = value;
+    GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->Set(value);
     surface_->SendOSCMessage(this, oscAddress_, value);
 }
 
 void OSC_FeedbackProcessor::ForceValue(int param, double value)
 {
-    lastDoubleValue_ = value;
-    surface_->SendOSCMessage(this, oscAddress_, value);
+    ForceValue(value);
 }
 
 void OSC_FeedbackProcessor::ForceValue(string value)
 {
-    lastStringValue_ = value;
+    GetShadowValue(ShadowChannelString)->Set(value);
     surface_->SendOSCMessage(this, oscAddress_, value);
 }
 
@@ -1787,45 +4202,50 @@ void OSC_FeedbackProcessor::SilentSetValue(string value)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // EuCon_FeedbackProcessor
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+EuCon_FeedbackProcessor::EuCon_FeedbackProcessor(EuCon_ControlSurface* surface, Widget* widget, string address) : FeedbackProcessor(widget), surface_(surface)
+{
+    addressId_ = surface->InternAddress(address);
+}
+
 void EuCon_FeedbackProcessor::UpdateValue(double value)
 {
-    if(lastDoubleValue_ != value)
+    if( ! GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->IsCurrent(value))
         ForceValue(value);
 }
 
 void EuCon_FeedbackProcessor::UpdateValue(int param, double value)
 {
-    if(lastDoubleValue_ != value)
+    if( ! GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->IsCurrent(param, value))
         ForceValue(param, value);
 }
 
 void EuCon_FeedbackProcessor::UpdateValue(string value)
 {
-    if(lastStringValue_ != value)
+    if( ! GetShadowValue(ShadowChannelString)->IsCurrent(value))
         ForceValue(value);
 }
 
 void EuCon_FeedbackProcessor::ForceValue(double value)
 {
-    lastDoubleValue_ = value;
-    surface_->SendEuConMessage(this, address_, value);
+    GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->Set(value);
+    surface_->SendEuConMessage(this, addressId_, value);
 }
 
 void EuCon_FeedbackProcessor::ForceValue(int param, double value)
 {
-    lastDoubleValue_ = value;
-    surface_->SendEuConMessage(this, address_, value, param);
+    GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->Set(param, value);
+    surface_->SendEuConMessage(this, addressId_, value, param);
 }
 
 void EuCon_FeedbackProcessor::ForceValue(string value)
 {
-    lastStringValue_ = value;
-    surface_->SendEuConMessage(this, address_, value);
+    GetShadowValue(ShadowChannelString)->Set(value);
+    surface_->SendEuConMessage(this, addressId_, value);
 }
 
 void EuCon_FeedbackProcessor::SilentSetValue(string value)
 {
-    surface_->SendEuConMessage(this, address_, value);
+    surface_->SendEuConMessage(this, addressId_, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1833,14 +4253,14 @@ void EuCon_FeedbackProcessor::SilentSetValue(string value)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void EuCon_FeedbackProcessorDB::Clear()
 {
-    if(lastDoubleValue_ != -100.0)
+    if( ! GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->IsCurrent(-100.0))
         ForceClear();
 }
 
 void EuCon_FeedbackProcessorDB::ForceClear()
 {
-    lastDoubleValue_ = -100.0;
-    surface_->SendEuConMessage(this, address_, -100.0);
+    GetShadowValue(ShadowChannelValue, ShadowValueEpsilon)->Set(-100.0);
+    surface_->SendEuConMessage(this, addressId_, -100.0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1959,14 +4379,11 @@ void FXActivationManager::MapSelectedTrackFXSlotToWidgets(MediaTrack* selectedTr
 
 void FXActivationManager::MapFocusedFXToWidgets()
 {
-    int trackNumber = 0;
-    int itemNumber = 0;
     int fxIndex = 0;
-    MediaTrack* focusedTrack = nullptr;
+    MediaTrack* focusedTrack = surface_->GetPage()->GetTrackNavigationManager()->GetFocusedFXTrack(&fxIndex);
     
-    if(DAW::GetFocusedFX(&trackNumber, &itemNumber, &fxIndex) == 1)
-        if(trackNumber > 0)
-            focusedTrack = surface_->GetPage()->GetTrackNavigationManager()->GetTrackFromId(trackNumber);
+    if(focusedTrack == DAW::GetMasterTrack(nullptr))
+        focusedTrack = nullptr;
     
     for(auto zone : activeFocusedFXZones_)
     {
@@ -1997,7 +4414,7 @@ void FXActivationManager::MapFocusedFXToWidgets()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ControlSurface
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-ControlSurface::ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string zoneFolder, int numChannels, int numSends, int numFX, int options) :  CSurfIntegrator_(CSurfIntegrator), page_(page), name_(name), zoneFolder_(zoneFolder), fxActivationManager_(new FXActivationManager(this, numFX)), numChannels_(numChannels), numSends_(numSends), options_(options), defaultZone_(new Zone(this, GetPage()->GetDefaultNavigator(), "Default", "Default", ""))
+ControlSurface::ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string zoneFolder, int numChannels, int numSends, int numFX, int options) :  CSurfIntegrator_(CSurfIntegrator), page_(page), name_(name), traceId_(CSITrace::RegisterName(name)), zoneFolder_(zoneFolder), fxActivationManager_(new FXActivationManager(this, numFX)), numChannels_(numChannels), numSends_(numSends), options_(options), defaultZone_(new Zone(this, GetPage()->GetDefaultNavigator(), "Default", "Default", ""))
 {
     for(int i = 0; i < numChannels; i++)
         navigators_[i] = GetPage()->GetTrackNavigationManager()->AddNavigator();
@@ -2011,7 +4428,20 @@ void ControlSurface::InitZones(string zoneFolder)
         listZoneFiles(DAW::GetResourcePath() + string("/CSI/Zones/") + zoneFolder + "/", zoneFilesToProcess); // recursively find all the .zon files, starting at zoneFolder
         
         for(auto zoneFilename : zoneFilesToProcess)
-            ProcessZoneFile(zoneFilename, this);
+        {
+            string fxName = GetFXZoneName(zoneFilename);
+            
+            if(fxName == "")
+                ProcessZoneFile(zoneFilename, this);
+            else if(fxZoneFilePaths_.count(fxName) > 0 || zoneTemplates_.count(fxName) > 0)
+            {
+                char buffer[250];
+                snprintf(buffer, sizeof(buffer), "%s already has a Zone named: %s -- please check for duplicate zone defintions.\n", name_.c_str(), fxName.c_str());
+                DAW::ShowConsoleMsg(buffer);
+            }
+            else
+                fxZoneFilePaths_[fxName] = zoneFilename;
+        }
     }
     catch (exception &e)
     {
@@ -2021,6 +4451,40 @@ void ControlSurface::InitZones(string zoneFolder)
     }
 }
 
+ZoneTemplate* ControlSurface::GetZoneTemplate(string zoneName)
+{
+    if(fxZoneFilePaths_.count(zoneName) == 0)
+    {
+        if(zoneTemplates_.count(zoneName) > 0)
+            return zoneTemplates_[zoneName];
+        else
+            return nullptr;
+    }
+    
+    if(zoneTemplates_.count(zoneName) == 0)
+        ProcessZoneFile(fxZoneFilePaths_[zoneName], this);
+    
+    residentFXZones_.remove(zoneName);
+    residentFXZones_.push_front(zoneName);
+    
+    while(residentFXZones_.size() > MaxResidentFXZones)
+    {
+        string evictedZoneName = residentFXZones_.back();
+        residentFXZones_.pop_back();
+        
+        if(zoneTemplates_.count(evictedZoneName) > 0)
+        {
+            delete zoneTemplates_[evictedZoneName];
+            zoneTemplates_.erase(evictedZoneName);
+        }
+    }
+    
+    if(zoneTemplates_.count(zoneName) > 0)
+        return zoneTemplates_[zoneName];
+    else
+        return nullptr;
+}
+
 Navigator* ControlSurface::GetNavigatorForChannel(int channelNum)
 {
     if(channelNum < 0)
@@ -2098,12 +4562,6 @@ void ControlSurface::MapSelectedTrackSendsToWidgets()
     }
 }
 
-void ControlSurface::SurfaceOutMonitor(Widget* widget, string address, string value)
-{
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg(("OUT->" + name_ + " " + address + " " + value + "\n").c_str());
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Midi_ControlSurface
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2117,8 +4575,26 @@ void Midi_ControlSurface::InitWidgets(string templateFilename, string zoneFolder
     GetPage()->ForceRefreshTimeDisplay();
 }
 
+void Midi_ControlSurface::ReplayInput(RecordKind kind, const vector<unsigned char> &payload)
+{
+    if(kind != RecordMidi || payload.size() < 1)
+        return;
+    
+    // SysEx runs past the 4 bytes of midi_message, so the event needs its own storage
+    vector<unsigned char> storage(sizeof(MIDI_event_ex_t) + payload.size());
+    MIDI_event_ex_t* evt = (MIDI_event_ex_t*)storage.data();
+    
+    evt->frame_offset = 0;
+    evt->size = payload.size();
+    memcpy(evt->midi_message, payload.data(), payload.size());
+    
+    ProcessMidiMessage(evt);
+}
+
 void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t* evt)
 {
+    ProfileScope profileScope(ProfileProcessMidiMessage, traceId_);
+    
     bool isMapped = false;
     
     // At this point we don't know how much of the message comprises the key, so try all three
@@ -2142,13 +4618,8 @@ void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t* evt)
         
     }
     
-    if( ! isMapped && TheManager->GetSurfaceInDisplay())
-    {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %02x  %02x  %02x \n", name_.c_str(), evt->midi_message[0], evt->midi_message[1], evt->midi_message[2]);
-        DAW::ShowConsoleMsg(buffer);
-        
-    }
+    if( ! isMapped && CSITrace::IsEnabled(TraceInput))
+        CSITrace::Record(TraceMidiInput, traceId_, 0, evt->midi_message, 3);
 }
 
 void Midi_ControlSurface::SendMidiMessage(Midi_FeedbackProcessor* feedbackProcessor, MIDI_event_ex_t* midiMessage)
@@ -2156,8 +4627,11 @@ void Midi_ControlSurface::SendMidiMessage(Midi_FeedbackProcessor* feedbackProces
     if(midiOutput_)
         midiOutput_->SendMsg(midiMessage, -1);
     
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg(("OUT->" + name_ + " SysEx\n").c_str());
+    if(CSIProfiler::IsEnabled() && feedbackProcessor)
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
+    
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceSysExOutput, traceId_, feedbackProcessor ? feedbackProcessor->GetWidget()->GetTraceId() : 0, midiMessage->midi_message, midiMessage->size);
 }
 
 void Midi_ControlSurface::SendMidiMessage(Midi_FeedbackProcessor* feedbackProcessor, int first, int second, int third)
@@ -2165,11 +4639,13 @@ void Midi_ControlSurface::SendMidiMessage(Midi_FeedbackProcessor* feedbackProces
     if(midiOutput_)
         midiOutput_->Send(first, second, third, -1);
     
-    if(TheManager->GetSurfaceOutDisplay())
+    if(CSIProfiler::IsEnabled() && feedbackProcessor)
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
+    
+    if(CSITrace::IsEnabled(TraceOutput))
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "%s  %02x  %02x  %02x \n", ("OUT->" + name_).c_str(), first, second, third);
-        DAW::ShowConsoleMsg(buffer);
+        unsigned char bytes[] = { (unsigned char)first, (unsigned char)second, (unsigned char)third };
+        CSITrace::Record(TraceMidiOutput, traceId_, feedbackProcessor ? feedbackProcessor->GetWidget()->GetTraceId() : 0, bytes, 3);
     }
 }
 
@@ -2187,129 +4663,347 @@ void OSC_ControlSurface::InitWidgets(string templateFilename, string zoneFolder)
     GetPage()->ForceRefreshTimeDisplay();
 }
 
-void OSC_ControlSurface::ProcessOSCMessage(string message, double value)
+void OSC_ControlSurface::ProcessOSCMessage(string_view address, const OSCArguments &arguments)
 {
-    if(CSIMessageGeneratorsByOSCMessage_.count(message) > 0)
-        CSIMessageGeneratorsByOSCMessage_[message]->ProcessOSCMessage(message, value);
+    int addressIds[MaxOSCMatches];
+    int numMatches = addressMatcher_.Match(address, addressIds, MaxOSCMatches);
+    
+    if(numMatches == 0 && address == OSCResyncAddress)
+        Resync();
+    
+    for(int i = 0; i < numMatches; i++)
+        ProcessOSCMessage(addressIds[i], nullptr, arguments);
     
-    if(TheManager->GetSurfaceInDisplay())
+    if(CSITrace::IsEnabled(TraceInput))
+        CSITrace::Record(TraceOSCInput, traceId_, 0, string(address).c_str(), arguments.values[0]);
+}
+
+void OSC_ControlSurface::ProcessOSCMessage(int addressId, const char* address, const OSCArguments &arguments)
+{
+    // Each widget on the address takes its own argument, so an XY pad moves both axes in one dispatch
+    if(addressId < 0 && address != nullptr && address == OSCResyncAddress)
+        Resync();
+    else if(addressId >= 0)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %s  %f  \n", name_.c_str(), message.c_str(), value);
-        DAW::ShowConsoleMsg(buffer);
+        for(auto messageGenerator : CSIMessageGeneratorsByAddressId_[addressId])
+        {
+            int argumentIndex = messageGenerator->GetArgumentIndex();
+            
+            if(argumentIndex >= arguments.numArguments)
+                continue;
+            
+            if(argumentIndex == arguments.stringArgumentIndex)
+            {
+                if( ! arguments.isStringTruncated)
+                    messageGenerator->ProcessOSCMessage(addresses_[addressId], string(arguments.stringValue));
+            }
+            else if(arguments.isNumeric[argumentIndex]) // a blob or an unknown tag is no position or press
+                messageGenerator->ProcessOSCMessage(addresses_[addressId], arguments.values[argumentIndex]);
+        }
+    }
+    
+    if(address != nullptr && CSITrace::IsEnabled(TraceInput))
+    {
+        if(arguments.stringArgumentIndex == 0)
+            CSITrace::Record(TraceOSCInput, traceId_, 0, address, arguments.stringValue);
+        else
+            CSITrace::Record(TraceOSCInput, traceId_, 0, address, arguments.values[0]);
     }
 }
 
-void OSC_ControlSurface::LoadingZone(string zoneName)
+// Size of a message inside a bundle: length prefix, padded address, padded ",<tag>" and the argument
+static int GetBundledOSCMessageSize(const string &oscAddress, int argumentSize)
 {
-    string oscAddress(zoneName);
-    oscAddress = regex_replace(oscAddress, regex(BadFileChars), "_");
-    oscAddress = "/" + oscAddress;
+    return 4 + oscpkt::ceil4((int)oscAddress.size() + 1) + (argumentSize < 0 ? 4 : 4 + argumentSize);
+}
+
+void OSC_ControlSurface::AddToBundle(OSCClient* client, const oscpkt::Message &message, int messageSize)
+{
+    if(client->bundleSize > 0 && client->bundleSize + messageSize > maxPacketSize_)
+        FlushBundle(client);
+    
+    if(client->bundleSize == 0)
+    {
+        client->packetWriter.init().startBundle();
+        client->bundleSize = 16; // "#bundle" and the time tag
+    }
+    
+    client->packetWriter.addMessage(message);
+    client->bundleSize += messageSize;
+    client->numBundledMessages++;
+}
 
+void OSC_ControlSurface::FlushBundle(OSCClient* client)
+{
+    if(client->bundleSize == 0)
+        return;
+    
+    oscpkt::PacketWriter &packetWriter = client->packetWriter;
+    packetWriter.endBundle();
+    
     if(outSocket_ != nullptr && outSocket_->isOk())
     {
-        oscpkt::Message message;
-        message.init(oscAddress);
-        packetWriter_.init().addMessage(message);
-        outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        if(client->isConnected)
+            outSocket_->sendPacket(packetWriter.packetData(), packetWriter.packetSize());
+        else
+            outSocket_->sendPacketTo(packetWriter.packetData(), packetWriter.packetSize(), client->address);
+        
+        numPacketsSent_++;
+        numBytesSent_ += packetWriter.packetSize();
+        numMessagesSent_ += client->numBundledMessages;
+        
+        if(CSIProfiler::IsEnabled())
+            CSIProfiler::RecordOSCPacket(traceId_, packetWriter.packetSize(), client->numBundledMessages);
+    }
+    
+    client->numPacketsThisTick++;
+    client->bundleSize = 0;
+    client->numBundledMessages = 0;
+}
+
+static bool IsSameOSCClient(const oscpkt::SockAddr &address, const oscpkt::SockAddr &otherAddress)
+{
+    return address.actualLen() == otherAddress.actualLen() && memcmp(&address.addr(), &otherAddress.addr(), address.actualLen()) == 0;
+}
+
+// Clients are answered on the surface's remote port, whatever port they happen to send from
+static void SetOSCClientPort(oscpkt::SockAddr &address, int port)
+{
+    if(address.addr().sa_family == AF_INET)
+        ((sockaddr_in*)&address.addr())->sin_port = htons(port);
+    else if(address.addr().sa_family == AF_INET6)
+        ((sockaddr_in6*)&address.addr())->sin6_port = htons(port);
+}
+
+void OSC_ControlSurface::InitClients(const string &remoteAddresses)
+{
+    if( ! IsClientList(remoteAddresses))
+    {
+        // The classic single remote address, outSocket_ is already connected to it
+        if(outSocket_ != nullptr && outSocket_->isOk())
+            AddClient(outSocket_->remote_addr, true)->isConnected = true;
+        
+        return;
+    }
+    
+    istringstream addresses(remoteAddresses);
+    
+    for(string remoteAddress; getline(addresses, remoteAddress, ','); )
+    {
+        if(remoteAddress == "*")
+            autoRegistersClients_ = true;
+        else if(remoteAddress != "")
+        {
+            oscpkt::UdpSocket resolver; // connecting a UDP socket only resolves the address, nothing is sent
+            
+            if(resolver.connectTo(remoteAddress, clientPort_))
+                AddClient(resolver.remote_addr, true);
+        }
+    }
+}
+
+OSCClient* OSC_ControlSurface::AddClient(oscpkt::SockAddr address, bool isConfigured)
+{
+    OSCClient* client = new OSCClient();
+    client->address = address;
+    client->isConfigured = isConfigured;
+    client->lastSeen = isConfigured ? 0.0 : DAW::GetCurrentNumberOfMilliseconds();
+    
+    clients_.push_back(client);
+    
+    ResyncClient(client); // starts blank
+    
+    return client;
+}
+
+void OSC_ControlSurface::RegisterClient(oscpkt::SockAddr address)
+{
+    SetOSCClientPort(address, clientPort_);
+    
+    double now = DAW::GetCurrentNumberOfMilliseconds();
+    
+    for(auto client : clients_)
+    {
+        if(IsSameOSCClient(client->address, address))
+        {
+            // Heard from for the first time, or again after going quiet, either way it may have lost what it showed
+            if(now - client->lastSeen > OSCClientIdleTimeout)
+                ResyncClient(client);
+            
+            client->lastSeen = now;
+            return;
+        }
+    }
+    
+    if(autoRegistersClients_)
+        AddClient(address, false);
+}
+
+void OSC_ControlSurface::RemoveIdleClients()
+{
+    double now = DAW::GetCurrentNumberOfMilliseconds();
+    
+    for(int i = clients_.size() - 1; i >= 0; i--)
+    {
+        if( ! clients_[i]->isConfigured && now - clients_[i]->lastSeen > OSCClientIdleTimeout)
+        {
+            delete clients_[i];
+            clients_.erase(clients_.begin() + i);
+        }
+    }
+}
+
+void OSC_ControlSurface::ResyncClient(OSCClient* client)
+{
+    // Forget what the client was sent, so everything that has a value goes out again, in address order,
+    // from the values as they stand when SendToClient runs at the end of the tick
+    client->sentValues.assign(feedbackValues_.size(), OSCFeedbackValue());
+    client->isPending.assign(feedbackValues_.size(), false);
+    client->pendingAddressIds.clear();
+    
+    for(int i = 0; i < feedbackValues_.size(); i++)
+    {
+        if(feedbackValues_[i].hasValue)
+        {
+            client->pendingAddressIds.push_back(i);
+            client->isPending[i] = true;
+        }
     }
     
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg((zoneName + "->" + "LoadingZone---->" + name_ + "\n").c_str());
+    if(currentZoneAddress_ != "")
+    {
+        message_.init(currentZoneAddress_);
+        AddToBundle(client, message_, GetBundledOSCMessageSize(currentZoneAddress_, -1));
+    }
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, double value)
+void OSC_ControlSurface::SetFeedbackValue(const string &oscAddress, const OSCFeedbackValue &value)
 {
-    if(outSocket_ != nullptr && outSocket_->isOk())
+    int addressId = 0;
+    
+    if(feedbackAddressIds_.count(oscAddress) > 0)
+        addressId = feedbackAddressIds_[oscAddress];
+    else
     {
-        oscpkt::Message message;
-        message.init(oscAddress).pushFloat(value);
-        packetWriter_.init().addMessage(message);
-        outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        addressId = feedbackAddresses_.size();
+        feedbackAddressIds_[oscAddress] = addressId;
+        feedbackAddresses_.push_back(oscAddress);
+        feedbackValues_.push_back(OSCFeedbackValue());
+        
+        for(auto client : clients_)
+        {
+            client->sentValues.push_back(OSCFeedbackValue());
+            client->isPending.push_back(false);
+        }
     }
     
-    if(TheManager->GetSurfaceOutDisplay())
+    feedbackValues_[addressId] = value;
+    
+    for(auto client : clients_)
     {
-        if(TheManager->GetSurfaceOutDisplay())
-            DAW::ShowConsoleMsg(("OUT->" + name_ + " " + oscAddress + " " + to_string(value) + "\n").c_str());
+        if( ! client->isPending[addressId])
+        {
+            client->pendingAddressIds.push_back(addressId);
+            client->isPending[addressId] = true;
+        }
     }
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, string value)
+void OSC_ControlSurface::SendToClient(OSCClient* client)
 {
-    if(outSocket_ != nullptr && outSocket_->isOk())
+    client->numPacketsThisTick = 0;
+    
+    int numSent = 0;
+    
+    for( ; numSent < client->pendingAddressIds.size(); numSent++)
     {
-        oscpkt::Message message;
-        message.init(oscAddress).pushStr(value);
-        packetWriter_.init().addMessage(message);
-        outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        int addressId = client->pendingAddressIds[numSent];
+        const OSCFeedbackValue &value = feedbackValues_[addressId];
+        
+        if( ! (value == client->sentValues[addressId]))
+        {
+            const string &oscAddress = feedbackAddresses_[addressId];
+            int messageSize = 0;
+            
+            if(value.isString)
+            {
+                message_.init(oscAddress).pushStr(value.text);
+                messageSize = GetBundledOSCMessageSize(oscAddress, oscpkt::ceil4((int)value.text.size() + 1));
+            }
+            else
+            {
+                message_.init(oscAddress).pushFloat(value.value);
+                messageSize = GetBundledOSCMessageSize(oscAddress, 4);
+            }
+            
+            // Over budget, the rest stays pending and goes out next tick with whatever has changed by then
+            if(client->bundleSize > 0 && client->bundleSize + messageSize > maxPacketSize_ && client->numPacketsThisTick + 1 >= OSCClientMaxPacketsPerTick)
+                break;
+            
+            AddToBundle(client, message_, messageSize);
+            client->sentValues[addressId] = value;
+        }
+        
+        client->isPending[addressId] = false;
     }
     
-    SurfaceOutMonitor(feedbackProcessor->GetWidget(), oscAddress, value);
+    client->pendingAddressIds.erase(client->pendingAddressIds.begin(), client->pendingAddressIds.begin() + numSent);
     
+    FlushBundle(client);
 }
 
-/////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////
-// For EuCon
-/////////////////////////////////////////////////////////////////////////////
-class MarshalledFunctionCall
-/////////////////////////////////////////////////////////////////////////////
+void OSC_ControlSurface::SendToClients()
 {
-protected:
-    EuCon_ControlSurface* surface_ = nullptr;
-    MarshalledFunctionCall(EuCon_ControlSurface * surface) : surface_(surface) {}
-    
-public:
-    virtual void Execute() {}
-    virtual ~MarshalledFunctionCall() {}
-};
+    for(auto client : clients_)
+        SendToClient(client);
+}
 
-/////////////////////////////////////////////////////////////////////////////
-class Marshalled_Double : public MarshalledFunctionCall
-/////////////////////////////////////////////////////////////////////////////
+void OSC_ControlSurface::LoadingZone(string zoneName)
 {
-private:
-    string address_ = "";
-    double value_ = 0;
-public:
-    Marshalled_Double(EuCon_ControlSurface* surface, string address, double value) : MarshalledFunctionCall(surface), address_(address), value_(value)  { }
-    virtual ~Marshalled_Double() {}
+    string oscAddress(zoneName);
+    oscAddress = regex_replace(oscAddress, regex(BadFileChars), "_");
+    oscAddress = "/" + oscAddress;
+
+    // The client is likely to switch layouts on the zone address, so it gets the zone and then the complete state
+    currentZoneAddress_ = oscAddress;
+    Resync();
     
-    virtual void Execute() override { surface_->HandleEuConMessage(address_, value_); }
-};
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceZoneLoad, traceId_, 0, zoneName.c_str(), nullptr);
+}
 
-/////////////////////////////////////////////////////////////////////////////
-class Marshalled_String : public MarshalledFunctionCall
-/////////////////////////////////////////////////////////////////////////////
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, double value)
 {
-private:
-    string address_ = "";
-    string  value_ = "";
+    OSCFeedbackValue feedbackValue;
+    feedbackValue.hasValue = true;
+    feedbackValue.value = value;
+    SetFeedbackValue(oscAddress, feedbackValue);
     
-public:
-    Marshalled_String(EuCon_ControlSurface* surface, string address, string value) : MarshalledFunctionCall(surface), address_(address), value_(value)  { }
-    virtual ~Marshalled_String() {}
+    if(CSIProfiler::IsEnabled())
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
     
-    virtual void Execute() override { surface_->HandleEuConMessage(address_, value_); }
-};
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceOSCOutput, traceId_, feedbackProcessor->GetWidget()->GetTraceId(), oscAddress.c_str(), value);
+}
 
-/////////////////////////////////////////////////////////////////////////////
-class Marshalled_VisibilityChange : public MarshalledFunctionCall
-/////////////////////////////////////////////////////////////////////////////
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, string value)
 {
-private:
-    string groupName_ = "";
-    int  channelNumber_ = 0;
-    bool isVisible_ = false;
+    OSCFeedbackValue feedbackValue;
+    feedbackValue.hasValue = true;
+    feedbackValue.isString = true;
+    feedbackValue.text = value;
+    SetFeedbackValue(oscAddress, feedbackValue);
     
-public:
-    Marshalled_VisibilityChange(EuCon_ControlSurface* surface, string groupName, int channelNumber, bool isVisible) : MarshalledFunctionCall(surface), groupName_(groupName), channelNumber_(channelNumber), isVisible_(isVisible)  { }
-    virtual ~Marshalled_VisibilityChange() {}
+    if(CSIProfiler::IsEnabled())
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
     
-    virtual void Execute() override { surface_->HandleEuConGroupVisibilityChange(groupName_, channelNumber_, isVisible_); }
-};
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceOSCOutput, traceId_, feedbackProcessor->GetWidget()->GetTraceId(), oscAddress.c_str(), value.c_str());
+}
 
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+// For EuCon
 void EuConRequestsInitialization()
 {
     if(TheManager)
@@ -2325,13 +5019,13 @@ void InitializeEuConWidgets(vector<CSIWidgetInfo> *assemblyInfoItems)
 void HandleEuConMessageWithDouble(const char *address, double value)
 {
     if(TheManager)
-        TheManager->ReceiveEuConMessage(string(address), value);
+        TheManager->ReceiveEuConMessage(address, value);
 }
 
 void HandleEuConMessageWithString(const char *address, const char *value)
 {
     if(TheManager)
-        TheManager->ReceiveEuConMessage(string(address), string(value));
+        TheManager->ReceiveEuConMessage(address, value);
 }
 
 void HandleEuConGroupVisibilityChange(const char *groupName, int channelNumber, bool isVisible)
@@ -2360,25 +5054,31 @@ EuCon_ControlSurface::EuCon_ControlSurface(CSurfIntegrator* CSurfIntegrator, Pag
 {
     fxActivationManager_->SetShouldShowFXWindows(true);
     
-    if( ! plugin_register("API_EuConRequestsInitialization", (void *)::EuConRequestsInitialization))
+    meters_ = new EuConMeterSnapshot[numChannels_];
+    peakInfo_.resize(numChannels_);
+    
+    InternAddress("PostMessage");      // EuConPostMessageAddressId
+    InternAddress("LayoutChanged");    // EuConLayoutChangedAddressId
+    
+    if( ! DAW::plugin_register("API_EuConRequestsInitialization", (void *)::EuConRequestsInitialization))
         LOG::InitializationFailure("EuConRequestsInitialization failed to register");
 
-    if( ! plugin_register("API_InitializeEuConWidgets", (void *)::InitializeEuConWidgets))
+    if( ! DAW::plugin_register("API_InitializeEuConWidgets", (void *)::InitializeEuConWidgets))
         LOG::InitializationFailure("InitializeEuConWidgets failed to register");
    
-    if( ! plugin_register("API_HandleEuConMessageWithDouble", (void *)::HandleEuConMessageWithDouble))
+    if( ! DAW::plugin_register("API_HandleEuConMessageWithDouble", (void *)::HandleEuConMessageWithDouble))
         LOG::InitializationFailure("HandleEuConMessageWithDouble failed to register");
     
-    if( ! plugin_register("API_HandleEuConMessageWithString", (void *)::HandleEuConMessageWithString))
+    if( ! DAW::plugin_register("API_HandleEuConMessageWithString", (void *)::HandleEuConMessageWithString))
         LOG::InitializationFailure("HandleEuConMessageWithString failed to register");
     
-    if( ! plugin_register("API_HandleEuConGroupVisibilityChange", (void *)::HandleEuConGroupVisibilityChange))
+    if( ! DAW::plugin_register("API_HandleEuConGroupVisibilityChange", (void *)::HandleEuConGroupVisibilityChange))
         LOG::InitializationFailure("HandleEuConGroupVisibilityChange failed to register");
     
-    if( ! plugin_register("API_HandleEuConGetMeterValues", (void *)::HandleEuConGetMeterValues))
+    if( ! DAW::plugin_register("API_HandleEuConGetMeterValues", (void *)::HandleEuConGetMeterValues))
         LOG::InitializationFailure("HandleEuConGetMeterValues failed to register");
     
-    if( ! plugin_register("API_GetFormattedFXParamValue", (void *)::GetFormattedFXParamValue))
+    if( ! DAW::plugin_register("API_GetFormattedFXParamValue", (void *)::GetFormattedFXParamValue))
         LOG::InitializationFailure("GetFormattedFXParamValue failed to register");
     
     InitializeEuCon();
@@ -2395,6 +5095,53 @@ void EuCon_ControlSurface::InitializeEuCon()
         InitializeEuConWithParameters(numChannels_, numSends_, fxActivationManager_->GetNumFXSlots(), options_);
 }
 
+int EuCon_ControlSurface::InternAddress(const string &address)
+{
+    auto it = addressIds_.find(address);
+    
+    if(it != addressIds_.end())
+        return it->second;
+    
+    int addressId = (int)addresses_.size();
+    
+    addressIds_[address] = addressId;
+    addresses_.push_back(address);
+    CSIMessageGeneratorsByAddressId_.push_back(nullptr);
+    widgetsByAddressId_.push_back(nullptr);
+    
+    int flags = 0;
+    
+    if(address.find("Pan_Display") != string::npos
+       || address.find("Width_Display") != string::npos
+       || address.find("PanL_Display") != string::npos
+       || address.find("PanR_Display") != string::npos)
+        flags |= EuConAddressIsPanLabel;
+    
+    addressFlags_.push_back(flags);
+    
+    return addressId;
+}
+
+// Faders, pans and knobs send positions, everything else is a button whose every press and release counts.
+// A value can't tell them apart, a fader parked at the top sends 1.0 just like a button press, so the widget decides:
+// a FaderDB feedback processor, or a name that is exactly one of EuConContinuousWidgetTypes with nothing after it but
+// a channel number. Fader1 and PanL3 are positions, FaderTouch1, PanFlip1 and PanMode are buttons.
+static const char* const EuConContinuousWidgetTypes[] = { "Fader", "Pan", "PanL", "PanR", "Width", "Rotary", "Knob" };
+
+static bool IsContinuousEuConWidget(const CSIWidgetInfo &widgetInfo)
+{
+    if(widgetInfo.FB_Processor.find("FaderDB") != string::npos)
+        return true;
+    
+    size_t digits = widgetInfo.name.find_last_not_of("0123456789") + 1;
+    
+    for(auto type : EuConContinuousWidgetTypes)
+        if(widgetInfo.name.compare(0, digits, type) == 0)
+            return true;
+    
+    return false;
+}
+
 Widget*  EuCon_ControlSurface::InitializeEuConWidget(CSIWidgetInfo &widgetInfo)
 {
     if(widgetInfo.name != "")
@@ -2404,8 +5151,15 @@ Widget*  EuCon_ControlSurface::InitializeEuConWidget(CSIWidgetInfo &widgetInfo)
         if(!widget)
             return nullptr;
         
+        widgetsByAddressId_[InternAddress(widgetInfo.name)] = widget;
+        
         if(widgetInfo.control != "")
+        {
             new EuCon_CSIMessageGenerator(this, widget, widgetInfo.control);
+            
+            if(IsContinuousEuConWidget(widgetInfo))
+                addressFlags_[InternAddress(widgetInfo.control)] |= EuConAddressIsContinuous;
+        }
        
         if(widgetInfo.FB_Processor != "")
         {
@@ -2445,6 +5199,9 @@ void EuCon_ControlSurface::InitializeEuConWidgets(vector<CSIWidgetInfo> *widgetI
         }
     }
     
+    PublishAddressTable();
+    RebuildVisibleWidgets();
+    
     InitHardwiredWidgets();
     InitZones(zoneFolder_);
     MakeHomeDefault();
@@ -2452,55 +5209,82 @@ void EuCon_ControlSurface::InitializeEuConWidgets(vector<CSIWidgetInfo> *widgetI
     GetPage()->ForceRefreshTimeDisplay();
 }
 
-void EuCon_ControlSurface::SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, string address, double value)
+void EuCon_ControlSurface::PublishAddressTable()
+{
+    EuConAddressTable* table = new EuConAddressTable();
+    table->addresses = addresses_;
+    table->widgets = widgetsByAddressId_;
+    
+    for(int i = 0; i < table->addresses.size(); i++)
+        table->ids[table->addresses[i]] = i;
+    
+    addressTables_.push_back(table);
+    addressTable_.store(table, memory_order_release);
+    
+    pendingIndexByAddressId_.resize(addresses_.size(), -1);
+}
+
+void EuCon_ControlSurface::SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, int addressId, double value)
 {
     static void (*HandleReaperMessageWthDouble)(const char *, double) = nullptr;
     
     if(g_reaper_plugin_info && HandleReaperMessageWthDouble == nullptr)
         HandleReaperMessageWthDouble = (void (*)(const char *, double))g_reaper_plugin_info->GetFunc("HandleReaperMessageWthDouble");
     
+    const char* address = addresses_[addressId].c_str();
+    
     if(HandleReaperMessageWthDouble)
-        HandleReaperMessageWthDouble(address.c_str(), value);
+        HandleReaperMessageWthDouble(address, value);
+    
+    if(CSIProfiler::IsEnabled())
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
     
-    SurfaceOutMonitor(feedbackProcessor->GetWidget(), address, to_string(value));
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceEuConOutput, traceId_, feedbackProcessor->GetWidget()->GetTraceId(), address, value);
 }
 
-void EuCon_ControlSurface::SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, string address, double value, int param)
+void EuCon_ControlSurface::SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, int addressId, double value, int param)
 {
     static void (*HandleReaperMessageWthParam)(const char *, double, int) = nullptr;
     
     if(g_reaper_plugin_info && HandleReaperMessageWthParam == nullptr)
         HandleReaperMessageWthParam = (void (*)(const char *, double, int))g_reaper_plugin_info->GetFunc("HandleReaperMessageWthParam");
     
+    const char* address = addresses_[addressId].c_str();
+    
     if(HandleReaperMessageWthParam)
-        HandleReaperMessageWthParam(address.c_str(), value, param);
+        HandleReaperMessageWthParam(address, value, param);
+    
+    if(CSIProfiler::IsEnabled())
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
     
-    SurfaceOutMonitor(feedbackProcessor->GetWidget(), address, to_string(value));
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceEuConOutput, traceId_, feedbackProcessor->GetWidget()->GetTraceId(), address, value);
 }
 
-void EuCon_ControlSurface::SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, string address, string value)
+void EuCon_ControlSurface::SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, int addressId, const string &value)
 {
-    if(address.find("Pan_Display") != string::npos
-       || address.find("Width_Display") != string::npos
-       || address.find("PanL_Display") != string::npos
-       || address.find("PanR_Display") != string::npos)
-    {
+    if(addressFlags_[addressId] & EuConAddressIsPanLabel)
         return; // GAW -- Hack to prevent overwrite of Pan, Width, etc. labels
-    }
     
     static void (*HandleReaperMessageWthString)(const char *, const char *) = nullptr;
     
     if(g_reaper_plugin_info && HandleReaperMessageWthString == nullptr)
         HandleReaperMessageWthString = (void (*)(const char *, const char *))g_reaper_plugin_info->GetFunc("HandleReaperMessageWithString");
     
+    const char* address = addresses_[addressId].c_str();
+    
     if(HandleReaperMessageWthString)
-        HandleReaperMessageWthString(address.c_str(), value.c_str());
+        HandleReaperMessageWthString(address, value.c_str());
+    
+    if(CSIProfiler::IsEnabled())
+        feedbackProcessor->GetWidget()->LogFeedbackLatency();
     
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg(("OUT-> " + name_ + " " + address + " " + value + "\n").c_str());
+    if(CSITrace::IsEnabled(TraceOutput))
+        CSITrace::Record(TraceEuConOutput, traceId_, feedbackProcessor->GetWidget()->GetTraceId(), address, value.c_str());
 }
 
-void EuCon_ControlSurface::SendEuConMessage(string address, string value)
+void EuCon_ControlSurface::SendEuConMessage(const char* address, const char* value)
 {
     static void (*HandleReaperMessageWthString)(const char *, const char *) = nullptr;
     
@@ -2508,79 +5292,125 @@ void EuCon_ControlSurface::SendEuConMessage(string address, string value)
         HandleReaperMessageWthString = (void (*)(const char *, const char *))g_reaper_plugin_info->GetFunc("HandleReaperMessageWithString");
     
     if(HandleReaperMessageWthString)
-        HandleReaperMessageWthString(address.c_str(), value.c_str());
+        HandleReaperMessageWthString(address, value);
 }
 
-void EuCon_ControlSurface::ReceiveEuConGetMeterValues(int id, int iLeg, float& oLevel, float& oPeak, bool& oLegClip)
+void EuCon_ControlSurface::UpdateMeters()
 {
-    if(MediaTrack* track = GetPage()->GetTrackNavigationManager()->GetTrackFromChannel(id))
+    double now = DAW::GetCurrentNumberOfMilliseconds();
+    
+    for(int channel = 0; channel < numChannels_; channel++)
     {
-        float left = VAL2DB(DAW::Track_GetPeakInfo(track, 0));
-        float right = VAL2DB(DAW::Track_GetPeakInfo(track, 1));
-        
-        oLevel = (left + right) / 2.0;
-       
-        float max = left > right ? left : right;
-        
-        if(peakInfo_.count(id) > 0 && peakInfo_[id].peakValue < max)
-        {
-            peakInfo_[id].timePeakSet  = DAW::GetCurrentNumberOfMilliseconds();
-            peakInfo_[id].peakValue = max;
-            if(max > 0.0)
-                peakInfo_[id].isClipping = true;
-        }
-        
-        if(peakInfo_.count(id) < 1)
-        {
-            peakInfo_[id].timePeakSet  = DAW::GetCurrentNumberOfMilliseconds();
-            peakInfo_[id].peakValue = max;
-            if(max > 0.0)
-                peakInfo_[id].isClipping = true;
-        }
+        EuConMeterValues values;
         
-        if(peakInfo_.count(id) > 0 && (DAW::GetCurrentNumberOfMilliseconds() - peakInfo_[id].timePeakSet > 2000))
+        if(MediaTrack* track = GetPage()->GetTrackNavigationManager()->GetTrackFromChannel(channel))
         {
-            peakInfo_[id].timePeakSet  = DAW::GetCurrentNumberOfMilliseconds();
-            peakInfo_[id].peakValue = max;
-            peakInfo_[id].isClipping = false;
+            float left = VAL2DBFast(DAW::Track_GetPeakInfo(track, 0));
+            float right = VAL2DBFast(DAW::Track_GetPeakInfo(track, 1));
+            float max = left > right ? left : right;
+            
+            PeakInfo &peakInfo = peakInfo_[channel];
+            
+            if(peakInfo.peakValue < max)
+            {
+                peakInfo.timePeakSet = now;
+                peakInfo.peakValue = max;
+                if(max > 0.0)
+                    peakInfo.isClipping = true;
+            }
+            
+            if(now - peakInfo.timePeakSet > 2000)
+            {
+                peakInfo.timePeakSet = now;
+                peakInfo.peakValue = max;
+                peakInfo.isClipping = false;
+            }
+            
+            values.level = (left + right) / 2.0;
+            values.peak = peakInfo.peakValue;
+            values.isClipping = peakInfo.isClipping;
         }
         
-        oPeak = peakInfo_[id].peakValue;
-        oLegClip = peakInfo_[id].isClipping;
-    }
-    else
-    {
-        oLevel = -144.0;
-        oPeak = -144.0;
-        oLegClip = false;
+        meters_[channel].Write(values);
     }
 }
 
+void EuCon_ControlSurface::ReceiveEuConGetMeterValues(int id, int iLeg, float& oLevel, float& oPeak, bool& oLegClip)
+{
+    // Called on an EuCon thread, so it only reads what UpdateMeters published this tick
+    EuConMeterValues values;
+    
+    if(id >= 0 && id < numChannels_)
+        values = meters_[id].Read();
+    
+    oLevel = values.level;
+    oPeak = values.peak;
+    oLegClip = values.isClipping;
+}
+
 void EuCon_ControlSurface::GetFormattedFXParamValue(const char* address, char *buffer, int bufferSize)
 {
-    if(widgetsByName_.count(address) > 0)
-        widgetsByName_[address]->GetFormattedFXParamValue(buffer, bufferSize);
+    // Called on an EuCon thread, so it reads the published table rather than widgetsByName_
+    if(const EuConAddressTable* table = addressTable_.load(memory_order_acquire))
+    {
+        int addressId = table->Find(address);
+        
+        if(addressId >= 0 && table->widgets[addressId] != nullptr)
+            table->widgets[addressId]->GetFormattedFXParamValue(buffer, bufferSize);
+    }
 }
 
-void EuCon_ControlSurface::ReceiveEuConMessage(string address, double value)
+void EuCon_ControlSurface::ReceiveEuConMessage(const char* address, double value)
 {
-    mutex_.Enter();
-    workQueue_.push_front(new Marshalled_Double(this, address, value));
-    mutex_.Leave();
+    EuConInputRecord record;
+    record.timestamp = CSIProfiler::IsEnabled() || CSIRecorder::IsRecording() ? CSIProfiler::GetTimestamp() : 0.0;
+    record.kind = EuConInputDouble;
+    record.value = value;
+    
+    if(const EuConAddressTable* table = addressTable_.load(memory_order_acquire))
+        record.addressId = table->Find(address);
+    
+    PushInput(record, record.addressId < 0 ? address : "", "");
 }
 
-void EuCon_ControlSurface::ReceiveEuConMessage(string address, string value)
+void EuCon_ControlSurface::ReceiveEuConMessage(const char* address, const char* value)
 {
-    mutex_.Enter();
-    workQueue_.push_front(new Marshalled_String(this, address, value));
-    mutex_.Leave();
+    EuConInputRecord record;
+    record.timestamp = CSIProfiler::IsEnabled() || CSIRecorder::IsRecording() ? CSIProfiler::GetTimestamp() : 0.0;
+    record.kind = EuConInputString;
+    
+    PushInput(record, address, value);
 }
 
 void EuCon_ControlSurface::ReceiveEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible)
 {
-    mutex_.Enter();
-    workQueue_.push_front(new Marshalled_VisibilityChange(this, groupName, channelNumber, isVisible));
-    mutex_.Leave();
+    EuConInputRecord record;
+    record.timestamp = CSIProfiler::IsEnabled() || CSIRecorder::IsRecording() ? CSIProfiler::GetTimestamp() : 0.0;
+    record.kind = EuConInputVisibility;
+    record.channelNumber = channelNumber;
+    record.isVisible = isVisible;
+    
+    PushInput(record, groupName.c_str(), "");
+}
+
+// EuCon threads, strings that don't fit the record are parked under a lock rather than cut short
+void EuCon_ControlSurface::PushInput(EuConInputRecord &record, const char* address, const char* text)
+{
+    if(strlen(address) < sizeof(record.address) && strlen(text) < sizeof(record.text))
+    {
+        snprintf(record.address, sizeof(record.address), "%s", address);
+        snprintf(record.text, sizeof(record.text), "%s", text);
+        inputQueue_.Push(record);
+        return;
+    }
+    
+    WDL_MutexLock lock(&inputOverflowMutex_);
+    
+    record.overflowId = nextInputOverflowId_++;
+    inputOverflow_[record.overflowId] = make_pair(string(address), string(text));
+    
+    if( ! inputQueue_.Push(record))
+        inputOverflow_.erase(record.overflowId);
 }
 
 void EuCon_ControlSurface::HandleEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible)
@@ -2615,123 +5445,226 @@ void EuCon_ControlSurface::HandleEuConGroupVisibilityChange(string groupName, in
     
     else if(groupName == "Channel" && channelGroups_.count(channelNumber) > 0)
         channelGroups_[channelNumber]->SetIsVisible(isVisible);
+    
+    RebuildVisibleWidgets();
+}
+
+void EuCon_ControlSurface::RebuildVisibleWidgets()
+{
+    visibleWidgets_.clear();
+    visibleWidgets_.insert(visibleWidgets_.end(), generalWidgets_.begin(), generalWidgets_.end());
+    
+    for(auto [channel, group] : channelGroups_)
+        group->CollectVisibleWidgets(visibleWidgets_);
 }
 
 void EuCon_ControlSurface::HandleExternalInput()
 {
-    if(! workQueue_.empty())
+    int depth = inputQueue_.GetDepth();
+    
+    if(depth == 0)
+        return;
+    
+    if(depth > maxInputDepth_)
+        maxInputDepth_ = depth;
+    
+    // A fader swept between two ticks only needs its last position, the newest value for an address
+    // overwrites the pending one in place so each address keeps its first arrival order and timestamp.
+    // Presses, releases, strings and visibility changes are never merged and nothing is merged across them.
+    int numMessages = 0;
+    size_t barrier = 0;
+    EuConInputRecord record;
+    
+    while(inputQueue_.Pop(record))
     {
-        mutex_.Enter();
-        list<MarshalledFunctionCall*> localWorkQueue = workQueue_;
-        workQueue_.clear();
-        mutex_.Leave();
+        numMessages++;
+        
+        bool isKnownAddress = record.kind == EuConInputDouble && record.addressId >= 0 && record.addressId < pendingIndexByAddressId_.size();
         
-        while(! localWorkQueue.empty())
+        if(isKnownAddress && (addressFlags_[record.addressId] & EuConAddressIsContinuous))
         {
-            MarshalledFunctionCall *pCall = localWorkQueue.back();
-            localWorkQueue.pop_back();
-            pCall->Execute();
-            delete pCall;
+            int index = pendingIndexByAddressId_[record.addressId];
+            
+            if(index >= (int)barrier)
+            {
+                pendingInput_[index].value = record.value;
+                numInputCoalesced_++;
+                continue;
+            }
+            
+            pendingIndexByAddressId_[record.addressId] = (int)pendingInput_.size();
+        }
+        else
+        {
+            if(isKnownAddress)
+                pendingIndexByAddressId_[record.addressId] = -1;
+            
+            barrier = pendingInput_.size() + 1;
         }
-    }
-}
-
-void EuCon_ControlSurface::HandleEuConMessage(string address, double value)
-{
-    if(address == "PostMessage" && g_hwnd != nullptr)
-        PostMessage(g_hwnd, WM_COMMAND, (int)value, 0);
-    else if(address == "LayoutChanged")
-        DAW::MarkProjectDirty(nullptr);
-    else if(CSIMessageGeneratorsByMessage_.count(address) > 0)
-        CSIMessageGeneratorsByMessage_[address]->ProcessMessage(address, value);
         
-    if(TheManager->GetSurfaceInDisplay())
+        pendingInput_.push_back(record);
+    }
+    
+    for(auto &pendingRecord : pendingInput_)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %s  %f  \n", name_.c_str(), address.c_str(), value);
-        DAW::ShowConsoleMsg(buffer);
+        if(pendingRecord.addressId >= 0 && pendingRecord.addressId < pendingIndexByAddressId_.size())
+            pendingIndexByAddressId_[pendingRecord.addressId] = -1;
+        
+        HandleEuConInput(pendingRecord);
     }
+    
+    if(CSIProfiler::IsEnabled())
+        CSIProfiler::RecordEuConInput(traceId_, numMessages, (int)pendingInput_.size(), depth, inputQueue_.GetNumDropped());
+    
+    pendingInput_.clear();
 }
 
-void EuCon_ControlSurface::HandleEuConMessage(string address, string value)
-{
-    // GAW TBD
-}
-
-void EuCon_ControlSurface::UpdateTimeDisplay()
+void EuCon_ControlSurface::HandleEuConInput(const EuConInputRecord &record)
 {
-    double playPosition = (GetPlayState() & 1 ) ? GetPlayPosition() : GetCursorPosition();
+    const char* address = record.addressId >= 0 ? addresses_[record.addressId].c_str() : record.address;
+    const char* text = record.text;
+    pair<string, string> overflow;
     
-    if(previousPP != playPosition) // GAW :) Yeah I know shouldn't compare FP values, but the worst you get is an extra upadate or two, meh.
+    if(record.overflowId >= 0)
     {
-        previousPP = playPosition;
-
-        int *timeModePtr = TheManager->GetTimeMode2Ptr(); // transport
+        WDL_MutexLock lock(&inputOverflowMutex_);
+        
+        if(inputOverflow_.count(record.overflowId) > 0)
+        {
+            overflow = inputOverflow_[record.overflowId];
+            inputOverflow_.erase(record.overflowId);
+        }
         
-        int timeMode = 0;
+        if(record.addressId < 0)
+            address = overflow.first.c_str();
         
-        if (timeModePtr && (*timeModePtr) >= 0)
-            timeMode = *timeModePtr;
-        else
+        text = overflow.second.c_str();
+    }
+    
+    if(record.kind == EuConInputDouble)
+    {
+        if(CSIRecorder::IsRecording())
+            CSIRecorder::Record(traceId_, RecordEuConDouble, record.timestamp, &record.value, sizeof(record.value), address);
+        
+        CSIProfiler::BeginInput(record.timestamp);
+        HandleEuConMessage(record.addressId, address, record.value);
+        CSIProfiler::EndInput();
+    }
+    else if(record.kind == EuConInputString)
+    {
+        if(CSIRecorder::IsRecording())
+            CSIRecorder::Record(traceId_, RecordEuConString, record.timestamp, nullptr, 0, string(address) + '\0' + text);
+        
+        CSIProfiler::BeginInput(record.timestamp);
+        HandleEuConMessage(address, text);
+        CSIProfiler::EndInput();
+    }
+    else if(record.kind == EuConInputVisibility)
+    {
+        if(CSIRecorder::IsRecording())
         {
-            timeModePtr = TheManager->GetTimeModePtr(); // ruler
+            unsigned char prefix[sizeof(int) + 1];
+            memcpy(prefix, &record.channelNumber, sizeof(int));
+            prefix[sizeof(int)] = record.isVisible;
             
-            if (timeModePtr)
-                timeMode = *timeModePtr;
+            CSIRecorder::Record(traceId_, RecordEuConVisibility, record.timestamp, prefix, sizeof(prefix), address);
         }
         
-        char samplesBuf[64];
-        memset(samplesBuf, 0, sizeof(samplesBuf));
-        char measuresBuf[64];
-        memset(measuresBuf, 0, sizeof(measuresBuf));
-        char chronoBuf[64];
-        memset(chronoBuf, 0, sizeof(chronoBuf));
+        CSIProfiler::BeginInput(record.timestamp);
+        HandleEuConGroupVisibilityChange(address, record.channelNumber, record.isVisible);
+        CSIProfiler::EndInput();
+    }
+}
 
-        if(timeMode == 4)  // Samples
-        {
-            format_timestr_pos(playPosition, samplesBuf, sizeof(samplesBuf), timeMode);
-        }
+void EuCon_ControlSurface::ReplayInput(RecordKind kind, const vector<unsigned char> &payload)
+{
+    if(kind == RecordEuConDouble && payload.size() >= sizeof(double))
+    {
+        double value = 0.0;
+        memcpy(&value, payload.data(), sizeof(double));
+        HandleEuConMessage(string(payload.begin() + sizeof(double), payload.end()), value);
+    }
+    else if(kind == RecordEuConString)
+    {
+        auto separator = find(payload.begin(), payload.end(), 0);
         
-        if(timeMode == 1 || timeMode == 2)  // Bars/Beats/Ticks
-        {
-            int num_measures = 0;
-            double beats = TimeMap2_timeToBeats(NULL, playPosition, &num_measures, NULL, NULL, NULL) + 0.000000000001;
-            double nbeats = floor(beats);
-            beats -= nbeats;
-            format_timestr_pos(playPosition, measuresBuf, sizeof(measuresBuf), 2);
-        }
+        if(separator != payload.end())
+            HandleEuConMessage(string(payload.begin(), separator).c_str(), string(separator + 1, payload.end()).c_str());
+    }
+    else if(kind == RecordEuConVisibility && payload.size() > sizeof(int))
+    {
+        int channelNumber = 0;
+        memcpy(&channelNumber, payload.data(), sizeof(int));
+        HandleEuConGroupVisibilityChange(string(payload.begin() + sizeof(int) + 1, payload.end()), channelNumber, payload[sizeof(int)] != 0);
+    }
+}
+
+void EuCon_ControlSurface::HandleEuConMessage(int addressId, const char* address, double value)
+{
+    if(addressId < 0) // arrived before the address table was published, or replayed
+    {
+        auto it = addressIds_.find(address);
         
-        if(timeMode == 0 || timeMode == 1 || timeMode == 3  ||  timeMode == 5)  // Hours/Minutes/Seconds/Frames
-        {
-            double *timeOffsetPtr = TheManager->GetTimeOffsPtr();
-            if (timeOffsetPtr)
-                playPosition += (*timeOffsetPtr);
-            format_timestr_pos(playPosition, chronoBuf, sizeof(chronoBuf), timeMode == 1 ? 0 : timeMode);
-        }
+        if(it != addressIds_.end())
+            addressId = it->second;
+    }
+    
+    if(addressId == EuConPostMessageAddressId)
+        DAW::PostCommandMessage((int)value);
+    else if(addressId == EuConLayoutChangedAddressId)
+        DAW::MarkProjectDirty(nullptr);
+    else if(addressId >= 0 && CSIMessageGeneratorsByAddressId_[addressId] != nullptr)
+        CSIMessageGeneratorsByAddressId_[addressId]->ProcessMessage(address, value);
         
-        switch(timeMode)
-        {
-            case 0: // Hours/Minutes/Seconds
-            case 3: // Seconds
-            case 5: // Hours/Minutes/Seconds/Frames
-                SendEuConMessage("PrimaryTimeDisplay", chronoBuf);
-                SendEuConMessage("SecondaryTimeDisplay", "");
-                break;
-                
-            case 1:
-                SendEuConMessage("PrimaryTimeDisplay", measuresBuf);
-                SendEuConMessage("SecondaryTimeDisplay", chronoBuf);
-                break;
-                
-            case 2:
-                SendEuConMessage("PrimaryTimeDisplay", measuresBuf);
-                SendEuConMessage("SecondaryTimeDisplay", "");
-                break;
-                
-            case 4:
-                SendEuConMessage("PrimaryTimeDisplay", samplesBuf);
-                SendEuConMessage("SecondaryTimeDisplay", "");
-                break;
-        }
+    if(CSITrace::IsEnabled(TraceInput))
+        CSITrace::Record(TraceEuConInput, traceId_, 0, address, value);
+}
+
+void EuCon_ControlSurface::HandleEuConMessage(const char* address, const char* value)
+{
+    // GAW TBD
+}
+
+void EuCon_ControlSurface::UpdateTimeDisplay()
+{
+    TimeDisplayFormatter* timeDisplay = TheManager->GetTimeDisplayFormatter();
+    
+    const char* primary = "";
+    const char* secondary = "";
+    
+    switch(timeDisplay->GetTimeMode())
+    {
+        case 0: // Hours/Minutes/Seconds
+        case 3: // Seconds
+        case 5: // Hours/Minutes/Seconds/Frames
+            primary = timeDisplay->GetText(timeDisplay->GetTimeMode());
+            break;
+            
+        case 1:
+            primary = timeDisplay->GetText(2);
+            secondary = timeDisplay->GetText(0);
+            break;
+            
+        case 2:
+            primary = timeDisplay->GetText(2);
+            break;
+            
+        case 4:
+            primary = timeDisplay->GetText(4);
+            break;
+    }
+    
+    if( ! isTimeDisplayCurrent_ || strcmp(primary, primaryTimeDisplay_) != 0)
+    {
+        snprintf(primaryTimeDisplay_, sizeof(primaryTimeDisplay_), "%s", primary);
+        SendEuConMessage("PrimaryTimeDisplay", primaryTimeDisplay_);
     }
+    
+    if( ! isTimeDisplayCurrent_ || strcmp(secondary, secondaryTimeDisplay_) != 0)
+    {
+        snprintf(secondaryTimeDisplay_, sizeof(secondaryTimeDisplay_), "%s", secondary);
+        SendEuConMessage("SecondaryTimeDisplay", secondaryTimeDisplay_);
+    }
+    
+    isTimeDisplayCurrent_ = true;
 }
@@ -19,10 +19,16 @@
 #include <sstream>
 #include <vector>
 #include <map>
+#include <list>
+#include <unordered_map>
+#include <string_view>
 #include <iomanip>
 #include <fstream>
 #include <regex>
 #include <cmath>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 #ifdef _WIN32
 #include "oscpkt.hh"
@@ -68,6 +74,18 @@ const int TempDisplayTime = 1250;
 class Manager;
 extern Manager* TheManager;
 
+// OSC and EuCon feedback is sent at full precision, changes smaller than this aren't visible on the client
+const double ShadowValueEpsilon = 0.0001;
+
+enum ShadowChannel
+{
+    ShadowChannelValue,
+    ShadowChannelString,
+    ShadowChannelRGB,
+    ShadowChannelMidi,
+    NumShadowChannels
+};
+
 struct CSIWidgetInfo
 {
     string group = "General";
@@ -94,9 +112,13 @@ class OSC_ControlSurface;
 class EuCon_ControlSurface;
 class Widget;
 class TrackNavigationManager;
+class TrackStateSnapshot;
+class TrackAppearanceCache;
+class FXParamCache;
 class FeedbackProcessor;
 class Zone;
 class ActionContext;
+class ShadowValue;
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -108,6 +130,7 @@ public:
     
     virtual void RequestUpdate(ActionContext* context) {}
     virtual void Do(ActionContext* context, double value) {}
+    virtual void DoString(ActionContext* context, string value) {} // for surfaces that send text, e.g. an OSC string argument
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -303,6 +326,9 @@ public:
     Page* GetPage();
     ControlSurface* GetSurface();
     TrackNavigationManager* GetTrackNavigationManager();
+    TrackStateSnapshot* GetTrackStates();
+    TrackAppearanceCache* GetTrackAppearances();
+    FXParamCache* GetFXParams();
     int GetParamIndex() { return paramIndex_; }
     
     virtual string GetAlias() { return ""; }
@@ -314,6 +340,7 @@ public:
     void SetDelayAmount(double delayAmount) { delayAmount_ = delayAmount; }
     
     void DoAction(double value);
+    void DoAction(string value);
     void DoRelativeAction(double value);
     void DoRelativeAction(int accelerationIndex, double value);
     double GetCurrentValue() { return 0.0; }
@@ -329,14 +356,12 @@ public:
         if(fxParamDisplayName_ != "")
             return fxParamDisplayName_;
         else if(MediaTrack* track = GetTrack())
-        {
-            char fxParamName[BUFSZ];
-            DAW::TrackFX_GetParamName(track, GetSlotIndex(), paramIndex_, fxParamName, sizeof(fxParamName));
-            return fxParamName;
-        }
+            return GetFXParamName(track);
         
         return "";
     }
+    
+    const char* GetFXParamName(MediaTrack* track);
 
     void PerformDeferredActions()
     {
@@ -444,6 +469,12 @@ public:
             context.DoAction(value);
     }
     
+    void DoAction(string value)
+    {
+        for(auto context : actionContexts_)
+            context.DoAction(value);
+    }
+    
     void DoRelativeAction(double delta)
     {
         for(auto context : actionContexts_)
@@ -456,6 +487,7 @@ public:
             context.DoRelativeAction(accelerationIndex, delta);
     }
     
+    // Called on an EuCon thread, so it goes to the DAW rather than through the main thread's FXParamCache
     void GetFormattedFXParamValue(MediaTrack* track, int slotIndex, char *buffer, int bufferSize)
     {
         int paramIndex = actionContexts_.size() > 0 ? actionContexts_[0].GetParamIndex() : 0;
@@ -611,6 +643,23 @@ struct ZoneTemplate
             widgetActionTemplates.push_back(widgetActionTemplate);
     }
     
+    // Zones copy what they need on Activate, so a template can go while its Zones are still active
+    ~ZoneTemplate()
+    {
+        for(auto widgetActionTemplate : widgetActionTemplates)
+        {
+            for(auto actionBundleTemplate : widgetActionTemplate->actionBundleTemplates)
+            {
+                for(auto member : actionBundleTemplate->members)
+                    delete member;
+                
+                delete actionBundleTemplate;
+            }
+            
+            delete widgetActionTemplate;
+        }
+    }
+    
     void ProcessWidgetActionTemplates(ControlSurface* surface, Zone* zone, string channelNumStr, bool shouldUseNoAction);
     
     void  Activate(ControlSurface* surface, vector<Zone*> &activeZones);
@@ -624,8 +673,10 @@ class Widget
 private:
     ControlSurface* const surface_;
     string const name_;
+    int const traceId_;
     vector<FeedbackProcessor*> feedbackProcessors_;
     bool isModifier_ = false;
+    double pendingFeedbackInputTimestamp_ = 0.0;
     
     WidgetActionBroker currentWidgetActionBroker_;
     WidgetActionBroker defaultWidgetActionBroker_;
@@ -633,11 +684,13 @@ private:
     void LogInput(double value);
 
 public:
-    Widget(ControlSurface* surface, string name) : surface_(surface), name_(name), currentWidgetActionBroker_(WidgetActionBroker(this)), defaultWidgetActionBroker_(WidgetActionBroker(this)) {}
+    void LogFeedbackLatency();
+    Widget(ControlSurface* surface, string name) : surface_(surface), name_(name), traceId_(CSITrace::RegisterName(name)), currentWidgetActionBroker_(WidgetActionBroker(this)), defaultWidgetActionBroker_(WidgetActionBroker(this)) {}
     virtual ~Widget() {};
     
     ControlSurface* GetSurface() { return surface_; }
     string GetName() { return name_; }
+    int GetTraceId() { return traceId_; }
     bool GetIsModifier() { return isModifier_; }
     void SetIsModifier() { isModifier_ = true; }
     virtual void SilentSetValue(string displayText);
@@ -647,13 +700,13 @@ public:
     void Deactivate();
     void RequestUpdate();
     void DoAction(double value);
+    void DoAction(string value);
     void DoRelativeAction(double delta);
     void DoRelativeAction(int accelerationIndex, double delta);
     void UpdateValue(double value);
     void UpdateValue(int mode, double value);
     void UpdateValue(string value);
     void UpdateRGBValue(int r, int g, int b);
-    void ClearCache();
     void Clear();
     void ForceClear();
    
@@ -667,10 +720,7 @@ public:
         defaultWidgetActionBroker_ = currentWidgetActionBroker_;
     }
     
-    void AddFeedbackProcessor(FeedbackProcessor* feedbackProcessor)
-    {
-        feedbackProcessors_.push_back(feedbackProcessor);
-    }
+    void AddFeedbackProcessor(FeedbackProcessor* feedbackProcessor);
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -698,11 +748,21 @@ public:
 class OSC_CSIMessageGenerator : public CSIMessageGenerator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
+private:
+    int const argumentIndex_ = 0; // which argument of the message drives this widget, e.g. 0 for X and 1 for Y of an XY pad
+    
 public:
-    OSC_CSIMessageGenerator(OSC_ControlSurface* surface, Widget* widget, string message);
+    OSC_CSIMessageGenerator(OSC_ControlSurface* surface, Widget* widget, string message, int argumentIndex);
     virtual ~OSC_CSIMessageGenerator() {}
     
-    virtual void ProcessOSCMessage(string message, double value)
+    int GetArgumentIndex() { return argumentIndex_; }
+    
+    virtual void ProcessOSCMessage(const string &message, double value)
+    {
+        widget_->DoAction(value);
+    }
+    
+    virtual void ProcessOSCMessage(const string &message, string value)
     {
         widget_->DoAction(value);
     }
@@ -716,12 +776,78 @@ public:
     EuCon_CSIMessageGenerator(EuCon_ControlSurface* surface, Widget* widget, string message);
     virtual ~EuCon_CSIMessageGenerator() {}
     
-    virtual void ProcessMessage(string message, double value)
+    virtual void ProcessMessage(const char* message, double value)
     {
         widget_->DoAction(value);
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ShadowState
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    map<pair<Widget*, int>, ShadowValue*> values_;
+    int numOffered_ = 0;
+    int numSuppressed_ = 0;
+    int numSent_ = 0;
+    int numResyncs_ = 0;
+    
+public:
+    ~ShadowState();
+    
+    ShadowValue* GetValue(Widget* widget, int outputChannel, double epsilon);
+    void InvalidateAll();
+    
+    void CountOffered(bool isSuppressed) { numOffered_++; if(isSuppressed) numSuppressed_++; }
+    void CountSent() { numSent_++; }
+    void ResetStats() { numOffered_ = numSuppressed_ = numSent_ = numResyncs_ = 0; }
+    
+    int GetNumValues() { return values_.size(); }
+    int GetNumOffered() { return numOffered_; }
+    int GetNumSuppressed() { return numSuppressed_; }
+    int GetNumSent() { return numSent_; }
+    int GetNumResyncs() { return numResyncs_; }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ShadowValue
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    ShadowState* const state_;
+    double const epsilon_;
+    bool hasBeenSent_ = false;
+    int intValue_ = 0;
+    double doubleValue_ = 0.0;
+    string stringValue_ = "";
+    
+    bool Count(bool isCurrent) { state_->CountOffered(isCurrent); return isCurrent; }
+    
+public:
+    ShadowValue(ShadowState* state, double epsilon) : state_(state), epsilon_(epsilon) {}
+    
+    // never matches after Invalidate, so a real 0 or "" still goes out after a ClearCache
+    bool IsCurrent(int value) { return Count(hasBeenSent_ && intValue_ == value); }
+    bool IsCurrent(double value) { return IsCurrent(0, value); }
+    bool IsCurrent(string value) { return Count(hasBeenSent_ && stringValue_ == value); }
+    
+    bool IsCurrent(int param, double value)
+    {
+        if(epsilon_ > 0.0)
+            return Count(hasBeenSent_ && intValue_ == param && fabs(doubleValue_ - value) < epsilon_);
+        else
+            return Count(hasBeenSent_ && intValue_ == param && doubleValue_ == value);
+    }
+    
+    void Set(int value) { hasBeenSent_ = true; intValue_ = value; state_->CountSent(); }
+    void Set(double value) { Set(0, value); }
+    void Set(int param, double value) { hasBeenSent_ = true; intValue_ = param; doubleValue_ = value; state_->CountSent(); }
+    void Set(string value) { hasBeenSent_ = true; stringValue_ = value; state_->CountSent(); }
+    
+    void Invalidate() { hasBeenSent_ = false; }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -733,11 +859,16 @@ protected:
     double refreshInterval_ = 0.0;
     double lastRefreshed_ = 0.0;
     Widget* const widget_ = nullptr;
+    int outputIndex_ = 0;
+    ShadowValue* shadowValues_[NumShadowChannels] = {};
+    
+    ShadowValue* GetShadowValue(ShadowChannel channel, double epsilon = 0.0);
     
 public:
     FeedbackProcessor(Widget* widget) : widget_(widget) {}
     virtual ~FeedbackProcessor() {}
     Widget* GetWidget() { return widget_; }
+    void SetOutputIndex(int outputIndex) { outputIndex_ = outputIndex; }
     void SetRefreshInterval(double refreshInterval) { shouldRefresh_ = true; refreshInterval_ = refreshInterval * 1000.0; }
     virtual void UpdateValue(double value) {}
     virtual void UpdateValue(int param, double value) {}
@@ -746,7 +877,6 @@ public:
     virtual void ForceValue(double value) {}
     virtual void ForceValue(int param, double value) {}
     virtual void ForceRGBValue(int r, int g, int b) {}
-    virtual void ClearCache() {}
 
     virtual void ForceValue(string displayText)
     {
@@ -788,7 +918,6 @@ class Midi_FeedbackProcessor : public FeedbackProcessor
 protected:
     Midi_ControlSurface* const surface_ = nullptr;
     
-    MIDI_event_ex_t* lastMessageSent_ = new MIDI_event_ex_t(0, 0, 0);
     MIDI_event_ex_t* midiFeedbackMessage1_ = new MIDI_event_ex_t(0, 0, 0);
     MIDI_event_ex_t* midiFeedbackMessage2_ = new MIDI_event_ex_t(0, 0, 0);
     
@@ -799,14 +928,6 @@ protected:
     void SendMidiMessage(MIDI_event_ex_t* midiMessage);
     void SendMidiMessage(int first, int second, int third);
     void ForceMidiMessage(int first, int second, int third);
-
-public:
-    virtual void ClearCache() override
-    {
-        lastMessageSent_->midi_message[0] = 0;
-        lastMessageSent_->midi_message[1] = 0;
-        lastMessageSent_->midi_message[2] = 0;
-    }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -816,8 +937,6 @@ class OSC_FeedbackProcessor : public FeedbackProcessor
 protected:
     OSC_ControlSurface* const surface_ = nullptr;
     string oscAddress_ = "";
-    double lastDoubleValue_ = 0.0;
-    string lastStringValue_ = "";
     
 public:
     
@@ -831,12 +950,6 @@ public:
     virtual void ForceValue(int param, double value) override;
     virtual void ForceValue(string value) override;
     virtual void SilentSetValue(string value) override;
-
-    virtual void ClearCache() override
-    {
-        lastDoubleValue_ = 0.0;
-        lastStringValue_ = "";
-    }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -845,13 +958,11 @@ class EuCon_FeedbackProcessor : public FeedbackProcessor
 {
 protected:
     EuCon_ControlSurface* const surface_ = nullptr;
-    string address_ = "";
-    double lastDoubleValue_ = 0.0;
-    string lastStringValue_ = "";
+    int addressId_ = -1; // interned by the surface, which also knows the address's flags
     
 public:
     
-    EuCon_FeedbackProcessor(EuCon_ControlSurface* surface, Widget* widget, string address) : FeedbackProcessor(widget), surface_(surface), address_(address) {}
+    EuCon_FeedbackProcessor(EuCon_ControlSurface* surface, Widget* widget, string address);
     ~EuCon_FeedbackProcessor() {}
     
     virtual void UpdateValue(double value) override;
@@ -861,11 +972,6 @@ public:
     virtual void ForceValue(int param, double value) override;
     virtual void ForceValue(string value) override;
     virtual void SilentSetValue(string value) override;
-    virtual void ClearCache() override
-    {
-        lastDoubleValue_ = 0.0;
-        lastStringValue_ = "";
-    }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -951,6 +1057,7 @@ protected:
     CSurfIntegrator* const CSurfIntegrator_ ;
     Page* const page_;
     string const name_;
+    int const traceId_;
     Zone* const defaultZone_ = nullptr;
 
     string zoneFolder_ = "";
@@ -960,6 +1067,8 @@ protected:
 
     map<int, Navigator*> navigators_;
     
+    ShadowState shadowState_;
+    
     
     vector<Widget*> widgets_;
     map<string, Widget*> widgetsByName_;
@@ -971,12 +1080,14 @@ protected:
     
     FXActivationManager* const fxActivationManager_;
 
-    virtual void SurfaceOutMonitor(Widget* widget, string address, string value);
-
     void InitZones(string zoneFolder);
 
     map<string, ZoneTemplate*> zoneTemplates_;
     
+    // FX zone files are only parsed when their FX first turns up on a track
+    map<string, string> fxZoneFilePaths_;
+    list<string> residentFXZones_; // most recently used first, at most MaxResidentFXZones
+    
     virtual void InitHardwiredWidgets()
     {
         // Add the "hardwired" widgets
@@ -989,6 +1100,8 @@ public:
     
     Page* GetPage() { return page_; }
     string GetName() { return name_; }
+    ShadowState* GetShadowState() { return &shadowState_; }
+    int GetTraceId() { return traceId_; }
     
     virtual string GetSourceFileName() { return ""; }
     vector<Widget*> &GetWidgets() { return widgets_; }
@@ -1006,11 +1119,14 @@ public:
     Zone* GetDefaultZone() { return defaultZone_; }
     
     virtual void LoadingZone(string zoneName) {}
+    virtual void EnterPage() {}
+    virtual void LeavePage() {}
     virtual void HandleExternalInput() {}
+    virtual void ReplayInput(RecordKind kind, const vector<unsigned char> &payload) {}
     virtual void InitializeEuCon() {}
     virtual void InitializeEuConWidgets(vector<CSIWidgetInfo> *widgetInfoItems) {}
-    virtual void ReceiveEuConMessage(string oscAddress, double value) {}
-    virtual void ReceiveEuConMessage(string oscAddress, string value) {}
+    virtual void ReceiveEuConMessage(const char* address, double value) {}
+    virtual void ReceiveEuConMessage(const char* address, const char* value) {}
     virtual void UpdateTimeDisplay() {}
     virtual void ReceiveEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible) {}
     virtual void HandleEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible) {}
@@ -1042,26 +1158,19 @@ public:
     
     void GoZone(string zoneName)
     {
-        if(zoneTemplates_.count(zoneName) > 0)
+        if(zoneName == "Home")
         {
-            if(zoneName == "Home")
-            {
-                // GAW TDB, just deactivate all active Zones (including FXActivationManager) - "Home" is default
-            }
-            else
-            {
-                zoneTemplates_[zoneName]->Activate(this, activeZones_);
-            }
+            // GAW TDB, just deactivate all active Zones (including FXActivationManager) - "Home" is default
+        }
+        else if(ZoneTemplate* zoneTemplate = GetZoneTemplate(zoneName)) // FX zones are only parsed on first use
+        {
+            zoneTemplate->Activate(this, activeZones_);
         }
     }
 
-    ZoneTemplate* GetZoneTemplate(string zoneName)
-    {
-        if(zoneTemplates_.count(zoneName) > 0)
-            return zoneTemplates_[zoneName];
-        else
-            return nullptr;
-    }
+    static const int MaxResidentFXZones = 32;
+    
+    ZoneTemplate* GetZoneTemplate(string zoneName);
    
     void AddZoneTemplate(ZoneTemplate* zoneTemplate)
     {
@@ -1087,10 +1196,10 @@ public:
             widget->ForceClear();
     }
     
-    void ClearCache()
+    // Entering a page, whatever the device shows may have come from another page's surface
+    virtual void ClearCache()
     {
-        for(auto widget : widgets_)
-            widget->ClearCache();
+        shadowState_.InvalidateAll();
     }
     
     void AddWidget(Widget* widget)
@@ -1128,6 +1237,7 @@ private:
     string templateFilename_ = "";
     midi_Input* midiInput_ = nullptr;
     midi_Output* midiOutput_ = nullptr;
+    double lastSwapTimestamp_ = 0.0;
     map<int, vector<Midi_CSIMessageGenerator*>> CSIMessageGeneratorsByMidiMessage_;
     
     void ProcessMidiMessage(const MIDI_event_ex_t* evt);
@@ -1153,20 +1263,250 @@ public:
         if(midiInput_)
         {
             DAW::SwapBufsPrecise(midiInput_);
+            
+            bool isProfiling = CSIProfiler::IsEnabled();
+            bool isRecording = CSIRecorder::IsRecording();
+            double bufferStart = lastSwapTimestamp_;
+            double bufferEnd = isProfiling || isRecording ? CSIProfiler::GetTimestamp() : 0.0;
+            lastSwapTimestamp_ = bufferEnd;
+            
+            if(bufferStart == 0.0)
+                bufferStart = bufferEnd;
+            
             MIDI_eventlist* list = midiInput_->GetReadBuf();
             int bpos = 0;
             MIDI_event_t* evt;
             while ((evt = list->EnumItems(&bpos)))
+            {
+                // frame_offset is in 1/1024000 sec from the start of the buffer
+                double arrival = min(bufferStart + evt->frame_offset / 1024.0, bufferEnd);
+                
+                if(isProfiling)
+                    CSIProfiler::BeginInput(arrival);
+                
+                if(isRecording)
+                    CSIRecorder::Record(traceId_, RecordMidi, arrival, evt->midi_message, evt->size);
+                
                 ProcessMidiMessage((MIDI_event_ex_t*)evt);
+            }
+            
+            CSIProfiler::EndInput();
         }
     }
     
+    virtual void ReplayInput(RecordKind kind, const vector<unsigned char> &payload) override;
+    
     void AddCSIMessageGenerator(int message, Midi_CSIMessageGenerator* messageGenerator)
     {
         CSIMessageGeneratorsByMidiMessage_[message].push_back(messageGenerator);
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class OSCAddressMatcher
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Trie of address segments built from the .ost Control lines. A Control line may be an OSC 1.0 pattern
+    // (* ? [a-z] [!0-9] {foo,bar} within a segment), so one line can cover a whole bank, and an incoming address
+    // may itself be a pattern, as the spec allows. An exact match always wins over template patterns.
+private:
+    struct Node
+    {
+        vector<pair<string, int>> literalChildren; // segment, node index, sorted by segment
+        vector<pair<string, int>> patternChildren;
+        int addressId = -1;
+    };
+    
+    vector<Node> nodes_ = vector<Node>(1); // nodes_[0] is the root
+    vector<pair<string, int>> literalAddresses_; // for incoming patterns
+    bool hasPatterns_ = false;
+    
+    static bool IsPattern(string_view address) { return address.find_first_of("*?[{") != string_view::npos; }
+    static bool MatchSegment(string_view pattern, string_view text);
+    static bool MatchPath(string_view pattern, string_view path);
+    
+    int FindLiteralChild(int node, string_view segment);
+    void MatchPatterns(int node, string_view path, int* addressIds, int maxAddressIds, int &count);
+    
+public:
+    void Add(const string &address, int addressId);
+    void Clear() { nodes_ = vector<Node>(1); literalAddresses_.clear(); hasPatterns_ = false; }
+    
+    // Fills addressIds with every matching id and returns how many, never allocates
+    int Match(string_view address, int* addressIds, int maxAddressIds);
+};
+
+const int MaxOSCMatches = 64; // one incoming pattern can address at most this many widgets
+
+const int DefaultOSCMaxPacketSize = 1472; // Ethernet MTU less the IP and UDP headers, so a bundle is never fragmented
+
+const int MaxOSCArguments = 8; // enough for XY pads, XYZ accelerometers and RGBA, later arguments are ignored
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct OSCArguments
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Every argument of one message, read in place from the oscpkt storage, plain data so it can be queued and recorded as is
+    int numArguments = 0;
+    double values[MaxOSCArguments] = {};    // int32, int64, float, double and bool converted, 0 for strings and blobs
+    bool isNumeric[MaxOSCArguments] = {};   // false for strings, blobs and unknown tags, whose 0 is never dispatched as a value
+    int stringArgumentIndex = -1;           // the first string argument, if any
+    bool isStringTruncated = false;         // it didn't fit, a partial name or command is never dispatched
+    char stringValue[128] = {};             // copy of it, room for a REAPER track or FX name
+    
+    void Read(const oscpkt::Message &message);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct OSCInputRecord
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double timestamp = 0.0;
+    int addressId = -1;     // index into the surface's address table, -1 when no widget listens to the address
+    OSCArguments arguments;
+    char address[48] = {};  // only filled in when addressId is -1, so a trace still shows what the device sends
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class OSCInputQueue
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Bounded single producer (the OSC input thread), single consumer (Run) ring, never allocates
+private:
+    static const int Size = 4096; // must be a power of 2
+    
+    OSCInputRecord records_[Size];
+    atomic<size_t> writePosition_ = { 0 };
+    atomic<size_t> readPosition_ = { 0 };
+    atomic<int> dropped_ = { 0 };
+    
+    // Senders seen by the input thread, reported at most once a second each
+    static const int ClientsSize = 64; // must be a power of 2
+    
+    oscpkt::SockAddr clients_[ClientsSize];
+    atomic<size_t> clientWritePosition_ = { 0 };
+    atomic<size_t> clientReadPosition_ = { 0 };
+    
+public:
+    bool Push(const OSCInputRecord &record)
+    {
+        size_t writePosition = writePosition_.load(memory_order_relaxed);
+        
+        if(writePosition - readPosition_.load(memory_order_acquire) == Size)
+        {
+            dropped_++; // Run has stalled, losing input beats blocking the network thread
+            return false;
+        }
+        
+        records_[writePosition & (Size - 1)] = record;
+        writePosition_.store(writePosition + 1, memory_order_release);
+        
+        return true;
+    }
+    
+    // Consumer side, only while the queue isn't being fed
+    void Clear()
+    {
+        readPosition_.store(writePosition_.load(memory_order_acquire), memory_order_release);
+        clientReadPosition_.store(clientWritePosition_.load(memory_order_acquire), memory_order_release);
+    }
+    
+    bool Pop(OSCInputRecord &record)
+    {
+        size_t readPosition = readPosition_.load(memory_order_relaxed);
+        
+        if(readPosition == writePosition_.load(memory_order_acquire))
+            return false;
+        
+        record = records_[readPosition & (Size - 1)];
+        readPosition_.store(readPosition + 1, memory_order_release);
+        
+        return true;
+    }
+    
+    int GetNumDropped() { return dropped_; }
+    
+    bool PushClient(const oscpkt::SockAddr &client)
+    {
+        size_t writePosition = clientWritePosition_.load(memory_order_relaxed);
+        
+        if(writePosition - clientReadPosition_.load(memory_order_acquire) == ClientsSize)
+            return false; // the sender is reported again a second later
+        
+        clients_[writePosition & (ClientsSize - 1)] = client;
+        clientWritePosition_.store(writePosition + 1, memory_order_release);
+        
+        return true;
+    }
+    
+    bool PopClient(oscpkt::SockAddr &client)
+    {
+        size_t readPosition = clientReadPosition_.load(memory_order_relaxed);
+        
+        if(readPosition == clientWritePosition_.load(memory_order_acquire))
+            return false;
+        
+        client = clients_[readPosition & (ClientsSize - 1)];
+        clientReadPosition_.store(readPosition + 1, memory_order_release);
+        
+        return true;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class OSCInputThread
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // One thread waits on every OSC input socket at once, epoll on Linux and select elsewhere,
+    // decodes the packets and pushes the messages into each surface's OSCInputQueue.
+    // Every page has its own surface on a shared socket, only the active one's queue is fed, packets are dropped while none is.
+public:
+    static void Register(oscpkt::UdpSocket* socket, OSCInputQueue* queue, const vector<string> &addresses);
+    static void Unregister(OSCInputQueue* queue);
+    static void Activate(OSCInputQueue* queue);
+    static void Deactivate(OSCInputQueue* queue);
+    static void Shutdown();
+};
+
+const int OSCClientMaxPacketsPerTick = 8; // flow control, a client that falls behind gets the latest values, not every value
+const double OSCClientIdleTimeout = 60000.0; // ms without a packet before a client counts as gone
+
+const string OSCResyncAddress = "/csi/resync"; // sent by a client that wants the whole surface again
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct OSCFeedbackValue
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    bool hasValue = false;
+    bool isString = false;
+    float value = 0.0;
+    string text = "";
+    
+    bool operator==(const OSCFeedbackValue &other) const
+    {
+        return hasValue == other.hasValue && isString == other.isString && (isString ? text == other.text : value == other.value);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct OSCClient
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    oscpkt::SockAddr address;
+    bool isConnected = false;  // the single remote address of a classic surface, sent to on its connected socket
+    bool isConfigured = false; // listed in CSI.ini, never times out
+    double lastSeen = 0.0;     // 0 until the client first sends something
+    oscpkt::PacketWriter packetWriter;
+    int bundleSize = 0; // 0 when no bundle is open
+    int numBundledMessages = 0;
+    int numPacketsThisTick = 0;
+    
+    // Shadow of what this client shows, by feedback address id, and the ids that have changed since
+    vector<OSCFeedbackValue> sentValues;
+    vector<int> pendingAddressIds;
+    vector<bool> isPending;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class OSC_ControlSurface : public ControlSurface
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1176,59 +1516,185 @@ private:
     oscpkt::UdpSocket* const inSocket_ = nullptr;
     oscpkt::UdpSocket* const outSocket_ = nullptr;
     oscpkt::PacketReader packetReader_;
-    oscpkt::PacketWriter packetWriter_;
-    map<string, OSC_CSIMessageGenerator*> CSIMessageGeneratorsByOSCMessage_;
+    map<string, vector<OSC_CSIMessageGenerator*>> CSIMessageGeneratorsByOSCMessage_;
+    
+    // Decoded on the OSC input thread, addressIds index addresses_ and CSIMessageGeneratorsByAddressId_
+    OSCInputQueue inputQueue_;
+    vector<string> addresses_;
+    vector<vector<OSC_CSIMessageGenerator*>> CSIMessageGeneratorsByAddressId_; // one per argument the address carries
+    OSCAddressMatcher addressMatcher_; // the input thread has its own copy
+    
+    // Feedback goes out as one bundle per tick, split whenever the next message would take it past maxPacketSize_
+    int const maxPacketSize_ = DefaultOSCMaxPacketSize;
+    oscpkt::Message message_;
+    long long numPacketsSent_ = 0;
+    long long numBytesSent_ = 0;
+    long long numMessagesSent_ = 0;
+    
+    // The remote address may be a comma separated list of clients and/or "*" to take on anyone who sends to inSocket_.
+    // Feedback is computed once into feedbackValues_ and each client gets whatever differs from its own shadow.
+    bool autoRegistersClients_ = false;
+    int const clientPort_ = 0;
+    vector<OSCClient*> clients_;
+    unordered_map<string, int> feedbackAddressIds_;
+    vector<string> feedbackAddresses_;
+    vector<OSCFeedbackValue> feedbackValues_;
+    string currentZoneAddress_ = "";
     
     void InitWidgets(string templateFilename, string zoneFolder);
-    void ProcessOSCMessage(string message, double value);
+    void InitClients(const string &remoteAddresses);
+    void ProcessOSCMessage(string_view address, const OSCArguments &arguments);
+    void ProcessOSCMessage(int addressId, const char* address, const OSCArguments &arguments);
+    void AddToBundle(OSCClient* client, const oscpkt::Message &message, int messageSize);
+    void FlushBundle(OSCClient* client);
+    OSCClient* AddClient(oscpkt::SockAddr address, bool isConfigured);
+    void RegisterClient(oscpkt::SockAddr address);
+    void RemoveIdleClients();
+    void ResyncClient(OSCClient* client);
+    void SetFeedbackValue(const string &oscAddress, const OSCFeedbackValue &value);
+    void SendToClient(OSCClient* client);
+    void SendToClients();
 
 public:
-    OSC_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string templateFilename, string zoneFolder, int numChannels, int numSends, int numFX, int options, oscpkt::UdpSocket* inSocket, oscpkt::UdpSocket* outSocket)
-    : ControlSurface(CSurfIntegrator, page, name, zoneFolder, numChannels, numSends, numFX, options), templateFilename_(templateFilename), inSocket_(inSocket), outSocket_(outSocket)
+    OSC_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string templateFilename, string zoneFolder, int numChannels, int numSends, int numFX, int options, oscpkt::UdpSocket* inSocket, oscpkt::UdpSocket* outSocket, int maxPacketSize = DefaultOSCMaxPacketSize, string remoteAddresses = "", int remotePort = 0)
+    : ControlSurface(CSurfIntegrator, page, name, zoneFolder, numChannels, numSends, numFX, options), templateFilename_(templateFilename), inSocket_(inSocket), outSocket_(outSocket), maxPacketSize_(maxPacketSize), clientPort_(remotePort)
     {
+        InitClients(remoteAddresses);
         InitWidgets(templateFilename, zoneFolder);
+        
+        for(auto [message, messageGenerators] : CSIMessageGeneratorsByOSCMessage_)
+        {
+            addressMatcher_.Add(message, addresses_.size());
+            addresses_.push_back(message);
+            CSIMessageGeneratorsByAddressId_.push_back(messageGenerators);
+        }
+        
+        if(inSocket_ != nullptr && inSocket_->isOk())
+            OSCInputThread::Register(inSocket_, &inputQueue_, addresses_);
     }
     
-    virtual ~OSC_ControlSurface() {}
+    virtual ~OSC_ControlSurface()
+    {
+        OSCInputThread::Unregister(&inputQueue_);
+        
+        for(auto client : clients_)
+            delete client;
+    }
+    
+    // More than one remote address, or "*", needs an unconnected socket to reach them all
+    static bool IsClientList(const string &remoteAddresses)
+    {
+        return remoteAddresses.find(',') != string::npos || remoteAddresses.find('*') != string::npos;
+    }
     
     virtual string GetSourceFileName() override { return "/CSI/Surfaces/OSC/" + templateFilename_; }
     
     virtual void LoadingZone(string zoneName) override;
+    
+    // Anything still queued is from the last time this page was up
+    virtual void EnterPage() override
+    {
+        inputQueue_.Clear();
+        OSCInputThread::Activate(&inputQueue_);
+    }
+    
+    virtual void LeavePage() override { OSCInputThread::Deactivate(&inputQueue_); }
+    
+    // Each client's sentValues shadow is forgotten too
+    virtual void ClearCache() override
+    {
+        ControlSurface::ClearCache();
+        Resync();
+    }
+    
     void SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, double value);
     void SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, string value);
     
+    long long GetNumPacketsSent() { return numPacketsSent_; }
+    long long GetNumBytesSent() { return numBytesSent_; }
+    long long GetNumMessagesSent() { return numMessagesSent_; }
+    int GetNumClients() { return clients_.size(); }
+    
+    // Resends the complete feedback state to every client, packed into as few bundles as maxPacketSize_ allows
+    // and paced at OSCClientMaxPacketsPerTick per client
+    void Resync()
+    {
+        for(auto client : clients_)
+            ResyncClient(client);
+    }
+    
     virtual void ForceClearAllWidgets() override
     {
         LoadingZone("Home");
         ControlSurface::ForceClearAllWidgets();
+        SendToClients(); // may be the last thing sent before shutdown
+    }
+    
+    virtual void RequestUpdate() override
+    {
+        ControlSurface::RequestUpdate();
+        RemoveIdleClients();
+        SendToClients();
     }
     
     virtual void HandleExternalInput() override
     {
-        if(inSocket_ != nullptr && inSocket_->isOk())
+        // Everything here was received and decoded on the OSC input thread
+        OSCInputRecord record;
+        bool isProfiling = CSIProfiler::IsEnabled();
+        bool isRecording = CSIRecorder::IsRecording();
+        
+        oscpkt::SockAddr clientAddress;
+        
+        while(inputQueue_.PopClient(clientAddress))
+            RegisterClient(clientAddress);
+        
+        while(inputQueue_.Pop(record))
         {
-            while (inSocket_->receiveNextPacket(0))  // timeout, in ms
-            {
-                packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
-                oscpkt::Message *message;
-                
-                while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
-                {
-                    float value = 0;
-                    
-                    if(message->arg().isFloat())
-                    {
-                        message->arg().popFloat(value);
-                        ProcessOSCMessage(message->addressPattern(), value);
-                    }
-                }
-            }
+            const char* address = record.addressId < 0 ? record.address : addresses_[record.addressId].c_str();
+            
+            if(isProfiling)
+                CSIProfiler::BeginInput(record.timestamp);
+            
+            if(isRecording)
+                CSIRecorder::Record(traceId_, RecordOSCMessage, record.timestamp, &record.arguments, sizeof(record.arguments), address);
+            
+            ProcessOSCMessage(record.addressId, address, record.arguments);
+        }
+        
+        CSIProfiler::EndInput();
+    }
+    
+    void ProcessOSCPacket(const void* data, int size)
+    {
+        packetReader_.init(data, size);
+        oscpkt::Message *message;
+        OSCArguments arguments;
+        
+        while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
+        {
+            arguments.Read(*message);
+            
+            if(arguments.numArguments > 0 || message->addressPattern() == OSCResyncAddress)
+                ProcessOSCMessage(message->addressPattern(), arguments);
+        }
+    }
+    
+    virtual void ReplayInput(RecordKind kind, const vector<unsigned char> &payload) override
+    {
+        if(kind == RecordOSCPacket)
+            ProcessOSCPacket(payload.data(), payload.size());
+        else if(kind == RecordOSCMessage && payload.size() > sizeof(OSCArguments))
+        {
+            OSCArguments arguments;
+            memcpy(&arguments, payload.data(), sizeof(arguments));
+            ProcessOSCMessage(string_view((const char*)payload.data() + sizeof(arguments), payload.size() - sizeof(arguments)), arguments);
         }
     }
 
     void AddCSIMessageGenerator(string message, OSC_CSIMessageGenerator* messageGenerator)
     {
-        CSIMessageGeneratorsByOSCMessage_[message] = messageGenerator;
+        CSIMessageGeneratorsByOSCMessage_[message].push_back(messageGenerator);
     }
 };
 
@@ -1249,6 +1715,7 @@ class WidgetGroup
 {
 private:
     bool isVisible_ = false;
+    int numVisibleWidgets_ = 0; // as of the last CollectVisibleWidgets
     
     vector<Widget*> widgets_;
     map<string, WidgetGroup*> subGroups_;
@@ -1265,16 +1732,34 @@ public:
            subGroups_[subgroupName]->SetIsVisible(isVisible);
     }
     
-    void RequestUpdate()
+    // Appends every widget that a RequestUpdate would reach right now, only called when visibility changes
+    int CollectVisibleWidgets(vector<Widget*> &visibleWidgets)
     {
+        numVisibleWidgets_ = 0;
+        
         if(isVisible_)
         {
-            for(auto widget : widgets_)
-                widget->RequestUpdate();
+            visibleWidgets.insert(visibleWidgets.end(), widgets_.begin(), widgets_.end());
+            numVisibleWidgets_ = (int)widgets_.size();
             
             for(auto [name, group] : subGroups_)
-                group->RequestUpdate();
+                numVisibleWidgets_ += group->CollectVisibleWidgets(visibleWidgets);
         }
+        else
+            for(auto [name, group] : subGroups_)
+                group->numVisibleWidgets_ = 0;
+        
+        return numVisibleWidgets_;
+    }
+    
+    int GetNumVisibleWidgets() { return numVisibleWidgets_; }
+    
+    int GetNumVisibleWidgets(string subgroupName)
+    {
+        if(subGroups_.count(subgroupName) > 0)
+            return subGroups_[subgroupName]->GetNumVisibleWidgets();
+        else
+            return 0;
     }
     
     void AddWidget(Widget* widget)
@@ -1293,32 +1778,235 @@ public:
 
 typedef struct PeakInfoStruct
 {
-    double timePeakSet;
-    float peakValue;
-    bool isClipping;
+    double timePeakSet = 0.0;
+    float peakValue = -1000.0;
+    bool isClipping = false;
 } PeakInfo;
 
+struct EuConMeterValues
+{
+    float level = -144.0;
+    float peak = -144.0;
+    bool isClipping = false;
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class MarshalledFunctionCall;
+class EuConMeterSnapshot
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Written once a tick by Run, read whenever EuCon asks on its own thread. A seqlock, the sequence is odd while Run
+    // is writing and even once the values are stable, a reader retries if it began during a write or one happened since.
+private:
+    atomic<unsigned int> sequence_ = { 0 };
+    atomic<float> level_ = { -144.0 };
+    atomic<float> peak_ = { -144.0 };
+    atomic<bool> isClipping_ = { false };
+    
+public:
+    void Write(const EuConMeterValues &values) // Run only
+    {
+        unsigned int sequence = sequence_.load(memory_order_relaxed);
+        
+        sequence_.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        
+        level_.store(values.level, memory_order_relaxed);
+        peak_.store(values.peak, memory_order_relaxed);
+        isClipping_.store(values.isClipping, memory_order_relaxed);
+        
+        sequence_.store(sequence + 2, memory_order_release);
+    }
+    
+    EuConMeterValues Read()
+    {
+        EuConMeterValues values;
+        
+        while(true)
+        {
+            unsigned int sequence = sequence_.load(memory_order_acquire);
+            
+            if(sequence & 1)
+                continue;
+            
+            values.level = level_.load(memory_order_relaxed);
+            values.peak = peak_.load(memory_order_relaxed);
+            values.isClipping = isClipping_.load(memory_order_relaxed);
+            
+            atomic_thread_fence(memory_order_acquire);
+            
+            if(sequence_.load(memory_order_relaxed) == sequence)
+                return values;
+        }
+    }
+};
+
+enum EuConInputKind
+{
+    EuConInputDouble,
+    EuConInputString,
+    EuConInputVisibility,
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct EuConInputRecord
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double timestamp = 0.0;
+    EuConInputKind kind = EuConInputDouble;
+    int addressId = -1;         // index into the surface's address table, -1 when no widget listens to the address
+    double value = 0.0;
+    int channelNumber = 0;      // visibility changes only
+    bool isVisible = false;
+    int overflowId = -1;        // address and text didn't fit, the surface holds them, see EuCon_ControlSurface::PushInput
+    char address[96] = {};      // only filled in when addressId is -1, holds the group name of a visibility change
+    char text[128] = {};        // string messages only
+};
+
+// Interned in every EuCon surface before anything else, so the special inbound addresses are compared by id
+const int EuConPostMessageAddressId = 0;
+const int EuConLayoutChangedAddressId = 1;
+
+enum EuConAddressFlags
+{
+    EuConAddressIsPanLabel = 1, // Pan, Width, PanL and PanR displays, EuCon owns their text
+    EuConAddressIsControl = 2,  // drives a widget
+    EuConAddressIsContinuous = 4, // drives a fader, pan or knob, so only its latest position in a tick matters
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct EuConAddressTable
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Immutable once published, so the EuCon threads can intern addresses against it without a lock
+    vector<string> addresses;               // by address id
+    vector<Widget*> widgets;                // by address id, the widget with that name, if any
+    unordered_map<string_view, int> ids;    // views into addresses
+    
+    int Find(const char* address) const
+    {
+        auto it = ids.find(string_view(address));
+        return it == ids.end() ? -1 : it->second;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class EuConInputQueue
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Bounded multiple producer (EuCon calls in on its own threads), single consumer (Run) ring, never allocates
+private:
+    static const int Size = 4096; // must be a power of 2
+    
+    struct Slot
+    {
+        atomic<size_t> sequence;
+        EuConInputRecord record;
+    };
+    
+    Slot slots_[Size];
+    atomic<size_t> writePosition_ = { 0 };
+    size_t readPosition_ = 0; // Run only
+    atomic<int> dropped_ = { 0 };
+    
+public:
+    EuConInputQueue()
+    {
+        for(size_t i = 0; i < Size; i++)
+            slots_[i].sequence.store(i, memory_order_relaxed);
+    }
+    
+    bool Push(const EuConInputRecord &record)
+    {
+        size_t position = writePosition_.load(memory_order_relaxed);
+        
+        while(true)
+        {
+            Slot &slot = slots_[position & (Size - 1)];
+            intptr_t difference = (intptr_t)slot.sequence.load(memory_order_acquire) - (intptr_t)position;
+            
+            if(difference == 0)
+            {
+                if(writePosition_.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    slot.record = record;
+                    slot.sequence.store(position + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if(difference < 0)
+            {
+                dropped_++; // Run has stalled, losing input beats blocking EuCon
+                return false;
+            }
+            else
+                position = writePosition_.load(memory_order_relaxed);
+        }
+    }
+    
+    bool Pop(EuConInputRecord &record)
+    {
+        Slot &slot = slots_[readPosition_ & (Size - 1)];
+        
+        if(slot.sequence.load(memory_order_acquire) != readPosition_ + 1)
+            return false;
+        
+        record = slot.record;
+        slot.sequence.store(readPosition_ + Size, memory_order_release);
+        readPosition_++;
+        
+        return true;
+    }
+    
+    int GetDepth() { return (int)(writePosition_.load(memory_order_relaxed) - readPosition_); } // Run only
+    int GetNumDropped() { return dropped_; }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class EuCon_ControlSurface : public ControlSurface
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
     bool isEuConFXAreaFocused_ = false;
-    double previousPP = 0.0;
-    
-    map<string, EuCon_CSIMessageGenerator*> CSIMessageGeneratorsByMessage_;
+    bool isTimeDisplayCurrent_ = false;
+    char primaryTimeDisplay_[64] = {};   // as last sent
+    char secondaryTimeDisplay_[64] = {};
+    
+    // Every address EuCon sends or is sent, interned once so nothing on either path compares or searches strings
+    map<string, int, less<>> addressIds_;
+    vector<string> addresses_; // by address id, only ever appended to so ids already in the queue stay valid
+    vector<int> addressFlags_;
+    vector<EuCon_CSIMessageGenerator*> CSIMessageGeneratorsByAddressId_;
+    vector<Widget*> widgetsByAddressId_;
+    atomic<EuConAddressTable*> addressTable_ = { nullptr };
+    vector<EuConAddressTable*> addressTables_; // every table published, an EuCon thread may still be reading an old one
 
     vector<Widget*> generalWidgets_;
     map<int, WidgetGroup*> channelGroups_;
+    vector<Widget*> visibleWidgets_; // general widgets then every visible channel widget, rebuilt when EuCon changes visibility
+    
+    void RebuildVisibleWidgets();
+    
+    EuConInputQueue inputQueue_;
+    vector<EuConInputRecord> pendingInput_;     // one tick's input after coalescing, capacity is kept between ticks
+    vector<int> pendingIndexByAddressId_;       // where in pendingInput_ each address's latest continuous value is, -1 for none
+    int maxInputDepth_ = 0;
+    long long numInputCoalesced_ = 0;
     
-    WDL_Mutex mutex_;
-    list<MarshalledFunctionCall*> workQueue_;
+    // The rare address or text too long for a record, taken back by overflowId when Run handles the record
+    WDL_Mutex inputOverflowMutex_;
+    map<int, pair<string, string>> inputOverflow_;
+    int nextInputOverflowId_ = 0;
+    
+    void PushInput(EuConInputRecord &record, const char* address, const char* text);
+    void PublishAddressTable();
+    void HandleEuConInput(const EuConInputRecord &record);
 
     Widget* InitializeEuConWidget(CSIWidgetInfo &widgetInfo);
     
-    map<int, PeakInfo> peakInfo_;
+    EuConMeterSnapshot* meters_ = nullptr; // by channel, allocated once so the EuCon thread can always index it
+    vector<PeakInfo> peakInfo_; // by channel, Run only
+    
+    void UpdateMeters();
     
 protected:
     virtual void InitHardwiredWidgets() override
@@ -1331,7 +2019,13 @@ protected:
     
 public:
     EuCon_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string zoneFolder, int numChannels, int numSends, int numFX, int options);
-    virtual ~EuCon_ControlSurface() {}
+    virtual ~EuCon_ControlSurface()
+    {
+        delete[] meters_;
+        
+        for(auto table : addressTables_)
+            delete table;
+    }
     
     virtual string GetSourceFileName() override { return "EuCon"; }
     
@@ -1339,16 +2033,18 @@ public:
 
     virtual void InitializeEuCon() override;
     virtual void InitializeEuConWidgets(vector<CSIWidgetInfo> *widgetInfoItems) override;
-    void SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, string address, double value);
-    void SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, string address, double value, int param);
-    void SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, string address, string value);
-    void SendEuConMessage(string address, string value);
-    void HandleEuConMessage(string address, double value);
-    void HandleEuConMessage(string address, string value);
+    void SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, int addressId, double value);
+    void SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, int addressId, double value, int param);
+    void SendEuConMessage(EuCon_FeedbackProcessor* feedbackProcessor, int addressId, const string &value);
+    void SendEuConMessage(const char* address, const char* value);
+    void HandleEuConMessage(int addressId, const char* address, double value);
+    void HandleEuConMessage(string address, double value) { HandleEuConMessage(-1, address.c_str(), value); }
+    void HandleEuConMessage(const char* address, const char* value);
     virtual void UpdateTimeDisplay() override;
-    virtual void ReceiveEuConMessage(string address, double value) override;
-    virtual void ReceiveEuConMessage(string address, string value) override;
+    virtual void ReceiveEuConMessage(const char* address, double value) override;
+    virtual void ReceiveEuConMessage(const char* address, const char* value) override;
     virtual void HandleExternalInput() override;
+    virtual void ReplayInput(RecordKind kind, const vector<unsigned char> &payload) override;
     virtual void ReceiveEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible) override;
     virtual void HandleEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible) override;
     virtual void ReceiveEuConGetMeterValues(int id, int iLeg, float& oLevel, float& oPeak, bool& oLegClip) override;
@@ -1356,24 +2052,114 @@ public:
 
     virtual void RequestUpdate() override
     {
-        for(auto widget : generalWidgets_)
+        for(auto widget : visibleWidgets_)
             widget->RequestUpdate();
         
-        for(auto [channel, group] : channelGroups_)
-            group->RequestUpdate();
-        
+        UpdateMeters();
         SendEuConMessage("RequestUpdateMeters", "Update");
     }
 
     virtual void ForceRefreshTimeDisplay() override
     {
-        previousPP = 0.5;
+        isTimeDisplayCurrent_ = false;
     }
 
+    int InternAddress(const string &address);
+    
     void AddCSIMessageGenerator(string message, EuCon_CSIMessageGenerator* messageGenerator)
     {
-        CSIMessageGeneratorsByMessage_[message] = messageGenerator;
+        int addressId = InternAddress(message);
+        
+        CSIMessageGeneratorsByAddressId_[addressId] = messageGenerator;
+        addressFlags_[addressId] |= EuConAddressIsControl;
+    }
+    
+    int GetNumVisibleWidgets() { return (int)visibleWidgets_.size(); }
+    
+    int GetNumVisibleWidgets(int channelNumber)
+    {
+        if(channelGroups_.count(channelNumber) > 0)
+            return channelGroups_[channelNumber]->GetNumVisibleWidgets();
+        else
+            return 0;
+    }
+    
+    int GetNumVisibleWidgets(int channelNumber, string subgroupName)
+    {
+        if(channelGroups_.count(channelNumber) > 0)
+            return channelGroups_[channelNumber]->GetNumVisibleWidgets(subgroupName);
+        else
+            return 0;
     }
+    
+    int GetInputQueueDepth() { return inputQueue_.GetDepth(); }
+    int GetMaxInputQueueDepth() { return maxInputDepth_; }
+    int GetNumInputDropped() { return inputQueue_.GetNumDropped(); }
+    long long GetNumInputCoalesced() { return numInputCoalesced_; }
+};
+
+enum TrackStateColumn
+{
+    TrackStateVolPan,       // GetTrackUIVolPan, what faders and pan knobs follow
+    TrackStateVolume,       // D_VOL
+    TrackStatePan,          // D_PAN
+    TrackStateWidth,        // D_WIDTH
+    TrackStateMute,         // GetTrackUIMute
+    TrackStateSolo,         // I_SOLO
+    TrackStateSelected,     // I_SELECTED
+    TrackStateRecordArm,    // I_RECARM
+    TrackStateAutoMode,     // I_AUTOMODE
+    NumTrackStateColumns
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TrackStateSnapshot
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // What the tracks on the surfaces look like this tick, one contiguous column per property.
+    // A track joins the first time an action asks about it, and a column is read for every track at once
+    // the first time it is asked for, so a tick costs one DAW read per shown track per property in use
+    // however many widgets, zones and surfaces show it.
+private:
+    vector<MediaTrack*> tracks_;
+    vector<pair<MediaTrack*, int>> indexes_; // sorted by track, for the lookup
+    bool isCurrent_[NumTrackStateColumns] = {};
+    
+    vector<double> uiVolumes_;
+    vector<double> uiPans_;
+    vector<double> volumes_;
+    vector<double> pans_;
+    vector<double> widths_;
+    vector<char> mutes_;
+    vector<double> solos_;
+    vector<double> selected_;
+    vector<double> recordArms_;
+    vector<int> autoModes_;
+    
+    int GetIndex(MediaTrack* track, TrackStateColumn column);
+    void ReadColumn(TrackStateColumn column, int first, int last);
+    
+public:
+    // Start of every tick and after every action, the columns keep their capacity
+    void Invalidate()
+    {
+        tracks_.clear();
+        indexes_.clear();
+        memset(isCurrent_, 0, sizeof(isCurrent_));
+    }
+    
+    int GetNumTracks() { return (int)tracks_.size(); }
+    
+    double GetUIVolume(MediaTrack* track) { return uiVolumes_[GetIndex(track, TrackStateVolPan)]; }
+    double GetUIPan(MediaTrack* track) { return uiPans_[GetIndex(track, TrackStateVolPan)]; }
+    double GetVolume(MediaTrack* track) { return volumes_[GetIndex(track, TrackStateVolume)]; }
+    double GetPan(MediaTrack* track) { return pans_[GetIndex(track, TrackStatePan)]; }
+    double GetWidth(MediaTrack* track) { return widths_[GetIndex(track, TrackStateWidth)]; }
+    bool GetUIMute(MediaTrack* track) { return mutes_[GetIndex(track, TrackStateMute)] != 0; }
+    double GetSolo(MediaTrack* track) { return solos_[GetIndex(track, TrackStateSolo)]; }
+    double GetSelected(MediaTrack* track) { return selected_[GetIndex(track, TrackStateSelected)]; }
+    double GetRecordArm(MediaTrack* track) { return recordArms_[GetIndex(track, TrackStateRecordArm)]; }
+    int GetAutoMode(MediaTrack* track) { return autoModes_[GetIndex(track, TrackStateAutoMode)]; }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1397,6 +2183,16 @@ private:
     Navigator* const selectedTrackNavigator_ = nullptr;
     Navigator* const focusedFXNavigator_ = nullptr;
     Navigator* const defaultNavigator_ = nullptr;
+    TrackStateSnapshot trackStates_;
+    
+    // Resolved at most once a tick, or again when REAPER reports a change
+    bool isFocusedFXCurrent_ = false;
+    MediaTrack* focusedFXTrack_ = nullptr;
+    int focusedFXIndex_ = 0;
+    bool isLastTouchedFXCurrent_ = false;
+    MediaTrack* lastTouchedFXTrack_ = nullptr;
+    int lastTouchedFXSlot_ = 0;
+    int lastTouchedFXParam_ = 0;
 
 public:
     TrackNavigationManager(Page* page, bool followMCP, bool synchPages) : page_(page), followMCP_(followMCP), synchPages_(synchPages),
@@ -1411,6 +2207,12 @@ public:
     Navigator* GetSelectedTrackNavigator() { return selectedTrackNavigator_; }
     Navigator* GetFocusedFXNavigator() { return focusedFXNavigator_; }
     Navigator* GetDefaultNavigator() { return defaultNavigator_; }
+    TrackStateSnapshot* GetTrackStates() { return &trackStates_; }
+    
+    void InvalidateFocusedFX() { isFocusedFXCurrent_ = false; }
+    void InvalidateLastTouchedFX() { isLastTouchedFXCurrent_ = false; }
+    MediaTrack* GetFocusedFXTrack(int* fxIndex);
+    MediaTrack* GetLastTouchedFXTrack(int* fxSlot, int* fxParam);
 
     void SetScrollLink(bool scrollLink) { scrollLink_ = scrollLink; }
     void ForceScrollLink();
@@ -1714,16 +2516,16 @@ public:
             surface->InitializeEuConWidgets(widgetInfoItems);
     }
     
-    void ReceiveEuConMessage(string oscAddress, double value)
+    void ReceiveEuConMessage(const char* address, double value)
     {
         for(auto surface : surfaces_)
-            surface->ReceiveEuConMessage(oscAddress, value);
+            surface->ReceiveEuConMessage(address, value);
     }
     
-    void ReceiveEuConMessage(string oscAddress, string value)
+    void ReceiveEuConMessage(const char* address, const char* value)
     {
         for(auto surface : surfaces_)
-            surface->ReceiveEuConMessage(oscAddress, value);
+            surface->ReceiveEuConMessage(address, value);
     }
     
     void ReceiveEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible)
@@ -1826,15 +2628,40 @@ public:
 */
 
 
+    ControlSurface* GetSurface(string name)
+    {
+        for(auto surface : surfaces_)
+            if(surface->GetName() == name)
+                return surface;
+        
+        return nullptr;
+    }
+    
     void Run()
     {
-        trackNavigationManager_->RebuildTrackList();
+        ProfileScope profileScope(ProfileRun);
+        
+        CSIRecorder::BeginTick();
+        
+        {
+            ProfileScope rebuildScope(ProfileRebuildTrackList);
+            trackNavigationManager_->RebuildTrackList();
+            trackNavigationManager_->GetTrackStates()->Invalidate();
+            trackNavigationManager_->InvalidateFocusedFX();
+            trackNavigationManager_->InvalidateLastTouchedFX();
+        }
         
         for(auto surface : surfaces_)
+        {
+            ProfileScope surfaceScope(ProfileHandleExternalInput, surface->GetTraceId());
             surface->HandleExternalInput();
+        }
         
         for(auto surface : surfaces_)
+        {
+            ProfileScope surfaceScope(ProfileRequestUpdate, surface->GetTraceId());
             surface->RequestUpdate();
+        }
     }
 
     void ForceClearAllWidgets()
@@ -1936,9 +2763,16 @@ public:
     
     void OnFXFocus(MediaTrack *track, int fxIndex)
     {
+        trackNavigationManager_->InvalidateFocusedFX();
+        
         for(auto surface : surfaces_)
             surface->OnFXFocus(track, fxIndex);
     }
+    
+    void OnLastTouchedFX()
+    {
+        trackNavigationManager_->InvalidateLastTouchedFX();
+    }
 
     void TrackFXListChanged(MediaTrack* track)
     {
@@ -1951,15 +2785,160 @@ public:
         trackNavigationManager_->EnterPage();
         
         for(auto surface : surfaces_)
+        {
+            surface->EnterPage();
             surface->ClearCache();
+        }
     }
     
     void LeavePage()
     {
         trackNavigationManager_->LeavePage();
+        
+        for(auto surface : surfaces_)
+            surface->LeavePage();
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TimeDisplayFormatter
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Shared by every time display, MCU and EuCon alike. The transport is read at most once a tick and each text
+    // is only formatted again once the position has moved by one unit of what that text shows.
+private:
+    struct CachedText
+    {
+        int mode = -1;      // -1 until formatted
+        double key = 0.0;   // the position in display units when it was formatted
+        char text[64] = {};
+    };
+    
+    int *timeModePtr_ = nullptr;
+    int *timeMode2Ptr_ = nullptr;
+    int *measOffsPtr_ = nullptr;
+    double *timeOffsPtr_ = nullptr;
+    
+    bool isCurrent_ = false;
+    int timeMode_ = 0;
+    double position_ = 0.0;
+    
+    bool hasBeats_ = false;
+    int measures_ = 0;
+    double beatsInMeasure_ = 0.0;
+    double fullBeats_ = 0.0;
+    
+    CachedText texts_[6]; // by format_timestr_pos mode
+    CachedText mcuDigits_;
+    
+    void Update();
+    void UpdateBeats();
+    double GetKey(int mode, double unitsPerSecond, double unitsPerBeat);
+    void FormatMCUDigits(unsigned char* digits);
+    
+    double GetTimeOffset() { return timeOffsPtr_ ? *timeOffsPtr_ : 0.0; }
+    
+public:
+    void Init(int *timeModePtr, int *timeMode2Ptr, int *measOffsPtr, double *timeOffsPtr)
+    {
+        timeModePtr_ = timeModePtr;
+        timeMode2Ptr_ = timeMode2Ptr;
+        measOffsPtr_ = measOffsPtr;
+        timeOffsPtr_ = timeOffsPtr;
+    }
+    
+    void Invalidate() { isCurrent_ = false; } // once a tick, by Run
+    
+    int GetTimeMode() { Update(); return timeMode_; }
+    
+    // format_timestr_pos text for mode, the time modes with a clock (0, 3 and 5) include the project time offset
+    const char* GetText(int mode);
+    
+    // The MCU's ten digit display, leftmost digit first
+    const unsigned char* GetMCUDigits();
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TrackAppearanceCache
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Track names and colours hardly ever change, so unlike TrackStateSnapshot they are kept from tick to tick.
+    // SetTrackTitle and track list changes make them stale, and because REAPER says nothing when a colour changes
+    // every entry is read again once each VerifyInterval ticks.
+private:
+    struct TrackAppearance
+    {
+        bool isNameCurrent = false;
+        bool isColourCurrent = false;
+        unsigned int colour = 0;
+        char name[128] = {};
+    };
+    
+    unordered_map<MediaTrack*, TrackAppearance> appearances_;
+    int ticksSinceVerify_ = 0;
+    
+public:
+    static const int VerifyInterval = 30; // about once a second
+    
+    void Run(); // once a tick
+    
+    // The track list changed, a pointer may now be another track or none at all
+    void Clear() { appearances_.clear(); }
+    
+    void OnTrackTitleChange(MediaTrack* track);
+    
+    const char* GetName(MediaTrack* track);
+    unsigned int GetColour(MediaTrack* track);
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FXParamCache
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // One entry per (track, fx slot) a surface shows. Names are read once and kept until the track's FX list changes.
+    // The first value asked for from a slot in a tick reads every param of that slot still in use, and a formatted value,
+    // which some plugins are slow to produce, is only asked for again once its param has moved.
+private:
+    struct FXParam
+    {
+        bool isInUse = false;       // asked about since the slot was last polled
+        bool hasName = false;
+        bool hasFormattedValue = false;
+        int valueTick = -1;
+        double value = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double formattedValue = 0.0; // the value formattedText was made from
+        char name[128] = {};
+        char formattedText[128] = {};
+    };
+    
+    struct FXSlot
+    {
+        int polledTick = -1;
+        vector<FXParam> params;
+    };
+    
+    map<pair<MediaTrack*, int>, FXSlot> slots_;
+    int tick_ = 0;
+    
+    FXParam& GetParam(MediaTrack* track, int slotIndex, int paramIndex);
+    FXParam& GetCurrentParam(MediaTrack* track, int slotIndex, int paramIndex);
+    
+public:
+    // Start of every tick and after every action
+    void Invalidate() { tick_++; }
+    
+    // The track list changed, a pointer may now be another track or none at all
+    void Clear() { slots_.clear(); }
+    
+    void OnFXListChange(MediaTrack* track);
+    
+    double GetValue(MediaTrack* track, int slotIndex, int paramIndex, double* min, double* max);
+    const char* GetName(MediaTrack* track, int slotIndex, int paramIndex);
+    const char* GetFormattedValue(MediaTrack* track, int slotIndex, int paramIndex);
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Manager
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1978,6 +2957,16 @@ private:
     bool surfaceOutDisplay_ = false;
     bool fxParamsDisplay_ = false;
     bool fxParamsWrite_ = false;
+    bool traceCapture_ = false;
+    bool isProfiling_ = false;
+    
+    bool isReplaying_ = false; // only the headless host replays, see StartReplay
+#ifdef CSI_HEADLESS_DAW
+    vector<RecordedEvent> replayEvents_;
+    int replayPosition_ = 0;
+    double replayStartTimestamp_ = 0.0;
+    bool replayAsFastAsPossible_ = false;
+#endif
 
     bool shouldRun_ = true;
     
@@ -1986,8 +2975,26 @@ private:
     int *measOffsPtr_ = nullptr;
     double *timeOffsPtr_ = nullptr;
     
+    TimeDisplayFormatter timeDisplayFormatter_;
+    TrackAppearanceCache trackAppearances_;
+    FXParamCache fxParams_;
+    
     void InitActionsDictionary();
 
+    // Capture records everything for DumpTrace without echoing it to the console
+    // A replay captures the feedback it produces
+    void UpdateTrace()
+    {
+        int consoleDirections = (surfaceInDisplay_ ? TraceInput : 0) | (surfaceOutDisplay_ ? TraceOutput : 0);
+        
+        CSITrace::SetEnabled((traceCapture_ ? TraceInput | TraceOutput : consoleDirections) | (isReplaying_ ? TraceOutput : 0), consoleDirections);
+    }
+    
+#ifdef CSI_HEADLESS_DAW
+    void ReplayTick();
+    void FinishReplay();
+#endif
+    
     double GetPrivateProfileDouble(string key)
     {
         char tmp[512];
@@ -2005,17 +3012,19 @@ public:
         InitActionsDictionary();
 
         int size = 0;
-        int index = projectconfig_var_getoffs("projtimemode", &size);
-        timeModePtr_ = (int *)projectconfig_var_addr(nullptr, index);
+        int index = DAW::projectconfig_var_getoffs("projtimemode", &size);
+        timeModePtr_ = (int *)DAW::projectconfig_var_addr(nullptr, index);
+        
+        index = DAW::projectconfig_var_getoffs("projtimemode2", &size);
+        timeMode2Ptr_ = (int *)DAW::projectconfig_var_addr(nullptr, index);
         
-        index = projectconfig_var_getoffs("projtimemode2", &size);
-        timeMode2Ptr_ = (int *)projectconfig_var_addr(nullptr, index);
+        index = DAW::projectconfig_var_getoffs("projmeasoffs", &size);
+        measOffsPtr_ = (int *)DAW::projectconfig_var_addr(nullptr, index);
         
-        index = projectconfig_var_getoffs("projmeasoffs", &size);
-        measOffsPtr_ = (int *)projectconfig_var_addr(nullptr, index);
+        index = DAW::projectconfig_var_getoffs("projtimeoffs", &size);
+        timeOffsPtr_ = (double *)DAW::projectconfig_var_addr(nullptr, index);
         
-        index = projectconfig_var_getoffs("projtimeoffs", &size);
-        timeOffsPtr_ = (double *)projectconfig_var_addr(nullptr, index);
+        timeDisplayFormatter_.Init(timeModePtr_, timeMode2Ptr_, measOffsPtr_, timeOffsPtr_);
     }
     
     void Shutdown()
@@ -2023,6 +3032,11 @@ public:
         fxParamsDisplay_ = false;
         surfaceInDisplay_ = false;
         surfaceOutDisplay_ = false;
+        traceCapture_ = false;
+        isReplaying_ = false;
+        CSIRecorder::Stop();
+        CSITrace::Shutdown();
+        OSCInputThread::Shutdown();
        
         // GAW -- IMPORTANT
         // We want to stop polling and zero out all Widgets before shutting down
@@ -2034,8 +3048,40 @@ public:
     
     void Init();
 
-    void ToggleSurfaceInDisplay() { surfaceInDisplay_ = ! surfaceInDisplay_;  }
-    void ToggleSurfaceOutDisplay() { surfaceOutDisplay_ = ! surfaceOutDisplay_;  }
+    void ToggleSurfaceInDisplay() { surfaceInDisplay_ = ! surfaceInDisplay_; UpdateTrace(); }
+    void ToggleSurfaceOutDisplay() { surfaceOutDisplay_ = ! surfaceOutDisplay_; UpdateTrace(); }
+    void ToggleTraceCapture() { traceCapture_ = ! traceCapture_; UpdateTrace(); }
+    void ToggleProfiler()
+    {
+        isProfiling_ = ! isProfiling_;
+        CSIProfiler::SetEnabled(isProfiling_);
+        
+        if( ! isProfiling_)
+        {
+            map<const void*, string> actionNames;
+            
+            for(auto [name, action] : actions_)
+                actionNames[action] = name;
+            
+            CSIProfiler::Report(actionNames, string(DAW::GetResourcePath()) + "/CSI/Profile.json", string(DAW::GetResourcePath()) + "/CSI/ProfileBaseline.json");
+        }
+    }
+    
+    void ToggleInputRecording()
+    {
+        if(CSIRecorder::IsRecording())
+            CSIRecorder::Stop();
+        else
+            CSIRecorder::Start(string(DAW::GetResourcePath()) + "/CSI/Recording.csirec");
+    }
+    
+#ifdef CSI_HEADLESS_DAW
+    // Replays into the in-memory DAW model, never a live project
+    bool StartReplay(string filePath, bool asFastAsPossible);
+#endif
+    bool IsReplaying() { return isReplaying_; }
+    
+    void DumpTrace() { CSITrace::DumpToFile(string(DAW::GetResourcePath()) + "/CSI/Trace.txt"); }
     void ToggleFXParamsDisplay() { fxParamsDisplay_ = ! fxParamsDisplay_;  }
     void ToggleFXParamsWrite() { fxParamsWrite_ = ! fxParamsWrite_;  }
 
@@ -2051,6 +3097,9 @@ public:
     int *GetTimeMode2Ptr() { return timeMode2Ptr_; }
     int *GetMeasOffsPtr() { return measOffsPtr_; }
     double *GetTimeOffsPtr() { return timeOffsPtr_; }
+    TimeDisplayFormatter* GetTimeDisplayFormatter() { return &timeDisplayFormatter_; }
+    TrackAppearanceCache* GetTrackAppearances() { return &trackAppearances_; }
+    FXParamCache* GetFXParams() { return &fxParams_; }
    
     ActionContext GetActionContext(string actionName, Widget* widget, Zone* zone, vector<string> params)
     {
@@ -2068,16 +3117,30 @@ public:
     
     void OnTrackListChange()
     {
+        trackAppearances_.Clear();
+        fxParams_.Clear();
+        
         if(pages_.size() > 0)
             pages_[currentPageIndex_]->OnTrackListChange();
     }
     
+    void OnTrackTitleChange(MediaTrack *track)
+    {
+        trackAppearances_.OnTrackTitleChange(track);
+    }
+    
     void OnFXFocus(MediaTrack *track, int fxIndex)
     {
         if(pages_.size() > 0)
             pages_[currentPageIndex_]->OnFXFocus(track, fxIndex);
     }
     
+    void OnLastTouchedFX()
+    {
+        if(pages_.size() > 0)
+            pages_[currentPageIndex_]->OnLastTouchedFX();
+    }
+    
     void NextTimeDisplayMode()
     {
         int *tmodeptr = GetTimeMode2Ptr();
@@ -2123,6 +3186,8 @@ public:
         }
     }
     
+    Page* GetCurrentPage() { return pages_.size() > 0 ? pages_[currentPageIndex_] : nullptr; }
+    
     void GoToPage(string pageName)
     {
         for(int i = 0; i < pages_.size(); i++)
@@ -2148,6 +3213,8 @@ public:
     
     void TrackFXListChanged(MediaTrack* track)
     {
+        fxParams_.OnFXListChange(track);
+        
         for(auto & page : pages_)
             page->TrackFXListChanged(track);
         
@@ -2197,7 +3264,7 @@ public:
                     double smallstepOut = 0;
                     double largestepOut = 0;
                     bool istoggleOut = false;
-                    TrackFX_GetParameterStepSizes(track, i, j, &stepOut, &smallstepOut, &largestepOut, &istoggleOut);
+                    DAW::TrackFX_GetParameterStepSizes(track, i, j, &stepOut, &smallstepOut, &largestepOut, &istoggleOut);
 
                     DAW::ShowConsoleMsg(("\n\n" + to_string(j) + " - \"" + string(fxParamName) + "\"\t\t\t\t Step = " +  to_string(stepOut) + " Small Step = " + to_string(smallstepOut)  + " LargeStep = " + to_string(largestepOut)  + " Toggle Out = " + (istoggleOut == 0 ? "false" : "true")).c_str());
                     */
@@ -2227,16 +3294,16 @@ public:
             pages_[currentPageIndex_]->InitializeEuConWidgets(widgetInfoItems);
     }
     
-    void ReceiveEuConMessage(string oscAddress, double value)
+    void ReceiveEuConMessage(const char* address, double value)
     {
         if(pages_.size() > 0)
-            pages_[currentPageIndex_]->ReceiveEuConMessage(oscAddress, value);
+            pages_[currentPageIndex_]->ReceiveEuConMessage(address, value);
     }
     
-    void ReceiveEuConMessage(string oscAddress, string value)
+    void ReceiveEuConMessage(const char* address, const char* value)
     {
         if(pages_.size() > 0)
-            pages_[currentPageIndex_]->ReceiveEuConMessage(oscAddress, value);
+            pages_[currentPageIndex_]->ReceiveEuConMessage(address, value);
     }
     
     void ReceiveEuConGroupVisibilityChange(string groupName, int channelNumber, bool isVisible)
@@ -2263,8 +3330,19 @@ public:
     {
         //int start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
         
+        timeDisplayFormatter_.Invalidate();
+        trackAppearances_.Run();
+        fxParams_.Invalidate();
+        
+#ifdef CSI_HEADLESS_DAW
+        if(isReplaying_)
+            ReplayTick();
+#endif
+        
         if(shouldRun_ && pages_.size() > 0)
             pages_[currentPageIndex_]->Run();
+        
+        CSITrace::FlushToConsole();
         /*
          repeats++;
          
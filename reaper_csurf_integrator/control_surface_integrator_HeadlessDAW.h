@@ -0,0 +1,1345 @@
+//
+//  control_surface_integrator_HeadlessDAW.h
+//  reaper_csurf_integrator
+//
+//  In-memory stand-in for REAPER, compiled in place of the real DAW facade when CSI_HEADLESS_DAW is defined.
+//  It exposes the same static DAW interface, backed by a HeadlessDAW model with tracks, FX, sends, selection,
+//  transport and meters, plus fake midi_Input / midi_Output devices.
+//
+//  A headless build compiles control_surface_integrator.cpp without main.cpp and control_surface_integrator_ui.cpp.
+//  The host program supplies g_hwnd, g_reaper_plugin_info (nullptr) and the CSurfIntegrator methods, fills the model
+//  through HeadlessDAW::Get(), points SetResourcePath() at a folder containing a CSI tree, and drives Manager::Run().
+//
+
+#ifndef control_surface_integrator_HeadlessDAW_h
+#define control_surface_integrator_HeadlessDAW_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cctype>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <unordered_set>
+
+#include "control_surface_integrator_MCUEmulator.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessMidiEventList : public MIDI_eventlist
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    vector<unsigned char> buffer_; // packed MIDI_event_t records, each padded to a multiple of 4 bytes
+
+    static int GetRecordSize(int messageSize)
+    {
+        int size = (int)offsetof(MIDI_event_t, midi_message) + (messageSize > 4 ? messageSize : 4);
+        return (size + 3) & ~3;
+    }
+
+public:
+    virtual ~HeadlessMidiEventList() {}
+
+    virtual void AddItem(MIDI_event_t* evt) override
+    {
+        size_t position = buffer_.size();
+        buffer_.resize(position + GetRecordSize(evt->size));
+        memcpy(&buffer_[position], evt, offsetof(MIDI_event_t, midi_message) + evt->size);
+    }
+
+    virtual MIDI_event_t* EnumItems(int* bpos) override
+    {
+        if(*bpos < 0 || *bpos >= (int)buffer_.size())
+            return nullptr;
+
+        MIDI_event_t* evt = (MIDI_event_t*)&buffer_[*bpos];
+        *bpos += GetRecordSize(evt->size);
+        return evt;
+    }
+
+    virtual void DeleteItem(int bpos) override
+    {
+        if(bpos < 0 || bpos >= (int)buffer_.size())
+            return;
+
+        MIDI_event_t* evt = (MIDI_event_t*)&buffer_[bpos];
+        buffer_.erase(buffer_.begin() + bpos, buffer_.begin() + bpos + GetRecordSize(evt->size));
+    }
+
+    virtual int GetSize() override { return (int)buffer_.size(); }
+
+    virtual void Empty() override { buffer_.clear(); }
+
+    void Swap(HeadlessMidiEventList& other) { buffer_.swap(other.buffer_); }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessMidiInput : public midi_Input
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    WDL_Mutex mutex_;
+    HeadlessMidiEventList pending_;
+    HeadlessMidiEventList readBuffer_;
+    bool isRunning_ = false;
+
+public:
+    virtual ~HeadlessMidiInput() {}
+
+    virtual void start() override { isRunning_ = true; }
+    virtual void stop() override { isRunning_ = false; }
+    bool IsRunning() { return isRunning_; }
+
+    // Messages queued here become visible to the surface on the next SwapBufs, as with a real device
+    void QueueMessage(const unsigned char* message, int size, int frameOffset = 0)
+    {
+        unsigned char storage[sizeof(MIDI_event_t) + 256];
+
+        if(size < 0 || size > 256)
+            return;
+
+        MIDI_event_t* evt = (MIDI_event_t*)storage;
+        evt->frame_offset = frameOffset;
+        evt->size = size;
+        memcpy(evt->midi_message, message, size);
+
+        WDL_MutexLock lock(&mutex_);
+        pending_.AddItem(evt);
+    }
+
+    void QueueMessage(unsigned char status, unsigned char d1, unsigned char d2, int frameOffset = 0)
+    {
+        unsigned char message[3] = { status, d1, d2 };
+        QueueMessage(message, 3, frameOffset);
+    }
+
+    virtual void SwapBufs(unsigned int timestamp) override
+    {
+        WDL_MutexLock lock(&mutex_);
+        readBuffer_.Empty();
+        readBuffer_.Swap(pending_);
+    }
+
+    virtual MIDI_eventlist* GetReadBuf() override { return &readBuffer_; }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessMidiOutput : public midi_Output
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    HeadlessMidiEventList sent_;
+    int numMessagesSent_ = 0;
+    MCUEmulator* emulator_ = nullptr;
+
+public:
+    virtual ~HeadlessMidiOutput() {}
+
+    virtual void SendMsg(MIDI_event_t* msg, int frame_offset) override
+    {
+        sent_.AddItem(msg);
+        numMessagesSent_++;
+
+        if(emulator_ != nullptr)
+            emulator_->Consume(msg->midi_message, msg->size, chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    virtual void Send(unsigned char status, unsigned char d1, unsigned char d2, int frame_offset) override
+    {
+        MIDI_event_t evt;
+        evt.frame_offset = frame_offset;
+        evt.size = 3;
+        evt.midi_message[0] = status;
+        evt.midi_message[1] = d1;
+        evt.midi_message[2] = d2;
+        evt.midi_message[3] = 0;
+
+        SendMsg(&evt, frame_offset);
+    }
+
+    MIDI_eventlist* GetSentMessages() { return &sent_; }
+    int GetNumMessagesSent() { return numMessagesSent_; }
+    void ClearSentMessages() { sent_.Empty(); numMessagesSent_ = 0; }
+    void AttachEmulator(MCUEmulator* emulator) { emulator_ = emulator; } // not owned, nullptr detaches
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessInfo
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Typed storage for GetSetMediaTrackInfo / GetSetTrackSendInfo style parameters, the type comes from the prefix as in REAPER
+private:
+    map<string, bool, less<>> bools_;
+    map<string, int, less<>> ints_;
+    map<string, double, less<>> doubles_;
+
+    template<typename T> static T* GetSet(map<string, T, less<>>& values, const char* parmname, void* setNewValue)
+    {
+        auto it = values.find(parmname);
+
+        if(it == values.end())
+            it = values.emplace(parmname, T()).first;
+
+        if(setNewValue)
+            it->second = *(T*)setNewValue;
+
+        return &it->second;
+    }
+
+public:
+    void* GetSet(const char* parmname, void* setNewValue)
+    {
+        if(parmname[0] == 'B' && parmname[1] == '_')
+            return GetSet(bools_, parmname, setNewValue);
+        else if(parmname[0] == 'I' && parmname[1] == '_')
+            return GetSet(ints_, parmname, setNewValue);
+        else if(parmname[0] == 'D' && parmname[1] == '_')
+            return GetSet(doubles_, parmname, setNewValue);
+        else
+            return nullptr;
+    }
+
+    double GetValue(const char* parmname)
+    {
+        if(parmname[0] == 'B' && parmname[1] == '_')
+            return *GetSet(bools_, parmname, nullptr) ? 1.0 : 0.0;
+        else if(parmname[0] == 'I' && parmname[1] == '_')
+            return *GetSet(ints_, parmname, nullptr);
+        else if(parmname[0] == 'D' && parmname[1] == '_')
+            return *GetSet(doubles_, parmname, nullptr);
+        else
+            return 0.0;
+    }
+
+    void SetValue(const char* parmname, double value)
+    {
+        if(parmname[0] == 'B' && parmname[1] == '_')
+            *GetSet(bools_, parmname, nullptr) = value != 0.0;
+        else if(parmname[0] == 'I' && parmname[1] == '_')
+            *GetSet(ints_, parmname, nullptr) = (int)value;
+        else if(parmname[0] == 'D' && parmname[1] == '_')
+            *GetSet(doubles_, parmname, nullptr) = value;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct HeadlessSend
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    MediaTrack* source_ = nullptr;
+    MediaTrack* destination_ = nullptr;
+    HeadlessInfo info_;
+
+    HeadlessSend(MediaTrack* source, MediaTrack* destination) : source_(source), destination_(destination)
+    {
+        info_.SetValue("D_VOL", 1.0);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct HeadlessFXParam
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string name_;
+    double value_ = 0.0;
+    double minimum_ = 0.0;
+    double maximum_ = 1.0;
+    double step_ = 0.0;
+    bool isToggle_ = false;
+
+    HeadlessFXParam(string name) : name_(name) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct HeadlessFX
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string name_;
+    vector<HeadlessFXParam> params_;
+    map<string, string> namedConfigParams_;
+    bool isFloating_ = false;
+
+    HeadlessFX(string name) : name_(name) {}
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MediaTrack // completes the opaque REAPER type for headless builds
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    string name_;
+    HeadlessInfo info_;
+    vector<shared_ptr<HeadlessSend>> sends_;
+    vector<shared_ptr<HeadlessSend>> receives_;
+    vector<HeadlessFX> fx_;
+    map<string, unsigned int> groupMembership_;
+    double peaks_[2] = { 0.0, 0.0 };
+
+    MediaTrack(string name) : name_(name)
+    {
+        info_.SetValue("D_VOL", 1.0);
+        info_.SetValue("D_WIDTH", 1.0);
+        info_.SetValue("B_SHOWINMIXER", 1.0);
+        info_.SetValue("B_SHOWINTCP", 1.0);
+    }
+
+    vector<shared_ptr<HeadlessSend>>* GetSends(int category)
+    {
+        if(category == 0)
+            return &sends_;
+        else if(category < 0)
+            return &receives_;
+        else
+            return nullptr; // no hardware outputs in the model
+    }
+
+    HeadlessSend* GetSend(int category, int sendIndex)
+    {
+        vector<shared_ptr<HeadlessSend>>* sends = GetSends(category);
+
+        if(sends && sendIndex >= 0 && sendIndex < (int)sends->size())
+            return (*sends)[sendIndex].get();
+        else
+            return nullptr;
+    }
+
+    HeadlessFXParam* GetFXParam(int fx, int param)
+    {
+        if(fx >= 0 && fx < (int)fx_.size() && param >= 0 && param < (int)fx_[fx].params_.size())
+            return &fx_[fx].params_[param];
+        else
+            return nullptr;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessDAW
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    // Fader taper approximating REAPER's: slider 0..1000, 0 dB near 716, +12 dB at 1000
+    static constexpr double SliderMaxDB = 12.0;
+    static constexpr double SliderTaper = 4.139;
+
+    unique_ptr<MediaTrack> master_ = make_unique<MediaTrack>("MASTER");
+    vector<unique_ptr<MediaTrack>> tracks_;
+    unordered_set<const MediaTrack*> liveTracks_ = { master_.get() };
+    vector<MediaTrack*> mixerTracks_;
+    bool mixerTracksDirty_ = true;
+    MediaTrack* mixerScrollTrack_ = nullptr;
+
+    int playState_ = 0; // &1=playing, &2=paused, &4=recording
+    double playPosition_ = 0.0;
+    double cursorPosition_ = 0.0;
+    double tempo_ = 120.0;
+    int timeSignatureNumerator_ = 4;
+    int timeSignatureDenominator_ = 4;
+    double sampleRate_ = 48000.0;
+    int repeat_ = 0;
+    int globalAutomationOverride_ = -1;
+
+    int projectTimeMode_ = 0;
+    int projectTimeMode2_ = -1;
+    int projectMeasureOffset_ = 0;
+    double projectTimeOffset_ = 0.0;
+
+    // 1-based track numbers as REAPER reports them, 0 is the master
+    int focusedFXTrackNumber_ = 0;
+    int focusedFXIndex_ = -1;
+    int lastTouchedFXTrackNumber_ = 0;
+    int lastTouchedFXIndex_ = -1;
+    int lastTouchedFXParamIndex_ = -1;
+
+    map<string, int> namedCommands_;
+    map<int, int> toggleCommandStates_;
+    vector<int> executedCommands_;
+
+    string resourcePath_ = ".";
+    string iniFile_ = "reaper.ini";
+    map<string, map<string, string>> iniValues_;
+
+    string console_;
+    bool echoConsole_ = false;
+    
+    bool isLoggingWrites_ = false;
+    vector<string> writeLog_;
+
+    map<int, unique_ptr<HeadlessMidiInput>> midiInputs_;
+    map<int, unique_ptr<HeadlessMidiOutput>> midiOutputs_;
+
+    static HeadlessDAW& Get()
+    {
+        static HeadlessDAW daw;
+        return daw;
+    }
+
+    MediaTrack* AddTrack(string name)
+    {
+        tracks_.push_back(make_unique<MediaTrack>(name));
+        liveTracks_.insert(tracks_.back().get());
+        mixerTracksDirty_ = true;
+        return tracks_.back().get();
+    }
+
+    void RemoveTrack(MediaTrack* track)
+    {
+        for(auto it = tracks_.begin(); it != tracks_.end(); ++it)
+        {
+            if(it->get() != track)
+                continue;
+
+            for(auto& other : tracks_)
+            {
+                for(auto send = other->sends_.begin(); send != other->sends_.end(); )
+                    send = (*send)->destination_ == track ? other->sends_.erase(send) : send + 1;
+
+                for(auto receive = other->receives_.begin(); receive != other->receives_.end(); )
+                    receive = (*receive)->source_ == track ? other->receives_.erase(receive) : receive + 1;
+            }
+
+            if(mixerScrollTrack_ == track)
+                mixerScrollTrack_ = nullptr;
+
+            liveTracks_.erase(track);
+            tracks_.erase(it);
+            mixerTracksDirty_ = true;
+            return;
+        }
+    }
+
+    void RemoveAllTracks()
+    {
+        while( ! tracks_.empty())
+            RemoveTrack(tracks_.back().get());
+    }
+
+    HeadlessFX* AddFX(MediaTrack* track, string name, int numParams)
+    {
+        track->fx_.push_back(HeadlessFX(name));
+
+        for(int i = 0; i < numParams; i++)
+            track->fx_.back().params_.push_back(HeadlessFXParam("Param " + to_string(i + 1)));
+
+        return &track->fx_.back();
+    }
+
+    HeadlessSend* AddSend(MediaTrack* source, MediaTrack* destination)
+    {
+        shared_ptr<HeadlessSend> send = make_shared<HeadlessSend>(source, destination);
+        source->sends_.push_back(send);
+        destination->receives_.push_back(send);
+        return send.get();
+    }
+
+    HeadlessMidiInput* GetMidiInput(int device)
+    {
+        if(midiInputs_.count(device) < 1)
+            midiInputs_[device] = make_unique<HeadlessMidiInput>();
+
+        return midiInputs_[device].get();
+    }
+
+    HeadlessMidiOutput* GetMidiOutput(int device)
+    {
+        if(midiOutputs_.count(device) < 1)
+            midiOutputs_[device] = make_unique<HeadlessMidiOutput>();
+
+        return midiOutputs_[device].get();
+    }
+
+    void SetResourcePath(string resourcePath) { resourcePath_ = resourcePath; }
+
+    bool IsLive(const MediaTrack* track) { return track != nullptr && liveTracks_.count(track) > 0; }
+
+    int GetTrackNumber(const MediaTrack* track) // 0 is the master, -1 when not a track
+    {
+        if(track == master_.get())
+            return 0;
+
+        for(int i = 0; i < (int)tracks_.size(); i++)
+            if(tracks_[i].get() == track)
+                return i + 1;
+
+        return -1;
+    }
+
+    MediaTrack* GetTrackFromNumber(int trackNumber) // 0 is the master
+    {
+        if(trackNumber == 0)
+            return master_.get();
+        else if(trackNumber > 0 && trackNumber <= (int)tracks_.size())
+            return tracks_[trackNumber - 1].get();
+        else
+            return nullptr;
+    }
+
+    vector<MediaTrack*>& GetMixerTracks()
+    {
+        if(mixerTracksDirty_)
+        {
+            mixerTracks_.clear();
+
+            for(auto& track : tracks_)
+                if(track->info_.GetValue("B_SHOWINMIXER") != 0.0)
+                    mixerTracks_.push_back(track.get());
+
+            mixerTracksDirty_ = false;
+        }
+
+        return mixerTracks_;
+    }
+
+    template<typename F> void ForEachTrack(F f)
+    {
+        for(auto& track : tracks_)
+            f(track.get());
+    }
+};
+
+inline void ShowConsoleMsg(const char* msg)
+{
+    HeadlessDAW::Get().console_ += msg;
+
+    if(HeadlessDAW::Get().echoConsole_)
+        fputs(msg, stdout);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DAW
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    static HeadlessDAW& Model() { return HeadlessDAW::Get(); }
+
+    static bool CopyString(const string& value, char* buf, int buf_sz)
+    {
+        if(buf_sz > 0)
+            snprintf(buf, buf_sz, "%s", value.c_str());
+
+        return true;
+    }
+
+    static bool ClearString(char* buf, int buf_sz)
+    {
+        if(buf_sz > 0)
+            buf[0] = 0;
+
+        return false;
+    }
+
+    // REAPER semantics for the CSurf_On*Change toggles: <0 toggles, otherwise sets
+    static bool SetOrToggle(MediaTrack* track, const char* parmname, int value)
+    {
+        double newValue = value < 0 ? (track->info_.GetValue(parmname) != 0.0 ? 0.0 : 1.0) : value;
+        track->info_.SetValue(parmname, newValue);
+        LogWrite("CSurf_OnChange", parmname, track, -1, -1, newValue);
+        return newValue != 0.0;
+    }
+
+    static double Clamp(double value, double minimum, double maximum) { return value < minimum ? minimum : (value > maximum ? maximum : value); }
+
+    static void LogWrite(const char* api, const char* parmname, MediaTrack* track, int index, int subIndex, double value)
+    {
+        if( ! Model().isLoggingWrites_)
+            return;
+
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer), "%s %s track=%d index=%d sub=%d value=%.6g", api, parmname, Model().GetTrackNumber(track), index, subIndex, value);
+        Model().writeLog_.push_back(buffer);
+    }
+
+public:
+    static void SetWriteLogging(bool isLogging)
+    {
+        if(isLogging && ! Model().isLoggingWrites_)
+            Model().writeLog_.clear();
+
+        Model().isLoggingWrites_ = isLogging;
+    }
+
+    static void DumpWriteLog(string filePath)
+    {
+        FILE* file = fopen(filePath.c_str(), "w");
+
+        if(file == nullptr)
+            return;
+
+        for(auto &line : Model().writeLog_)
+            fprintf(file, "%s\n", line.c_str());
+
+        fclose(file);
+    }
+
+    static void SwapBufsPrecise(midi_Input* midiInput)
+    {
+        COUNT_DAW_CALL("SwapBufsPrecise");
+        midiInput->SwapBufsPrecise((unsigned int)GetCurrentNumberOfMilliseconds(), GetCurrentNumberOfMilliseconds() / 1000.0);
+    }
+
+    static double GetCurrentNumberOfMilliseconds()
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void MarkProjectDirty(ReaProject* proj) { COUNT_DAW_CALL("MarkProjectDirty"); }
+
+    static int plugin_register(const char* name, void* infostruct) { COUNT_DAW_CALL("plugin_register"); return 1; }
+
+    static int projectconfig_var_getoffs(const char* name, int* szOut)
+    {
+        COUNT_DAW_CALL("projectconfig_var_getoffs");
+        static const char* const names[] = { "projtimemode", "projtimemode2", "projmeasoffs", "projtimeoffs" };
+
+        for(int i = 0; i < 4; i++)
+        {
+            if( ! strcmp(name, names[i]))
+            {
+                if(szOut)
+                    *szOut = i == 3 ? sizeof(double) : sizeof(int);
+
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    static void* projectconfig_var_addr(ReaProject* proj, int idx)
+    {
+        COUNT_DAW_CALL("projectconfig_var_addr");
+        switch(idx)
+        {
+            case 1: return &Model().projectTimeMode_;
+            case 2: return &Model().projectTimeMode2_;
+            case 3: return &Model().projectMeasureOffset_;
+            case 4: return &Model().projectTimeOffset_;
+            default: return nullptr;
+        }
+    }
+
+    static double SLIDER2DB(double y)
+    {
+        COUNT_DAW_CALL("SLIDER2DB");
+        if(y <= 0.0)
+            return -150.0;
+
+        double db = HeadlessDAW::SliderMaxDB + 20.0 * HeadlessDAW::SliderTaper * log10(y / 1000.0);
+        return db < -150.0 ? -150.0 : db;
+    }
+
+    static double DB2SLIDER(double x)
+    {
+        COUNT_DAW_CALL("DB2SLIDER");
+        if(x <= -150.0)
+            return 0.0;
+
+        return 1000.0 * pow(10.0, (x - HeadlessDAW::SliderMaxDB) / (20.0 * HeadlessDAW::SliderTaper));
+    }
+
+    static const char* get_ini_file() { COUNT_DAW_CALL("get_ini_file"); return Model().iniFile_.c_str(); }
+
+    static DWORD GetPrivateProfileString(const char *appname, const char *keyname, const char *def, char *ret, int retsize, const char *fn)
+    {
+        COUNT_DAW_CALL("GetPrivateProfileString");
+        HeadlessDAW& model = Model();
+        string value = def ? def : "";
+
+        if(model.iniValues_.count(appname) > 0 && model.iniValues_[appname].count(keyname) > 0)
+            value = model.iniValues_[appname][keyname];
+
+        CopyString(value, ret, retsize);
+        return retsize > 0 ? (DWORD)strlen(ret) : 0;
+    }
+
+    static const char* GetResourcePath() { COUNT_DAW_CALL("GetResourcePath"); return Model().resourcePath_.c_str(); }
+
+    static int NamedCommandLookup(const char* command_name)
+    {
+        COUNT_DAW_CALL("NamedCommandLookup");
+        if(command_name == nullptr || command_name[0] == 0)
+            return 0;
+
+        if(isdigit((unsigned char)command_name[0]))
+            return atoi(command_name);
+
+        map<string, int>& namedCommands = Model().namedCommands_;
+
+        if(namedCommands.count(command_name) < 1)
+            namedCommands[command_name] = 100000 + (int)namedCommands.size();
+
+        return namedCommands[command_name];
+    }
+
+    static void SendCommandMessage(WPARAM wparam)
+    {
+        COUNT_DAW_CALL("SendCommandMessage");
+        int commandId = (int)wparam;
+        Model().executedCommands_.push_back(commandId);
+        LogWrite("SendCommandMessage", "", nullptr, commandId, -1, 0.0);
+
+        if(Model().toggleCommandStates_.count(commandId) > 0)
+            Model().toggleCommandStates_[commandId] = ! Model().toggleCommandStates_[commandId];
+    }
+
+    static void PostCommandMessage(WPARAM wparam) { COUNT_DAW_CALL("PostCommandMessage"); SendCommandMessage(wparam); }
+
+    static void DestroyWindow(HWND hwnd) { COUNT_DAW_CALL("DestroyWindow"); }
+
+    static int GetToggleCommandState(int commandId)
+    {
+        COUNT_DAW_CALL("GetToggleCommandState");
+        if(Model().toggleCommandStates_.count(commandId) > 0)
+            return Model().toggleCommandStates_[commandId];
+        else
+            return -1;
+    }
+
+    static void ShowConsoleMsg(const char* msg) { COUNT_DAW_CALL("ShowConsoleMsg"); ::ShowConsoleMsg(msg); }
+
+    static midi_Input* CreateMIDIInput(int dev) { COUNT_DAW_CALL("CreateMIDIInput"); return Model().GetMidiInput(dev); }
+
+    static midi_Output* CreateMIDIOutput(int dev, bool streamMode, int* msoffset100) { COUNT_DAW_CALL("CreateMIDIOutput"); return Model().GetMidiOutput(dev); }
+
+    static bool AnyTrackSolo(ReaProject* proj)
+    {
+        COUNT_DAW_CALL("AnyTrackSolo");
+        for(auto& track : Model().tracks_)
+            if(track->info_.GetValue("I_SOLO") != 0.0)
+                return true;
+
+        return false;
+    }
+
+    static void SoloAllTracks(int solo)
+    {
+        COUNT_DAW_CALL("SoloAllTracks");
+        LogWrite("SoloAllTracks", "", nullptr, -1, -1, solo);
+        Model().ForEachTrack([solo](MediaTrack* track) { track->info_.SetValue("I_SOLO", solo); });
+    }
+
+    static void SetAutomationMode(int mode, bool onlySel)
+    {
+        COUNT_DAW_CALL("SetAutomationMode");
+        LogWrite("SetAutomationMode", "", nullptr, onlySel, -1, mode);
+        Model().ForEachTrack([mode, onlySel](MediaTrack* track)
+        {
+            if( ! onlySel || track->info_.GetValue("I_SELECTED") != 0.0)
+                track->info_.SetValue("I_AUTOMODE", mode);
+        });
+    }
+
+    static int GetGlobalAutomationOverride() { COUNT_DAW_CALL("GetGlobalAutomationOverride"); return Model().globalAutomationOverride_; }
+
+    static void SetGlobalAutomationOverride(int mode) { COUNT_DAW_CALL("SetGlobalAutomationOverride"); LogWrite("SetGlobalAutomationOverride", "", nullptr, -1, -1, mode); Model().globalAutomationOverride_ = mode; }
+
+    static int GetFocusedFX(int* tracknumberOut, int* itemnumberOut, int* fxnumberOut)
+    {
+        COUNT_DAW_CALL("GetFocusedFX");
+        HeadlessDAW& model = Model();
+
+        if(tracknumberOut)
+            *tracknumberOut = model.focusedFXTrackNumber_;
+        if(itemnumberOut)
+            *itemnumberOut = -1;
+        if(fxnumberOut)
+            *fxnumberOut = model.focusedFXIndex_;
+
+        return model.focusedFXIndex_ >= 0 ? 1 : 0;
+    }
+
+    static bool GetLastTouchedFX(int* tracknumberOut, int* fxnumberOut, int* paramnumberOut)
+    {
+        COUNT_DAW_CALL("GetLastTouchedFX");
+        HeadlessDAW& model = Model();
+
+        if(tracknumberOut)
+            *tracknumberOut = model.lastTouchedFXTrackNumber_;
+        if(fxnumberOut)
+            *fxnumberOut = model.lastTouchedFXIndex_;
+        if(paramnumberOut)
+            *paramnumberOut = model.lastTouchedFXParamIndex_;
+
+        return model.lastTouchedFXIndex_ >= 0;
+    }
+
+    static void CSurf_OnArrow(int whichdir, bool wantzoom) { COUNT_DAW_CALL("CSurf_OnArrow"); }
+
+    static void CSurf_OnRew(int seekplay) { COUNT_DAW_CALL("CSurf_OnRew"); LogWrite("CSurf_OnRew", "", nullptr, -1, -1, seekplay); Model().cursorPosition_ = Model().cursorPosition_ > 1.0 ? Model().cursorPosition_ - 1.0 : 0.0; }
+
+    static void CSurf_OnFwd(int seekplay) { COUNT_DAW_CALL("CSurf_OnFwd"); LogWrite("CSurf_OnFwd", "", nullptr, -1, -1, seekplay); Model().cursorPosition_ += 1.0; }
+
+    static void CSurf_OnStop() { COUNT_DAW_CALL("CSurf_OnStop"); LogWrite("CSurf_OnStop", "", nullptr, -1, -1, 0.0); Model().playState_ = 0; Model().playPosition_ = Model().cursorPosition_; }
+
+    static void CSurf_OnPlay() { COUNT_DAW_CALL("CSurf_OnPlay"); LogWrite("CSurf_OnPlay", "", nullptr, -1, -1, 0.0); Model().playState_ = 1; }
+
+    static void CSurf_OnRecord() { COUNT_DAW_CALL("CSurf_OnRecord"); LogWrite("CSurf_OnRecord", "", nullptr, -1, -1, 0.0); Model().playState_ = (Model().playState_ & 4) ? 0 : 5; }
+
+    static int GetPlayState() { COUNT_DAW_CALL("GetPlayState"); return Model().playState_; }
+
+    static double GetPlayPosition() { COUNT_DAW_CALL("GetPlayPosition"); return Model().playPosition_; }
+
+    static double GetCursorPosition() { COUNT_DAW_CALL("GetCursorPosition"); return Model().cursorPosition_; }
+
+    static void format_timestr_pos(double tpos, char* buf, int buf_sz, int modeoverride)
+    {
+        COUNT_DAW_CALL("format_timestr_pos");
+        HeadlessDAW& model = Model();
+
+        if(buf_sz <= 0)
+            return;
+
+        if(modeoverride < 0)
+            modeoverride = model.projectTimeMode_;
+
+        switch(modeoverride)
+        {
+            case 1:
+            case 2:
+            {
+                double beats = tpos * model.tempo_ / 60.0;
+                int measure = (int)(beats / model.timeSignatureNumerator_);
+                double beatInMeasure = beats - measure * model.timeSignatureNumerator_;
+
+                if(modeoverride == 2)
+                    snprintf(buf, buf_sz, "%d.%d.%02d", measure + 1 + model.projectMeasureOffset_, (int)beatInMeasure + 1, (int)((beatInMeasure - (int)beatInMeasure) * 100.0));
+                else
+                    snprintf(buf, buf_sz, "%d.%d.%02d / %d:%06.3f", measure + 1 + model.projectMeasureOffset_, (int)beatInMeasure + 1, (int)((beatInMeasure - (int)beatInMeasure) * 100.0), (int)(tpos / 60.0), fmod(tpos, 60.0));
+                break;
+            }
+
+            case 3:
+                snprintf(buf, buf_sz, "%.3f", tpos);
+                break;
+
+            case 4:
+                snprintf(buf, buf_sz, "%lld", (long long)(tpos * model.sampleRate_));
+                break;
+
+            case 5:
+            {
+                int totalFrames = (int)(tpos * 30.0);
+                snprintf(buf, buf_sz, "%02d:%02d:%02d:%02d", totalFrames / 108000, (totalFrames / 1800) % 60, (totalFrames / 30) % 60, totalFrames % 30);
+                break;
+            }
+
+            default:
+                snprintf(buf, buf_sz, "%d:%06.3f", (int)(tpos / 60.0), fmod(tpos, 60.0));
+                break;
+        }
+    }
+
+    static double TimeMap_curFrameRate(ReaProject* proj, bool* dropFrameOutOptional)
+    {
+        COUNT_DAW_CALL("TimeMap_curFrameRate");
+
+        if(dropFrameOutOptional)
+            *dropFrameOutOptional = false;
+
+        return 30.0; // format_timestr_pos shows 30 fps frames
+    }
+
+    static double TimeMap2_timeToBeats(ReaProject* proj, double tpos, int* measuresOutOptional, int* cmlOutOptional, double* fullbeatsOutOptional, int* cdenomOutOptional)
+    {
+        COUNT_DAW_CALL("TimeMap2_timeToBeats");
+        HeadlessDAW& model = Model();
+        double beats = tpos * model.tempo_ / 60.0;
+        int measures = (int)(beats / model.timeSignatureNumerator_);
+
+        if(measuresOutOptional)
+            *measuresOutOptional = measures;
+        if(cmlOutOptional)
+            *cmlOutOptional = model.timeSignatureNumerator_;
+        if(fullbeatsOutOptional)
+            *fullbeatsOutOptional = beats;
+        if(cdenomOutOptional)
+            *cdenomOutOptional = model.timeSignatureDenominator_;
+
+        return beats - measures * model.timeSignatureNumerator_;
+    }
+
+    static int CSurf_NumTracks(bool mcpView) { COUNT_DAW_CALL("CSurf_NumTracks"); return mcpView ? (int)Model().GetMixerTracks().size() : (int)Model().tracks_.size(); };
+
+    static MediaTrack* CSurf_TrackFromID(int idx, bool mcpView)
+    {
+        COUNT_DAW_CALL("CSurf_TrackFromID");
+        if(idx == 0 || ! mcpView)
+            return Model().GetTrackFromNumber(idx);
+
+        vector<MediaTrack*>& mixerTracks = Model().GetMixerTracks();
+
+        if(idx > 0 && idx <= (int)mixerTracks.size())
+            return mixerTracks[idx - 1];
+        else
+            return nullptr;
+    }
+
+    static int GetSetRepeatEx(ReaProject* proj, int val)
+    {
+        COUNT_DAW_CALL("GetSetRepeatEx");
+        if(val >= 0)
+        {
+            LogWrite("GetSetRepeatEx", "", nullptr, -1, -1, val);
+            Model().repeat_ = val > 1 ? ! Model().repeat_ : val;
+        }
+
+        return Model().repeat_;
+    }
+
+    static MediaTrack* GetMasterTrack(ReaProject* proj) { COUNT_DAW_CALL("GetMasterTrack"); return Model().master_.get(); };
+
+    static int CountSelectedTracks(ReaProject* proj)
+    {
+        COUNT_DAW_CALL("CountSelectedTracks");
+        int count = Model().master_->info_.GetValue("I_SELECTED") != 0.0 ? 1 : 0;
+
+        for(auto& track : Model().tracks_)
+            if(track->info_.GetValue("I_SELECTED") != 0.0)
+                count++;
+
+        return count;
+    }
+
+    // There is no color chooser dialog headless, behaves as if the user cancelled
+    static int GR_SelectColor(HWND hwnd, int* colorOut) { COUNT_DAW_CALL("GR_SelectColor"); return 0; }
+
+    static void ColorFromNative(int col, int* rOut, int* gOut, int* bOut)
+    {
+        COUNT_DAW_CALL("ColorFromNative");
+        *rOut = col & 0xff;
+        *gOut = (col >> 8) & 0xff;
+        *bOut = (col >> 16) & 0xff;
+    }
+
+    static int ColorToNative(int r, int g, int b) { COUNT_DAW_CALL("ColorToNative"); return (r & 0xff) | ((g & 0xff) << 8) | ((b & 0xff) << 16); }
+
+    static bool ValidateTrackPtr(MediaTrack* track) { COUNT_DAW_CALL("ValidateTrackPtr"); return Model().IsLive(track); }
+
+    // FX windows are never created headless, the engine only tracks the handle to close it later
+    static HWND TrackFX_GetFloatingWindow(MediaTrack* track, int index) { COUNT_DAW_CALL("TrackFX_GetFloatingWindow"); return nullptr; }
+
+    static void TrackFX_Show(MediaTrack* track, int index, int showFlag)
+    {
+        COUNT_DAW_CALL("TrackFX_Show");
+        LogWrite("TrackFX_Show", "", track, index, -1, showFlag);
+
+        if(Model().IsLive(track) && index >= 0 && index < (int)track->fx_.size() && (showFlag == 2 || showFlag == 3))
+            track->fx_[index].isFloating_ = showFlag == 3;
+    }
+
+    static int TrackFX_GetCount(MediaTrack* track)
+    {
+        COUNT_DAW_CALL("TrackFX_GetCount");
+        if(Model().IsLive(track))
+            return (int)track->fx_.size();
+        else
+            return 0;
+    }
+
+    static bool TrackFX_GetFXName(MediaTrack* track, int fx, char* buf, int buf_sz)
+    {
+        COUNT_DAW_CALL("TrackFX_GetFXName");
+        if(Model().IsLive(track) && fx >= 0 && fx < (int)track->fx_.size())
+            return CopyString(track->fx_[fx].name_, buf, buf_sz);
+        else
+            return ClearString(buf, buf_sz);
+    }
+
+    static bool TrackFX_GetNamedConfigParm(MediaTrack* track, int fx, const char* parmname, char* buf, int buf_sz)
+    {
+        COUNT_DAW_CALL("TrackFX_GetNamedConfigParm");
+        if(Model().IsLive(track) && fx >= 0 && fx < (int)track->fx_.size() && track->fx_[fx].namedConfigParams_.count(parmname) > 0)
+            return CopyString(track->fx_[fx].namedConfigParams_[parmname], buf, buf_sz);
+        else
+            return ClearString(buf, buf_sz);
+    }
+
+    static bool TrackFX_GetParameterStepSizes(MediaTrack* track, int fx, int param, double* stepOut, double* smallstepOut, double* largestepOut, bool* istoggleOut)
+    {
+        COUNT_DAW_CALL("TrackFX_GetParameterStepSizes");
+        HeadlessFXParam* fxParam = Model().IsLive(track) ? track->GetFXParam(fx, param) : nullptr;
+
+        if(fxParam == nullptr || (fxParam->step_ == 0.0 && ! fxParam->isToggle_))
+            return false;
+
+        *stepOut = fxParam->step_;
+        *smallstepOut = fxParam->step_;
+        *largestepOut = fxParam->step_;
+        *istoggleOut = fxParam->isToggle_;
+        return true;
+    }
+
+    static int TrackFX_GetNumParams(MediaTrack* track, int fx)
+    {
+        COUNT_DAW_CALL("TrackFX_GetNumParams");
+        if(Model().IsLive(track) && fx >= 0 && fx < (int)track->fx_.size())
+            return (int)track->fx_[fx].params_.size();
+        else
+            return 0;
+    }
+
+    static bool TrackFX_GetParamName(MediaTrack* track, int fx, int param, char* buf, int buf_sz)
+    {
+        COUNT_DAW_CALL("TrackFX_GetParamName");
+        HeadlessFXParam* fxParam = Model().IsLive(track) ? track->GetFXParam(fx, param) : nullptr;
+
+        if(fxParam)
+            return CopyString(fxParam->name_, buf, buf_sz);
+        else
+            return ClearString(buf, buf_sz);
+    }
+
+    static bool TrackFX_GetFormattedParamValue(MediaTrack* track, int fx, int param, char* buf, int buf_sz)
+    {
+        COUNT_DAW_CALL("TrackFX_GetFormattedParamValue");
+        HeadlessFXParam* fxParam = Model().IsLive(track) ? track->GetFXParam(fx, param) : nullptr;
+
+        if(fxParam == nullptr)
+            return ClearString(buf, buf_sz);
+
+        if(buf_sz > 0)
+            snprintf(buf, buf_sz, "%.2f", fxParam->value_);
+
+        return true;
+    }
+
+    static double TrackFX_GetParam(MediaTrack* track, int fx, int param, double* minvalOut, double* maxvalOut)
+    {
+        COUNT_DAW_CALL("TrackFX_GetParam");
+        HeadlessFXParam* fxParam = Model().IsLive(track) ? track->GetFXParam(fx, param) : nullptr;
+
+        if(fxParam == nullptr)
+            return 0.0;
+
+        if(minvalOut)
+            *minvalOut = fxParam->minimum_;
+        if(maxvalOut)
+            *maxvalOut = fxParam->maximum_;
+
+        return fxParam->value_;
+    }
+
+    static bool TrackFX_SetParam(MediaTrack* track, int fx, int param, double val)
+    {
+        COUNT_DAW_CALL("TrackFX_SetParam");
+        HeadlessFXParam* fxParam = Model().IsLive(track) ? track->GetFXParam(fx, param) : nullptr;
+
+        if(fxParam == nullptr)
+            return false;
+
+        fxParam->value_ = Clamp(val, fxParam->minimum_, fxParam->maximum_);
+        LogWrite("TrackFX_SetParam", "", track, fx, param, fxParam->value_);
+        return true;
+    }
+
+    static bool GetTrackName(MediaTrack* track, char* buf, int buf_sz)
+    {
+        COUNT_DAW_CALL("GetTrackName");
+        if( ! Model().IsLive(track))
+            return ClearString(buf, buf_sz);
+
+        if(track->name_ != "" || track == Model().master_.get())
+            return CopyString(track->name_, buf, buf_sz);
+
+        for(int i = 0; i < (int)Model().tracks_.size(); i++)
+            if(Model().tracks_[i].get() == track)
+                return CopyString("Track " + to_string(i + 1), buf, buf_sz);
+
+        return ClearString(buf, buf_sz);
+    }
+
+    static double GetMediaTrackInfo_Value(MediaTrack* track, const char* parmname)
+    {
+        COUNT_DAW_CALL("GetMediaTrackInfo_Value");
+        if(Model().IsLive(track))
+            return track->info_.GetValue(parmname);
+        else
+            return 0.0;
+    }
+
+    static double GetTrackSendInfo_Value(MediaTrack* track, int category, int send_index, const char* parmname)
+    {
+        COUNT_DAW_CALL("GetTrackSendInfo_Value");
+        HeadlessSend* send = Model().IsLive(track) ? track->GetSend(category, send_index) : nullptr;
+
+        if(send)
+            return send->info_.GetValue(parmname);
+        else
+            return 0.0;
+    }
+
+    static void* GetSetTrackSendInfo(MediaTrack* track, int category, int send_index, const char* parmname, void* setNewValue)
+    {
+        COUNT_DAW_CALL("GetSetTrackSendInfo");
+        HeadlessSend* send = Model().IsLive(track) ? track->GetSend(category, send_index) : nullptr;
+
+        if(send == nullptr)
+            return nullptr;
+        else if( ! strcmp(parmname, "P_DESTTRACK"))
+            return send->destination_;
+        else if( ! strcmp(parmname, "P_SRCTRACK"))
+            return send->source_;
+
+        void* value = send->info_.GetSet(parmname, setNewValue);
+
+        if(setNewValue)
+            LogWrite("GetSetTrackSendInfo", parmname, track, category, send_index, send->info_.GetValue(parmname));
+
+        return value;
+    }
+
+    static void* GetSetMediaTrackInfo(MediaTrack* track, const char* parmname, void* setNewValue)
+    {
+        COUNT_DAW_CALL("GetSetMediaTrackInfo");
+        if( ! Model().IsLive(track))
+            return nullptr;
+
+        if( ! strcmp(parmname, "P_NAME"))
+        {
+            if(setNewValue)
+            {
+                track->name_ = (const char*)setNewValue;
+                LogWrite("GetSetMediaTrackInfo", parmname, track, -1, -1, 0.0);
+            }
+
+            return &track->name_[0];
+        }
+
+        if(setNewValue && ! strcmp(parmname, "B_SHOWINMIXER"))
+            Model().mixerTracksDirty_ = true;
+
+        void* value = track->info_.GetSet(parmname, setNewValue);
+
+        if(setNewValue)
+            LogWrite("GetSetMediaTrackInfo", parmname, track, -1, -1, track->info_.GetValue(parmname));
+
+        return value;
+    }
+
+    static unsigned int GetSetTrackGroupMembership(MediaTrack* track, const char* groupname, unsigned int setmask, unsigned int setvalue)
+    {
+        COUNT_DAW_CALL("GetSetTrackGroupMembership");
+        if( ! Model().IsLive(track))
+            return 0;
+
+        unsigned int& membership = track->groupMembership_[groupname];
+        unsigned int previous = membership;
+        membership = (membership & ~setmask) | (setvalue & setmask);
+
+        if(setmask != 0)
+            LogWrite("GetSetTrackGroupMembership", groupname, track, -1, -1, membership);
+
+        return previous;
+    }
+
+    static double CSurf_OnVolumeChange(MediaTrack* track, double volume, bool relative)
+    {
+        COUNT_DAW_CALL("CSurf_OnVolumeChange");
+        if( ! Model().IsLive(track))
+            return 0.0;
+
+        double newVolume = relative ? track->info_.GetValue("D_VOL") + volume : volume;
+        track->info_.SetValue("D_VOL", newVolume < 0.0 ? 0.0 : newVolume);
+        LogWrite("CSurf_OnVolumeChange", "", track, -1, -1, track->info_.GetValue("D_VOL"));
+        return track->info_.GetValue("D_VOL");
+    }
+
+    static double CSurf_OnPanChange(MediaTrack* track, double pan, bool relative)
+    {
+        COUNT_DAW_CALL("CSurf_OnPanChange");
+        if( ! Model().IsLive(track))
+            return 0.0;
+
+        track->info_.SetValue("D_PAN", Clamp(relative ? track->info_.GetValue("D_PAN") + pan : pan, -1.0, 1.0));
+        LogWrite("CSurf_OnPanChange", "", track, -1, -1, track->info_.GetValue("D_PAN"));
+        return track->info_.GetValue("D_PAN");
+    }
+
+    static bool CSurf_OnMuteChange(MediaTrack* track, int mute)
+    {
+        COUNT_DAW_CALL("CSurf_OnMuteChange");
+        if(Model().IsLive(track))
+            return SetOrToggle(track, "B_MUTE", mute);
+        else
+            return false;
+    }
+
+    static bool GetTrackUIMute(MediaTrack* track, bool* muteOut)
+    {
+        COUNT_DAW_CALL("GetTrackUIMute");
+        if( ! Model().IsLive(track))
+            return false;
+
+        *muteOut = track->info_.GetValue("B_MUTE") != 0.0;
+        return true;
+    }
+
+    static bool GetTrackUIVolPan(MediaTrack* track, double* volumeOut, double* panOut)
+    {
+        COUNT_DAW_CALL("GetTrackUIVolPan");
+        if( ! Model().IsLive(track))
+            return false;
+
+        *volumeOut = track->info_.GetValue("D_VOL");
+        *panOut = track->info_.GetValue("D_PAN");
+        return true;
+    }
+
+    static void CSurf_SetSurfaceVolume(MediaTrack* track, double volume, IReaperControlSurface* ignoresurf) { COUNT_DAW_CALL("CSurf_SetSurfaceVolume"); }
+
+    static double CSurf_OnSendVolumeChange(MediaTrack* track, int sendIndex, double volume, bool relative)
+    {
+        COUNT_DAW_CALL("CSurf_OnSendVolumeChange");
+        HeadlessSend* send = Model().IsLive(track) ? track->GetSend(0, sendIndex) : nullptr;
+
+        if(send == nullptr)
+            return 0.0;
+
+        double newVolume = relative ? send->info_.GetValue("D_VOL") + volume : volume;
+        send->info_.SetValue("D_VOL", newVolume < 0.0 ? 0.0 : newVolume);
+        LogWrite("CSurf_OnSendVolumeChange", "", track, sendIndex, -1, send->info_.GetValue("D_VOL"));
+        return send->info_.GetValue("D_VOL");
+    }
+
+    static double CSurf_OnSendPanChange(MediaTrack* track, int send_index, double pan, bool relative)
+    {
+        COUNT_DAW_CALL("CSurf_OnSendPanChange");
+        HeadlessSend* send = Model().IsLive(track) ? track->GetSend(0, send_index) : nullptr;
+
+        if(send == nullptr)
+            return 0.0;
+
+        send->info_.SetValue("D_PAN", Clamp(relative ? send->info_.GetValue("D_PAN") + pan : pan, -1.0, 1.0));
+        LogWrite("CSurf_OnSendPanChange", "", track, send_index, -1, send->info_.GetValue("D_PAN"));
+        return send->info_.GetValue("D_PAN");
+    }
+
+    static int GetTrackNumSends(MediaTrack* track, int category)
+    {
+        COUNT_DAW_CALL("GetTrackNumSends");
+        vector<shared_ptr<HeadlessSend>>* sends = Model().IsLive(track) ? track->GetSends(category) : nullptr;
+
+        if(sends)
+            return (int)sends->size();
+        else
+            return 0;
+    }
+
+    static bool GetTrackSendUIMute(MediaTrack* track, int send_index, bool* muteOut)
+    {
+        COUNT_DAW_CALL("GetTrackSendUIMute");
+        HeadlessSend* send = Model().IsLive(track) ? track->GetSend(0, send_index) : nullptr;
+
+        if(send == nullptr)
+            return false;
+
+        *muteOut = send->info_.GetValue("B_MUTE") != 0.0;
+        return true;
+    }
+
+    static bool GetTrackSendUIVolPan(MediaTrack* track, int send_index, double* volumeOut, double* panOut)
+    {
+        COUNT_DAW_CALL("GetTrackSendUIVolPan");
+        HeadlessSend* send = Model().IsLive(track) ? track->GetSend(0, send_index) : nullptr;
+
+        if(send == nullptr)
+            return false;
+
+        *volumeOut = send->info_.GetValue("D_VOL");
+        *panOut = send->info_.GetValue("D_PAN");
+        return true;
+    }
+
+    static double Track_GetPeakInfo(MediaTrack* track, int channel)
+    {
+        COUNT_DAW_CALL("Track_GetPeakInfo");
+        if(Model().IsLive(track) && channel >= 0 && channel < 2)
+            return track->peaks_[channel];
+        else
+            return 0.0;
+    }
+
+    static void CSurf_SetSurfacePan(MediaTrack* track, double pan, IReaperControlSurface* ignoresurf) { COUNT_DAW_CALL("CSurf_SetSurfacePan"); }
+
+    static void CSurf_SetSurfaceMute(MediaTrack* track, bool mute, IReaperControlSurface* ignoresurf) { COUNT_DAW_CALL("CSurf_SetSurfaceMute"); }
+
+    static double CSurf_OnWidthChange(MediaTrack* track, double width, bool relative)
+    {
+        COUNT_DAW_CALL("CSurf_OnWidthChange");
+        if( ! Model().IsLive(track))
+            return 0.0;
+
+        track->info_.SetValue("D_WIDTH", Clamp(relative ? track->info_.GetValue("D_WIDTH") + width : width, -1.0, 1.0));
+        LogWrite("CSurf_OnWidthChange", "", track, -1, -1, track->info_.GetValue("D_WIDTH"));
+        return track->info_.GetValue("D_WIDTH");
+    }
+
+    static bool CSurf_OnSelectedChange(MediaTrack* track, int selected)
+    {
+        COUNT_DAW_CALL("CSurf_OnSelectedChange");
+        if(Model().IsLive(track))
+            return SetOrToggle(track, "I_SELECTED", selected);
+        else
+            return false;
+    }
+
+    static void CSurf_SetSurfaceSelected(MediaTrack* track, bool selected, IReaperControlSurface* ignoresurf) { COUNT_DAW_CALL("CSurf_SetSurfaceSelected"); }
+
+    static void SetOnlyTrackSelected(MediaTrack* track)
+    {
+        COUNT_DAW_CALL("SetOnlyTrackSelected");
+        if( ! Model().IsLive(track))
+            return;
+
+        LogWrite("SetOnlyTrackSelected", "", track, -1, -1, 1.0);
+        Model().master_->info_.SetValue("I_SELECTED", track == Model().master_.get());
+        Model().ForEachTrack([track](MediaTrack* other) { other->info_.SetValue("I_SELECTED", other == track); });
+    }
+
+    static bool CSurf_OnRecArmChange(MediaTrack* track, int recarm)
+    {
+        COUNT_DAW_CALL("CSurf_OnRecArmChange");
+        if(Model().IsLive(track))
+            return SetOrToggle(track, "I_RECARM", recarm);
+        else
+            return false;
+    }
+
+    static void CSurf_SetSurfaceRecArm(MediaTrack* track, bool recarm, IReaperControlSurface* ignoresurf) { COUNT_DAW_CALL("CSurf_SetSurfaceRecArm"); }
+
+    static bool CSurf_OnSoloChange(MediaTrack* track, int solo)
+    {
+        COUNT_DAW_CALL("CSurf_OnSoloChange");
+        if(Model().IsLive(track))
+            return SetOrToggle(track, "I_SOLO", solo);
+        else
+            return false;
+    }
+
+    static void CSurf_SetSurfaceSolo(MediaTrack* track, bool solo, IReaperControlSurface* ignoresurf) { COUNT_DAW_CALL("CSurf_SetSurfaceSolo"); }
+
+    static bool IsTrackVisible(MediaTrack* track, bool mixer)
+    {
+        COUNT_DAW_CALL("IsTrackVisible");
+        if(Model().IsLive(track))
+            return track->info_.GetValue(mixer ? "B_SHOWINMIXER" : "B_SHOWINTCP") != 0.0;
+        else
+            return false;
+    }
+
+    static MediaTrack* SetMixerScroll(MediaTrack* leftmosttrack)
+    {
+        COUNT_DAW_CALL("SetMixerScroll");
+        if( ! Model().IsLive(leftmosttrack))
+            return nullptr;
+
+        LogWrite("SetMixerScroll", "", leftmosttrack, -1, -1, 0.0);
+        Model().mixerScrollTrack_ = leftmosttrack;
+        return leftmosttrack;
+    }
+};
+
+#endif /* control_surface_integrator_HeadlessDAW_h */
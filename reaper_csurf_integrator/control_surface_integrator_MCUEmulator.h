@@ -0,0 +1,391 @@
+//
+//  control_surface_integrator_MCUEmulator.h
+//  reaper_csurf_integrator
+//
+//  Software Mackie Control / XT / C4 that consumes the MIDI CSI sends and rebuilds what the hardware would show:
+//  faders, V-Pot rings, button LEDs, the scribble strips, meters and the timecode display.
+//  Every message is also counted per category, in bytes as they go over the wire, with per second buckets
+//  and a count of messages that did not change anything on the device.
+//
+//  Attach it to a headless midi_Output with HeadlessMidiOutput::AttachEmulator(), or call Consume() directly.
+//
+
+#ifndef control_surface_integrator_MCUEmulator_h
+#define control_surface_integrator_MCUEmulator_h
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+
+using namespace std;
+
+enum MCUEmulatorModel
+{
+    MCUEmulatorMCU,
+    MCUEmulatorXT,
+    MCUEmulatorC4,
+};
+
+enum MCUEmulatorCategory
+{
+    MCUFader,
+    MCUVPotRing,
+    MCULED,
+    MCUDisplay,
+    MCUMeter,
+    MCUTimeDisplay,
+    MCUOther,
+    NumMCUEmulatorCategories
+};
+
+static const char* const MCUEmulatorCategoryNames[NumMCUEmulatorCategories] = { "Fader", "VPotRing", "LED", "Display", "Meter", "TimeDisplay", "Other" };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MCUEmulatorCounters
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    int messages = 0;
+    int bytes = 0;
+    int redundantMessages = 0; // messages that left the device state exactly as it was
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MCUEmulator
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    static const int NumFaders = 9;           // 8 strips + master on the MCU
+    static const int NumRings = 32;           // C4 has 32 V-Pots, MCU and XT use the first 8
+    static const int NumMeters = 8;
+    static const int NumDisplayRows = 4;      // C4 has 4 rows, MCU and XT use row 0
+    static const int DisplayRowLength = 112;  // upper line 0 - 55, lower line 56 - 111
+    static const int NumTimeDigits = 10;
+
+private:
+    MCUEmulatorModel model_ = MCUEmulatorMCU;
+
+    int faders_[NumFaders];
+    int rings_[NumRings];
+    int leds_[128];
+    int meters_[NumMeters];
+    bool meterOverload_[NumMeters];
+    char display_[NumDisplayRows][DisplayRowLength + 1];
+    char timeDisplay_[NumTimeDigits + 1];
+    bool timeDisplayDots_[NumTimeDigits];
+
+    MCUEmulatorCounters totals_[NumMCUEmulatorCategories];
+    MCUEmulatorCounters currentSecond_[NumMCUEmulatorCategories];
+    MCUEmulatorCounters peakSecond_[NumMCUEmulatorCategories];
+    double currentSecondStart_ = -1.0;
+    int numSeconds_ = 0;
+
+    int GetDisplayType()
+    {
+        if(model_ == MCUEmulatorXT)
+            return 0x15;
+        else if(model_ == MCUEmulatorC4)
+            return 0x17;
+        else
+            return 0x14;
+    }
+
+    static int GetWireSize(const unsigned char* msg, int size)
+    {
+        // Program change and channel pressure are 2 bytes on the wire, CSI still hands them to midi_Output as 3
+        int status = msg[0] & 0xf0;
+
+        if((status == 0xc0 || status == 0xd0) && size > 2)
+            return 2;
+        else
+            return size;
+    }
+
+    static char DecodeSevenSegment(int value)
+    {
+        // The MCU timecode font maps 0x00 - 0x1f to '@' - '_' and 0x20 - 0x3f to ASCII
+        value &= 0x3f;
+
+        return value < 0x20 ? (char)(value + 0x40) : (char)value;
+    }
+
+    void Count(MCUEmulatorCategory category, int size, bool changed, double timestamp)
+    {
+        if(currentSecondStart_ < 0.0)
+            currentSecondStart_ = timestamp;
+
+        while(timestamp >= currentSecondStart_ + 1000.0)
+            EndSecond();
+
+        totals_[category].messages++;
+        totals_[category].bytes += size;
+        currentSecond_[category].messages++;
+        currentSecond_[category].bytes += size;
+
+        if( ! changed)
+        {
+            totals_[category].redundantMessages++;
+            currentSecond_[category].redundantMessages++;
+        }
+    }
+
+    void EndSecond()
+    {
+        for(int i = 0; i < NumMCUEmulatorCategories; i++)
+        {
+            if(currentSecond_[i].messages > peakSecond_[i].messages)
+                peakSecond_[i].messages = currentSecond_[i].messages;
+            if(currentSecond_[i].bytes > peakSecond_[i].bytes)
+                peakSecond_[i].bytes = currentSecond_[i].bytes;
+            if(currentSecond_[i].redundantMessages > peakSecond_[i].redundantMessages)
+                peakSecond_[i].redundantMessages = currentSecond_[i].redundantMessages;
+
+            currentSecond_[i] = MCUEmulatorCounters();
+        }
+
+        currentSecondStart_ += 1000.0;
+        numSeconds_++;
+    }
+
+    bool Set(int &state, int value)
+    {
+        if(state == value)
+            return false;
+
+        state = value;
+        return true;
+    }
+
+    MCUEmulatorCategory ConsumeSysEx(const unsigned char* msg, int size, bool &changed)
+    {
+        // F0 00 00 66 <type> <command> ... F7
+        if(size < 7 || msg[1] != 0x00 || msg[2] != 0x00 || msg[3] != 0x66 || msg[4] != GetDisplayType())
+            return MCUOther;
+
+        int command = msg[5];
+
+        if(command == 0x20 || command == 0x21) // meter mode per channel, global meter orientation
+            return MCUMeter;
+
+        int row = -1;
+
+        if(command == 0x12 && model_ != MCUEmulatorC4)
+            row = 0;
+        else if(command >= 0x30 && command < 0x30 + NumDisplayRows && model_ == MCUEmulatorC4)
+            row = command - 0x30;
+
+        if(row < 0)
+            return MCUOther;
+
+        int offset = msg[6];
+
+        for(int i = 7; i < size && msg[i] != 0xf7 && offset < DisplayRowLength; i++, offset++)
+        {
+            if(display_[row][offset] != (char)msg[i])
+            {
+                display_[row][offset] = (char)msg[i];
+                changed = true;
+            }
+        }
+
+        return MCUDisplay;
+    }
+
+    MCUEmulatorCategory ConsumeShort(const unsigned char* msg, int size, bool &changed)
+    {
+        int status = msg[0] & 0xf0;
+        int channel = msg[0] & 0x0f;
+
+        if(status == 0xe0 && size >= 3)
+        {
+            if(channel >= NumFaders)
+                return MCUOther;
+
+            changed = Set(faders_[channel], msg[1] | (msg[2] << 7));
+            return MCUFader;
+        }
+        else if(status == 0xd0 && size >= 2)
+        {
+            // yx : y = meter, x = 0 - 0xd level, 0xe overload on, 0xf overload off
+            int meter = msg[1] >> 4;
+            int level = msg[1] & 0x0f;
+
+            if(channel != 0 || meter >= NumMeters)
+                return MCUMeter;
+
+            if(level == 0x0e || level == 0x0f)
+            {
+                changed = meterOverload_[meter] != (level == 0x0e);
+                meterOverload_[meter] = level == 0x0e;
+            }
+            else
+                changed = Set(meters_[meter], level);
+
+            return MCUMeter;
+        }
+        else if((status == 0x90 || status == 0x80) && size >= 3)
+        {
+            int note = msg[1] & 0x7f;
+            int velocity = status == 0x80 ? 0 : msg[2];
+
+            if(model_ == MCUEmulatorMCU && (note == 0x71 || note == 0x72)) // SMPTE / BEATS lights belong to the timecode display
+            {
+                changed = Set(leds_[note], velocity);
+                return MCUTimeDisplay;
+            }
+
+            changed = Set(leds_[note], velocity);
+            return MCULED;
+        }
+        else if(status == 0xb0 && size >= 3)
+        {
+            int cc = msg[1];
+            int ringBase = model_ == MCUEmulatorC4 ? 0x20 : 0x30;
+            int numRings = model_ == MCUEmulatorC4 ? NumRings : 8;
+
+            if(cc >= ringBase && cc < ringBase + numRings)
+            {
+                changed = Set(rings_[cc - ringBase], msg[2]);
+                return MCUVPotRing;
+            }
+
+            if(model_ == MCUEmulatorMCU && cc >= 0x40 && cc < 0x40 + NumTimeDigits)
+            {
+                // Digit 0x40 is the rightmost one
+                int position = NumTimeDigits - 1 - (cc - 0x40);
+                char digit = DecodeSevenSegment(msg[2]);
+                bool dot = (msg[2] & 0x40) != 0;
+
+                changed = timeDisplay_[position] != digit || timeDisplayDots_[position] != dot;
+                timeDisplay_[position] = digit;
+                timeDisplayDots_[position] = dot;
+
+                return MCUTimeDisplay;
+            }
+        }
+
+        return MCUOther;
+    }
+
+public:
+    MCUEmulator(MCUEmulatorModel model = MCUEmulatorMCU) : model_(model)
+    {
+        ResetState();
+    }
+
+    MCUEmulatorModel GetModel() { return model_; }
+
+    void ResetState()
+    {
+        memset(faders_, 0, sizeof(faders_));
+        memset(rings_, 0, sizeof(rings_));
+        memset(leds_, 0, sizeof(leds_));
+        memset(meters_, 0, sizeof(meters_));
+        memset(meterOverload_, 0, sizeof(meterOverload_));
+
+        for(int i = 0; i < NumDisplayRows; i++)
+        {
+            memset(display_[i], ' ', DisplayRowLength);
+            display_[i][DisplayRowLength] = 0;
+        }
+
+        memset(timeDisplay_, ' ', NumTimeDigits);
+        timeDisplay_[NumTimeDigits] = 0;
+        memset(timeDisplayDots_, 0, sizeof(timeDisplayDots_));
+    }
+
+    void ResetCounters()
+    {
+        for(int i = 0; i < NumMCUEmulatorCategories; i++)
+        {
+            totals_[i] = MCUEmulatorCounters();
+            currentSecond_[i] = MCUEmulatorCounters();
+            peakSecond_[i] = MCUEmulatorCounters();
+        }
+
+        currentSecondStart_ = -1.0;
+        numSeconds_ = 0;
+    }
+
+    // timestamp in milliseconds, only used to bucket the counters
+    MCUEmulatorCategory Consume(const unsigned char* msg, int size, double timestamp)
+    {
+        if(size < 1)
+            return MCUOther;
+
+        bool changed = false;
+        MCUEmulatorCategory category = msg[0] == 0xf0 ? ConsumeSysEx(msg, size, changed) : ConsumeShort(msg, size, changed);
+
+        Count(category, msg[0] == 0xf0 ? size : GetWireSize(msg, size), changed, timestamp);
+
+        return category;
+    }
+
+    // Device state
+    int GetFader(int channel) { return channel >= 0 && channel < NumFaders ? faders_[channel] : 0; }
+    int GetRing(int vpot) { return vpot >= 0 && vpot < NumRings ? rings_[vpot] : 0; }
+    int GetRingPosition(int vpot) { return GetRing(vpot) & 0x0f; }
+    int GetRingMode(int vpot) { return (GetRing(vpot) >> 4) & 0x03; }
+    int GetLED(int note) { return note >= 0 && note < 128 ? leds_[note] : 0; }
+    bool IsLEDOn(int note) { return GetLED(note) != 0; }
+    int GetMeter(int channel) { return channel >= 0 && channel < NumMeters ? meters_[channel] : 0; }
+    bool IsMeterOverloaded(int channel) { return channel >= 0 && channel < NumMeters ? meterOverload_[channel] : false; }
+    string GetTimeDisplay() { return timeDisplay_; }
+    bool IsTimeDisplayDotOn(int position) { return position >= 0 && position < NumTimeDigits ? timeDisplayDots_[position] : false; }
+
+    string GetDisplayLine(int row, int line) // line 0 = upper, 1 = lower
+    {
+        if(row < 0 || row >= NumDisplayRows || line < 0 || line > 1)
+            return "";
+
+        return string(display_[row] + line * 56, 56);
+    }
+
+    string GetDisplayCell(int row, int line, int channel) // the 7 characters CSI writes per channel
+    {
+        if(channel < 0 || channel > 7)
+            return "";
+
+        return GetDisplayLine(row, line).substr(channel * 7, 7);
+    }
+
+    // Byte accounting
+    MCUEmulatorCounters GetTotals(MCUEmulatorCategory category) { return totals_[category]; }
+    MCUEmulatorCounters GetPeakPerSecond(MCUEmulatorCategory category) { return peakSecond_[category].bytes > currentSecond_[category].bytes ? peakSecond_[category] : currentSecond_[category]; }
+    int GetNumSeconds() { return numSeconds_ + (currentSecondStart_ < 0.0 ? 0 : 1); }
+
+    MCUEmulatorCounters GetGrandTotals()
+    {
+        MCUEmulatorCounters grandTotals;
+
+        for(int i = 0; i < NumMCUEmulatorCategories; i++)
+        {
+            grandTotals.messages += totals_[i].messages;
+            grandTotals.bytes += totals_[i].bytes;
+            grandTotals.redundantMessages += totals_[i].redundantMessages;
+        }
+
+        return grandTotals;
+    }
+
+    string Report()
+    {
+        string report;
+        char buffer[256];
+        int numSeconds = GetNumSeconds();
+
+        snprintf(buffer, sizeof(buffer), "%-12s %10s %10s %10s %12s %12s\n", "Category", "Messages", "Bytes", "Redundant", "Bytes/sec", "Peak B/sec");
+        report += buffer;
+
+        for(int i = 0; i < NumMCUEmulatorCategories; i++)
+        {
+            MCUEmulatorCounters peak = GetPeakPerSecond((MCUEmulatorCategory)i);
+
+            snprintf(buffer, sizeof(buffer), "%-12s %10d %10d %10d %12.1f %12d\n", MCUEmulatorCategoryNames[i], totals_[i].messages, totals_[i].bytes, totals_[i].redundantMessages, numSeconds > 0 ? totals_[i].bytes / (double)numSeconds : 0.0, peak.bytes);
+            report += buffer;
+        }
+
+        return report;
+    }
+};
+
+#endif /* control_surface_integrator_MCUEmulator_h */
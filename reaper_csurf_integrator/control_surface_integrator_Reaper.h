@@ -7,7 +7,12 @@
 #ifndef control_surface_integrator_Reaper_h
 #define control_surface_integrator_Reaper_h
 
+#ifdef CSI_HEADLESS_DAW
+#include <unordered_set> // ahead of the swell min/max macros
+#include "reaper_plugin.h"
+#else
 #include "reaper_plugin_functions.h"
+#endif
 #include "WDL/mutex.h"
 #include "ReportLoggingEtc.h"
 
@@ -50,6 +55,9 @@ struct MIDI_event_ex_t : MIDI_event_t
     }
 };
 
+#ifdef CSI_HEADLESS_DAW
+#include "control_surface_integrator_HeadlessDAW.h"
+#else
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class DAW
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -57,10 +65,11 @@ class DAW
 public:
     static void SwapBufsPrecise(midi_Input* midiInput)
     {
+        COUNT_DAW_CALL("SwapBufsPrecise");
     #ifndef timeGetTime
-            midiInput->SwapBufsPrecise(GetTickCount(), GetTickCount());
+            midiInput->SwapBufsPrecise(GetTickCount(), time_precise());
     #else
-            midiInput->SwapBufsPrecise(timeGetTime(), timeGetTime());
+            midiInput->SwapBufsPrecise(timeGetTime(), time_precise());
     #endif
     }
     
@@ -73,75 +82,110 @@ public:
     #endif
     }
     
-    static void MarkProjectDirty(ReaProject* proj) { ::MarkProjectDirty(proj); }
+    static void MarkProjectDirty(ReaProject* proj) { COUNT_DAW_CALL("MarkProjectDirty"); ::MarkProjectDirty(proj); }
     
-    static const char* get_ini_file() { return ::get_ini_file(); }
+    static int plugin_register(const char* name, void* infostruct) { COUNT_DAW_CALL("plugin_register"); return ::plugin_register(name, infostruct); }
+    
+    static int projectconfig_var_getoffs(const char* name, int* szOut) { COUNT_DAW_CALL("projectconfig_var_getoffs"); return ::projectconfig_var_getoffs(name, szOut); }
+    
+    static void* projectconfig_var_addr(ReaProject* proj, int idx) { COUNT_DAW_CALL("projectconfig_var_addr"); return ::projectconfig_var_addr(proj, idx); }
+    
+    static double SLIDER2DB(double y) { COUNT_DAW_CALL("SLIDER2DB"); return ::SLIDER2DB(y); }
+    
+    static double DB2SLIDER(double x) { COUNT_DAW_CALL("DB2SLIDER"); return ::DB2SLIDER(x); }
+    
+    static const char* get_ini_file() { COUNT_DAW_CALL("get_ini_file"); return ::get_ini_file(); }
 
-    static DWORD GetPrivateProfileString(const char *appname, const char *keyname, const char *def, char *ret, int retsize, const char *fn) { return ::GetPrivateProfileString(appname, keyname, def, ret, retsize, fn); }
+    static DWORD GetPrivateProfileString(const char *appname, const char *keyname, const char *def, char *ret, int retsize, const char *fn) { COUNT_DAW_CALL("GetPrivateProfileString"); return ::GetPrivateProfileString(appname, keyname, def, ret, retsize, fn); }
 
-    static const char* GetResourcePath() { return ::GetResourcePath(); }
+    static const char* GetResourcePath() { COUNT_DAW_CALL("GetResourcePath"); return ::GetResourcePath(); }
     
-    static int NamedCommandLookup(const char* command_name) { return ::NamedCommandLookup(command_name);  }
+    static int NamedCommandLookup(const char* command_name) { COUNT_DAW_CALL("NamedCommandLookup"); return ::NamedCommandLookup(command_name);  }
 
-    static void SendCommandMessage(WPARAM wparam) { ::SendMessage(g_hwnd, WM_COMMAND, wparam, 0); }
+    static void SendCommandMessage(WPARAM wparam) { COUNT_DAW_CALL("SendCommandMessage"); ::SendMessage(g_hwnd, WM_COMMAND, wparam, 0); }
+    
+    static void PostCommandMessage(WPARAM wparam)
+    {
+        COUNT_DAW_CALL("PostCommandMessage");
+        if(g_hwnd != nullptr)
+            ::PostMessage(g_hwnd, WM_COMMAND, wparam, 0);
+    }
+    
+    static void DestroyWindow(HWND hwnd)
+    {
+        COUNT_DAW_CALL("DestroyWindow");
+        if(::IsWindow(hwnd))
+            ::DestroyWindow(hwnd);
+    }
     
-    static int GetToggleCommandState(int commandId) { return ::GetToggleCommandState(commandId); }
+    static int GetToggleCommandState(int commandId) { COUNT_DAW_CALL("GetToggleCommandState"); return ::GetToggleCommandState(commandId); }
     
-    static void ShowConsoleMsg(const char* msg) { ::ShowConsoleMsg(msg); }
+    static void ShowConsoleMsg(const char* msg) { COUNT_DAW_CALL("ShowConsoleMsg"); ::ShowConsoleMsg(msg); }
     
-    static midi_Input* CreateMIDIInput(int dev) {  return ::CreateMIDIInput(dev); }
+    static midi_Input* CreateMIDIInput(int dev) { COUNT_DAW_CALL("CreateMIDIInput"); return ::CreateMIDIInput(dev); }
     
-    static midi_Output* CreateMIDIOutput(int dev, bool streamMode, int* msoffset100) {  return ::CreateMIDIOutput(dev, streamMode, msoffset100); }
+    static midi_Output* CreateMIDIOutput(int dev, bool streamMode, int* msoffset100) { COUNT_DAW_CALL("CreateMIDIOutput"); return ::CreateMIDIOutput(dev, streamMode, msoffset100); }
    
-    static bool AnyTrackSolo(ReaProject* proj) { return ::AnyTrackSolo(proj); }
+    static bool AnyTrackSolo(ReaProject* proj) { COUNT_DAW_CALL("AnyTrackSolo"); return ::AnyTrackSolo(proj); }
     
-    static void SoloAllTracks(int solo) { ::SoloAllTracks(solo); }
+    static void SoloAllTracks(int solo) { COUNT_DAW_CALL("SoloAllTracks"); ::SoloAllTracks(solo); }
 
-    static void SetAutomationMode(int mode, bool onlySel) { ::SetAutomationMode(mode, onlySel); }
+    static void SetAutomationMode(int mode, bool onlySel) { COUNT_DAW_CALL("SetAutomationMode"); ::SetAutomationMode(mode, onlySel); }
 
-    static int GetGlobalAutomationOverride() { return ::GetGlobalAutomationOverride(); }
+    static int GetGlobalAutomationOverride() { COUNT_DAW_CALL("GetGlobalAutomationOverride"); return ::GetGlobalAutomationOverride(); }
 
-    static void SetGlobalAutomationOverride(int mode) { ::SetGlobalAutomationOverride(mode); }
+    static void SetGlobalAutomationOverride(int mode) { COUNT_DAW_CALL("SetGlobalAutomationOverride"); ::SetGlobalAutomationOverride(mode); }
 
-    static int GetFocusedFX(int* tracknumberOut, int* itemnumberOut, int* fxnumberOut) { return ::GetFocusedFX(tracknumberOut, itemnumberOut, fxnumberOut); }
+    static int GetFocusedFX(int* tracknumberOut, int* itemnumberOut, int* fxnumberOut) { COUNT_DAW_CALL("GetFocusedFX"); return ::GetFocusedFX(tracknumberOut, itemnumberOut, fxnumberOut); }
     
-    static bool GetLastTouchedFX(int* tracknumberOut, int* fxnumberOut, int* paramnumberOut) {  return ::GetLastTouchedFX(tracknumberOut, fxnumberOut, paramnumberOut); }
+    static bool GetLastTouchedFX(int* tracknumberOut, int* fxnumberOut, int* paramnumberOut) { COUNT_DAW_CALL("GetLastTouchedFX"); return ::GetLastTouchedFX(tracknumberOut, fxnumberOut, paramnumberOut); }
 
-    static void CSurf_OnArrow(int whichdir, bool wantzoom) { ::CSurf_OnArrow(whichdir, wantzoom); }
+    static void CSurf_OnArrow(int whichdir, bool wantzoom) { COUNT_DAW_CALL("CSurf_OnArrow"); ::CSurf_OnArrow(whichdir, wantzoom); }
     
-    static void CSurf_OnRew(int seekplay) { ::CSurf_OnRew(seekplay); }
+    static void CSurf_OnRew(int seekplay) { COUNT_DAW_CALL("CSurf_OnRew"); ::CSurf_OnRew(seekplay); }
     
-    static void CSurf_OnFwd(int seekplay) { ::CSurf_OnFwd(seekplay); }
+    static void CSurf_OnFwd(int seekplay) { COUNT_DAW_CALL("CSurf_OnFwd"); ::CSurf_OnFwd(seekplay); }
     
-    static void CSurf_OnStop() { ::CSurf_OnStop(); }
+    static void CSurf_OnStop() { COUNT_DAW_CALL("CSurf_OnStop"); ::CSurf_OnStop(); }
     
-    static void CSurf_OnPlay() { ::CSurf_OnPlay(); }
+    static void CSurf_OnPlay() { COUNT_DAW_CALL("CSurf_OnPlay"); ::CSurf_OnPlay(); }
     
-    static void CSurf_OnRecord() { ::CSurf_OnRecord(); }
+    static void CSurf_OnRecord() { COUNT_DAW_CALL("CSurf_OnRecord"); ::CSurf_OnRecord(); }
     
-    static int GetPlayState() { return ::GetPlayState(); }
+    static int GetPlayState() { COUNT_DAW_CALL("GetPlayState"); return ::GetPlayState(); }
     
-    static int CSurf_NumTracks(bool mcpView) { return ::CSurf_NumTracks(mcpView); };
+    static double GetPlayPosition() { COUNT_DAW_CALL("GetPlayPosition"); return ::GetPlayPosition(); }
     
-    static MediaTrack* CSurf_TrackFromID(int idx, bool mcpView) { return ::CSurf_TrackFromID(idx, mcpView); }
+    static double GetCursorPosition() { COUNT_DAW_CALL("GetCursorPosition"); return ::GetCursorPosition(); }
     
-    static int GetSetRepeatEx(ReaProject* proj, int val) { return ::GetSetRepeatEx(proj, val); }
+    static void format_timestr_pos(double tpos, char* buf, int buf_sz, int modeoverride) { COUNT_DAW_CALL("format_timestr_pos"); ::format_timestr_pos(tpos, buf, buf_sz, modeoverride); }
     
-    static MediaTrack* GetMasterTrack(ReaProject* proj) { return ::GetMasterTrack(proj); };
+    static double TimeMap2_timeToBeats(ReaProject* proj, double tpos, int* measuresOutOptional, int* cmlOutOptional, double* fullbeatsOutOptional, int* cdenomOutOptional) { COUNT_DAW_CALL("TimeMap2_timeToBeats"); return ::TimeMap2_timeToBeats(proj, tpos, measuresOutOptional, cmlOutOptional, fullbeatsOutOptional, cdenomOutOptional); }
     
-    static int CountSelectedTracks(ReaProject* proj) { return ::CountSelectedTracks2(proj, true); }
+    static double TimeMap_curFrameRate(ReaProject* proj, bool* dropFrameOutOptional) { COUNT_DAW_CALL("TimeMap_curFrameRate"); return ::TimeMap_curFrameRate(proj, dropFrameOutOptional); }
+    
+    static int CSurf_NumTracks(bool mcpView) { COUNT_DAW_CALL("CSurf_NumTracks"); return ::CSurf_NumTracks(mcpView); };
+    
+    static MediaTrack* CSurf_TrackFromID(int idx, bool mcpView) { COUNT_DAW_CALL("CSurf_TrackFromID"); return ::CSurf_TrackFromID(idx, mcpView); }
+    
+    static int GetSetRepeatEx(ReaProject* proj, int val) { COUNT_DAW_CALL("GetSetRepeatEx"); return ::GetSetRepeatEx(proj, val); }
+    
+    static MediaTrack* GetMasterTrack(ReaProject* proj) { COUNT_DAW_CALL("GetMasterTrack"); return ::GetMasterTrack(proj); };
+    
+    static int CountSelectedTracks(ReaProject* proj) { COUNT_DAW_CALL("CountSelectedTracks"); return ::CountSelectedTracks2(proj, true); }
     
     // Runs the system color chooser dialog.  Returns 0 if the user cancels the dialog.
-    static int GR_SelectColor(HWND hwnd, int* colorOut) { return ::GR_SelectColor(hwnd, colorOut); }
+    static int GR_SelectColor(HWND hwnd, int* colorOut) { COUNT_DAW_CALL("GR_SelectColor"); return ::GR_SelectColor(hwnd, colorOut); }
     
-    static void ColorFromNative(int col, int* rOut, int* gOut, int* bOut) { ::ColorFromNative(col, rOut, gOut, bOut); }
+    static void ColorFromNative(int col, int* rOut, int* gOut, int* bOut) { COUNT_DAW_CALL("ColorFromNative"); ::ColorFromNative(col, rOut, gOut, bOut); }
     
-    static int ColorToNative(int r, int g, int b) { return ::ColorToNative(r, g, b); }
+    static int ColorToNative(int r, int g, int b) { COUNT_DAW_CALL("ColorToNative"); return ::ColorToNative(r, g, b); }
 
-    static bool ValidateTrackPtr(MediaTrack* track) { return ValidatePtr(track, "MediaTrack*"); }
+    static bool ValidateTrackPtr(MediaTrack* track) { COUNT_DAW_CALL("ValidateTrackPtr"); return ValidatePtr(track, "MediaTrack*"); }
     
     static HWND TrackFX_GetFloatingWindow(MediaTrack* track, int index)
     {
+        COUNT_DAW_CALL("TrackFX_GetFloatingWindow");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetFloatingWindow(track, index);
         else
@@ -150,12 +194,14 @@ public:
 
     static void TrackFX_Show(MediaTrack* track, int index, int showFlag)
     {
+        COUNT_DAW_CALL("TrackFX_Show");
         if(ValidatePtr(track, "MediaTrack*"))
             ::TrackFX_Show(track, index, showFlag);
     }
 
     static int TrackFX_GetCount(MediaTrack* track)
     {
+        COUNT_DAW_CALL("TrackFX_GetCount");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetCount(track);
         else
@@ -164,6 +210,7 @@ public:
     
     static bool TrackFX_GetFXName(MediaTrack* track, int fx, char* buf, int buf_sz)
     {
+        COUNT_DAW_CALL("TrackFX_GetFXName");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetFXName(track, fx, buf, buf_sz);
         else
@@ -176,6 +223,7 @@ public:
     
     static bool TrackFX_GetNamedConfigParm(MediaTrack* track, int fx, const char* parmname, char* buf, int buf_sz)
     {
+        COUNT_DAW_CALL("TrackFX_GetNamedConfigParm");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetNamedConfigParm(track, fx, parmname, buf, buf_sz);
         else
@@ -186,8 +234,18 @@ public:
         }
     }
 
+    static bool TrackFX_GetParameterStepSizes(MediaTrack* track, int fx, int param, double* stepOut, double* smallstepOut, double* largestepOut, bool* istoggleOut)
+    {
+        COUNT_DAW_CALL("TrackFX_GetParameterStepSizes");
+        if(ValidatePtr(track, "MediaTrack*"))
+            return ::TrackFX_GetParameterStepSizes(track, fx, param, stepOut, smallstepOut, largestepOut, istoggleOut);
+        else
+            return false;
+    }
+    
     static int TrackFX_GetNumParams(MediaTrack* track, int fx)
     {
+        COUNT_DAW_CALL("TrackFX_GetNumParams");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetNumParams(track, fx);
         else
@@ -196,6 +254,7 @@ public:
     
     static bool TrackFX_GetParamName(MediaTrack* track, int fx, int param, char* buf, int buf_sz)
     {
+        COUNT_DAW_CALL("TrackFX_GetParamName");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetParamName(track, fx, param, buf, buf_sz);
         else
@@ -208,6 +267,7 @@ public:
     
     static bool TrackFX_GetFormattedParamValue(MediaTrack* track, int fx, int param, char* buf, int buf_sz)
     {
+        COUNT_DAW_CALL("TrackFX_GetFormattedParamValue");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetFormattedParamValue(track, fx, param, buf, buf_sz);
         else
@@ -220,6 +280,7 @@ public:
     
     static double TrackFX_GetParam(MediaTrack* track, int fx, int param, double* minvalOut, double* maxvalOut)
     {
+        COUNT_DAW_CALL("TrackFX_GetParam");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_GetParam(track, fx, param, minvalOut, maxvalOut);
         else
@@ -228,6 +289,7 @@ public:
     
     static bool TrackFX_SetParam(MediaTrack* track, int fx, int param, double val)
     {
+        COUNT_DAW_CALL("TrackFX_SetParam");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::TrackFX_SetParam(track, fx, param, val);
         else
@@ -236,6 +298,7 @@ public:
 
     static bool GetTrackName(MediaTrack* track, char* buf, int buf_sz)
     {
+        COUNT_DAW_CALL("GetTrackName");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackName(track, buf, buf_sz);
         else
@@ -248,6 +311,7 @@ public:
     
     static double GetMediaTrackInfo_Value(MediaTrack* track, const char* parmname)
     {
+        COUNT_DAW_CALL("GetMediaTrackInfo_Value");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetMediaTrackInfo_Value(track, parmname);
         else
@@ -256,6 +320,7 @@ public:
 
     static double GetTrackSendInfo_Value(MediaTrack* track, int category, int send_index, const char* parmname)
     {
+        COUNT_DAW_CALL("GetTrackSendInfo_Value");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackSendInfo_Value(track, category, send_index, parmname);
         else
@@ -264,6 +329,7 @@ public:
 
     static void* GetSetTrackSendInfo(MediaTrack* track, int category, int send_index, const char* parmname, void* setNewValue)
     {
+        COUNT_DAW_CALL("GetSetTrackSendInfo");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetSetTrackSendInfo(track, category, send_index, parmname, setNewValue);
         else
@@ -272,6 +338,7 @@ public:
     
     static void* GetSetMediaTrackInfo(MediaTrack* track, const char* parmname, void* setNewValue)
     {
+        COUNT_DAW_CALL("GetSetMediaTrackInfo");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetSetMediaTrackInfo(track, parmname, setNewValue);
         else
@@ -280,6 +347,7 @@ public:
     
     static unsigned int GetSetTrackGroupMembership(MediaTrack* track, const char* groupname, unsigned int setmask, unsigned int setvalue)
     {
+        COUNT_DAW_CALL("GetSetTrackGroupMembership");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetSetTrackGroupMembership(track, groupname, setmask, setvalue);
         else
@@ -288,6 +356,7 @@ public:
 
     static double CSurf_OnVolumeChange(MediaTrack* track, double volume, bool relative)
     {
+        COUNT_DAW_CALL("CSurf_OnVolumeChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnVolumeChange(track, volume, relative);
         else
@@ -296,6 +365,7 @@ public:
     
     static double CSurf_OnPanChange(MediaTrack* track, double pan, bool relative)
     {
+        COUNT_DAW_CALL("CSurf_OnPanChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnPanChange(track, pan, relative);
         else
@@ -304,6 +374,7 @@ public:
 
     static bool CSurf_OnMuteChange(MediaTrack* track, int mute)
     {
+        COUNT_DAW_CALL("CSurf_OnMuteChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnMuteChange(track, mute);
         else
@@ -312,6 +383,7 @@ public:
 
     static bool GetTrackUIMute(MediaTrack* track, bool* muteOut)
     {
+        COUNT_DAW_CALL("GetTrackUIMute");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackUIMute(track, muteOut);
         else
@@ -320,6 +392,7 @@ public:
     
     static bool GetTrackUIVolPan(MediaTrack* track, double* volumeOut, double* panOut)
     {
+        COUNT_DAW_CALL("GetTrackUIVolPan");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackUIVolPan(track, volumeOut, panOut);
         else
@@ -328,12 +401,14 @@ public:
     
     static void CSurf_SetSurfaceVolume(MediaTrack* track, double volume, IReaperControlSurface* ignoresurf)
     {
+        COUNT_DAW_CALL("CSurf_SetSurfaceVolume");
         if(ValidatePtr(track, "MediaTrack*"))
             ::CSurf_SetSurfaceVolume(track, volume, ignoresurf);
     }
     
     static double CSurf_OnSendVolumeChange(MediaTrack* track, int sendIndex, double volume, bool relative)
     {
+        COUNT_DAW_CALL("CSurf_OnSendVolumeChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnSendVolumeChange(track, sendIndex, volume, relative);
         else
@@ -342,6 +417,7 @@ public:
 
     static double CSurf_OnSendPanChange(MediaTrack* track, int send_index, double pan, bool relative)
     {
+        COUNT_DAW_CALL("CSurf_OnSendPanChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnSendPanChange(track, send_index, pan, relative);
         else
@@ -350,6 +426,7 @@ public:
     
     static int GetTrackNumSends(MediaTrack* track, int category)
     {
+        COUNT_DAW_CALL("GetTrackNumSends");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackNumSends(track, category);
         else
@@ -358,6 +435,7 @@ public:
     
     static bool GetTrackSendUIMute(MediaTrack* track, int send_index, bool* muteOut)
     {
+        COUNT_DAW_CALL("GetTrackSendUIMute");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackSendUIMute(track, send_index, muteOut);
         else
@@ -366,6 +444,7 @@ public:
 
     static bool GetTrackSendUIVolPan(MediaTrack* track, int send_index, double* volumeOut, double* panOut)
     {
+        COUNT_DAW_CALL("GetTrackSendUIVolPan");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::GetTrackSendUIVolPan(track, send_index, volumeOut, panOut);
         else
@@ -374,6 +453,7 @@ public:
 
     static double Track_GetPeakInfo(MediaTrack* track, int channel)
     {
+        COUNT_DAW_CALL("Track_GetPeakInfo");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::Track_GetPeakInfo(track, channel);
         else
@@ -382,18 +462,21 @@ public:
 
     static void CSurf_SetSurfacePan(MediaTrack* track, double pan, IReaperControlSurface* ignoresurf)
     {
+        COUNT_DAW_CALL("CSurf_SetSurfacePan");
         if(ValidatePtr(track, "MediaTrack*"))
             ::CSurf_SetSurfacePan(track, pan, ignoresurf);
     }
 
     static void CSurf_SetSurfaceMute(MediaTrack* track, bool mute, IReaperControlSurface* ignoresurf)
     {
+        COUNT_DAW_CALL("CSurf_SetSurfaceMute");
         if(ValidatePtr(track, "MediaTrack*"))
             ::CSurf_SetSurfaceMute(track, mute, ignoresurf);
     }
 
     static double CSurf_OnWidthChange(MediaTrack* track, double width, bool relative)
     {
+        COUNT_DAW_CALL("CSurf_OnWidthChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnWidthChange(track, width, relative);
         else
@@ -402,6 +485,7 @@ public:
     
     static bool CSurf_OnSelectedChange(MediaTrack* track, int selected)
     {
+        COUNT_DAW_CALL("CSurf_OnSelectedChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnSelectedChange(track, selected);
         else
@@ -410,18 +494,21 @@ public:
 
     static void CSurf_SetSurfaceSelected(MediaTrack* track, bool selected, IReaperControlSurface* ignoresurf)
     {
+        COUNT_DAW_CALL("CSurf_SetSurfaceSelected");
         if(ValidatePtr(track, "MediaTrack*"))
             ::CSurf_SetSurfaceSelected(track, selected, ignoresurf);
     }
     
     static void SetOnlyTrackSelected(MediaTrack* track)
     {
+        COUNT_DAW_CALL("SetOnlyTrackSelected");
         if(ValidatePtr(track, "MediaTrack*"))
             ::SetOnlyTrackSelected(track);
     }
     
     static bool CSurf_OnRecArmChange(MediaTrack* track, int recarm)
     {
+        COUNT_DAW_CALL("CSurf_OnRecArmChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnRecArmChange(track, recarm);
         else
@@ -430,12 +517,14 @@ public:
 
     static void CSurf_SetSurfaceRecArm(MediaTrack* track, bool recarm, IReaperControlSurface* ignoresurf)
     {
+        COUNT_DAW_CALL("CSurf_SetSurfaceRecArm");
         if(ValidatePtr(track, "MediaTrack*"))
             ::CSurf_SetSurfaceRecArm(track, recarm, ignoresurf);
     }
 
     static bool CSurf_OnSoloChange(MediaTrack* track, int solo)
     {
+        COUNT_DAW_CALL("CSurf_OnSoloChange");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::CSurf_OnSoloChange(track, solo);
         else
@@ -444,12 +533,14 @@ public:
 
     static void CSurf_SetSurfaceSolo(MediaTrack* track, bool solo, IReaperControlSurface* ignoresurf)
     {
+        COUNT_DAW_CALL("CSurf_SetSurfaceSolo");
         if(ValidatePtr(track, "MediaTrack*"))
             ::CSurf_SetSurfaceSolo(track, solo, ignoresurf);
     }
     
     static bool IsTrackVisible(MediaTrack* track, bool mixer)
     {
+        COUNT_DAW_CALL("IsTrackVisible");
         if(ValidatePtr(track, "MediaTrack*"))
             return ::IsTrackVisible(track, mixer);
         else
@@ -458,11 +549,13 @@ public:
     
     static MediaTrack* SetMixerScroll(MediaTrack* leftmosttrack)
     {
+        COUNT_DAW_CALL("SetMixerScroll");
         if(ValidatePtr(leftmosttrack, "MediaTrack*"))
             return ::SetMixerScroll(leftmosttrack);
         else
             return nullptr;
     }
 };
+#endif // CSI_HEADLESS_DAW
 
 #endif /* control_surface_integrator_Reaper_h */
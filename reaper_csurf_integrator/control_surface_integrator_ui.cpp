@@ -16,6 +16,10 @@ extern int g_registered_command_toggle_show_surface_input;
 extern int g_registered_command_toggle_show_surface_output;
 extern int g_registered_command_toggle_show_FX_params;
 extern int g_registered_command_toggle_write_FX_params;
+extern int g_registered_command_toggle_trace_capture;
+extern int g_registered_command_dump_trace;
+extern int g_registered_command_toggle_profiler;
+extern int g_registered_command_toggle_input_recording;
 
 bool hookCommandProc(int command, int flag)
 {
@@ -41,6 +45,26 @@ bool hookCommandProc(int command, int flag)
             TheManager->ToggleFXParamsWrite();
             return true;
         }
+        else if (command == g_registered_command_toggle_trace_capture)
+        {
+            TheManager->ToggleTraceCapture();
+            return true;
+        }
+        else if (command == g_registered_command_dump_trace)
+        {
+            TheManager->DumpTrace();
+            return true;
+        }
+        else if (command == g_registered_command_toggle_profiler)
+        {
+            TheManager->ToggleProfiler();
+            return true;
+        }
+        else if (command == g_registered_command_toggle_input_recording)
+        {
+            TheManager->ToggleInputRecording();
+            return true;
+        }
     }
     return false;
 }
@@ -76,6 +100,12 @@ void CSurfIntegrator::SetTrackListChange()
         TheManager->OnTrackListChange();
 }
 
+void CSurfIntegrator::SetTrackTitle(MediaTrack *trackid, const char *title)
+{
+    if(TheManager)
+        TheManager->OnTrackTitleChange(trackid);
+}
+
 int CSurfIntegrator::Extended(int call, void *parm1, void *parm2, void *parm3)
 {
     if(call == CSURF_EXT_SUPPORTS_EXTENDED_TOUCH)
@@ -96,6 +126,12 @@ int CSurfIntegrator::Extended(int call, void *parm1, void *parm2, void *parm3)
             TheManager->TrackFXListChanged((MediaTrack*)parm1);
     }
     
+    if(call == CSURF_EXT_SETLASTTOUCHEDFX)
+    {
+        if(TheManager)
+            TheManager->OnLastTouchedFX();
+    }
+    
     if(call == CSURF_EXT_SETFOCUSEDFX)
     {
         // GAW TBD -- need to implement take FX and clear focus
@@ -200,6 +236,7 @@ struct SurfaceLine
     
     // for OSC
     string remoteDeviceIP = "";
+    int maxPacketSize = 0; // 0 leaves it out of CSI.ini, the surface then uses DefaultOSCMaxPacketSize
 
 };
 
@@ -1079,7 +1116,7 @@ static WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPAR
                         surface->type = tokens[0];
                         surface->name = tokens[1];
                         
-                        if((surface->type == MidiSurfaceToken || surface->type == OSCSurfaceToken) && (tokens.size() == 10 || tokens.size() == 11))
+                        if((surface->type == MidiSurfaceToken || surface->type == OSCSurfaceToken) && (tokens.size() == 10 || tokens.size() == 11 || tokens.size() == 12))
                         {
                             surface->inPort = atoi(tokens[2].c_str());
                             surface->outPort = atoi(tokens[3].c_str());
@@ -1090,8 +1127,11 @@ static WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPAR
                             surface->numFX = atoi(tokens[8].c_str());
                             surface->options = atoi(tokens[9].c_str());
 
-                            if(tokens[0] == OSCSurfaceToken && tokens.size() == 11)
+                            if(tokens[0] == OSCSurfaceToken && tokens.size() > 10)
                                 surface->remoteDeviceIP = tokens[10];
+                            
+                            if(tokens[0] == OSCSurfaceToken && tokens.size() > 11)
+                                surface->maxPacketSize = atoi(tokens[11].c_str());
                         }
                         else if(surface->type == EuConSurfaceToken && tokens.size() == 7 )
                         {
@@ -1173,6 +1213,9 @@ static WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPAR
                             
                             if(surface->type == OSCSurfaceToken)
                                 line += " " + surface->remoteDeviceIP;
+                            
+                            if(surface->type == OSCSurfaceToken && surface->maxPacketSize > 0)
+                                line += " " + to_string(surface->maxPacketSize);
                         }
                         else if(surface->type == EuConSurfaceToken)
                         {
@@ -300,6 +300,11 @@ public:
         
         TheManager->GoToPage(context->GetStringParam());
     }
+    
+    void DoString(ActionContext* context, string value) override
+    {
+        TheManager->GoToPage(value);
+    }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -314,6 +319,11 @@ public:
         
         context->GetSurface()->GoZone(context->GetStringParam());
     }
+    
+    void DoString(ActionContext* context, string value) override
+    {
+        context->GetSurface()->GoZone(value);
+    }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -312,20 +312,13 @@ public:
 class NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-private:
-    int lastR = 0;
-    int lastG = 0;
-    int lastB = 0;
-    
 public:
     virtual ~NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor() {}
     NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
     virtual void ForceRGBValue(int r, int g, int b) override
     {
-        lastR = r;
-        lastG = g;
-        lastB = b;
+        GetShadowValue(ShadowChannelRGB)->Set((r << 16) | (g << 8) | b);
         
         struct
         {
@@ -356,7 +349,7 @@ public:
     
     virtual void UpdateRGBValue(int r, int g, int b) override
     {
-        if(r == lastR && g == lastG && b == lastB)
+        if(GetShadowValue(ShadowChannelRGB)->IsCurrent((r << 16) | (g << 8) | b))
             return;
         
         ForceRGBValue(r, g, b);
@@ -367,20 +360,13 @@ public:
 class FaderportRGB7Bit_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-private:
-    int lastR_ = 0;
-    int lastG_ = 0;
-    int lastB_ = 0;
-    
 public:
     virtual ~FaderportRGB7Bit_Midi_FeedbackProcessor() {}
     FaderportRGB7Bit_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
     virtual void ForceRGBValue(int r, int g, int b) override
     {
-        lastR_ = r;
-        lastG_ = g;
-        lastB_ = b;
+        GetShadowValue(ShadowChannelRGB)->Set((r << 16) | (g << 8) | b);
         
         SendMidiMessage(0x90, midiFeedbackMessage1_->midi_message[1], 0x7f);
         SendMidiMessage(0x91, midiFeedbackMessage1_->midi_message[1], r / 2);  // only 127 bit allowed in Midi byte 3
@@ -390,7 +376,7 @@ public:
 
     virtual void UpdateRGBValue(int r, int g, int b) override
     {
-        if(r == lastR_ && g == lastG_ && b == lastB_)
+        if(GetShadowValue(ShadowChannelRGB)->IsCurrent((r << 16) | (g << 8) | b))
             return;
         
         ForceRGBValue(r, g, b);
@@ -532,7 +518,7 @@ public:
 
     virtual void UpdateValue(double value) override
     {
-        double dB = VAL2DB(normalizedToVol(value)) + 2.5;
+        double dB = VAL2DBFast(normalizedToVolFast(value)) + 2.5;
         
         double midiVal = 0;
         
@@ -679,17 +665,11 @@ private:
     int displayType_ = 0x14;
     int displayRow_ = 0x12;
     int channel_ = 0;
-    string lastStringSent_ = "";
 
 public:
     virtual ~MCUDisplay_Midi_FeedbackProcessor() {}
     MCUDisplay_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int displayUpperLower, int displayType, int displayRow, int channel) : Midi_FeedbackProcessor(surface, widget), offset_(displayUpperLower * 56), displayType_(displayType), displayRow_(displayRow), channel_(channel) { }
     
-    virtual void ClearCache() override
-    {
-        lastStringSent_ = " ";
-    }
-    
     virtual void UpdateValue(string displayText) override
     {
         if(shouldRefresh_)
@@ -703,12 +683,12 @@ public:
         }
         else if( ! mustForce_ && ! isSilent_)
         {
-            if(displayText == lastStringSent_) // no changes since last send
+            if(GetShadowValue(ShadowChannelString)->IsCurrent(displayText)) // no changes since last send
                 return;
         }
         
         if(! isSilent_)
-            lastStringSent_ = displayText;
+            GetShadowValue(ShadowChannelString)->Set(displayText);
         
         int pad = 7;
         const char* text = displayText.c_str();
@@ -758,17 +738,11 @@ class FPDisplay_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
 private:
     int displayType_ = 0x02;
     int channel_ = 0;
-    string lastStringSent_ = " ";
     
 public:
     virtual ~FPDisplay_Midi_FeedbackProcessor() {}
     FPDisplay_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int displayType, int channel) : Midi_FeedbackProcessor(surface, widget), displayType_(displayType), channel_(channel) { }
     
-    virtual void ClearCache() override
-    {
-        lastStringSent_ = " ";
-    }
-        
     virtual void UpdateValue(string displayText) override
     {
         if(shouldRefresh_)
@@ -782,12 +756,12 @@ public:
         }
         else if( ! mustForce_ && ! isSilent_)
         {
-            if(displayText == lastStringSent_) // no changes since last send
+            if(GetShadowValue(ShadowChannelString)->IsCurrent(displayText)) // no changes since last send
                 return;
         }
         
         if(! isSilent_)
-            lastStringSent_ = displayText;
+            GetShadowValue(ShadowChannelString)->Set(displayText);
 
         const char* text = displayText.c_str();
     
@@ -843,122 +817,15 @@ public:
     
     virtual void UpdateValue(double value) override
     {
+        DWORD now = (DWORD)DAW::GetCurrentNumberOfMilliseconds();
         
-#ifndef timeGetTime
-        DWORD now = GetTickCount();
-#else
-        DWORD now = timeGetTime();
-#endif
-        
-        double pp=(GetPlayState()&1) ? GetPlayPosition() : GetCursorPosition();
-        unsigned char bla[10];
-        
-        memset(bla,0,sizeof(bla));
-        
-        int *tmodeptr = TheManager->GetTimeMode2Ptr();
+        // Formatted once a tick for every surface, and only when a digit could have changed
+        TimeDisplayFormatter* timeDisplay = TheManager->GetTimeDisplayFormatter();
         
-        int tmode=0;
+        int tmode = timeDisplay->GetTimeMode();
         
-        if (tmodeptr && (*tmodeptr)>=0) tmode = *tmodeptr;
-        else
-        {
-            tmodeptr = TheManager->GetTimeModePtr();
-            if (tmodeptr)
-                tmode=*tmodeptr;
-        }
-        
-        if (tmode==3) // seconds
-        {
-            double *toptr = TheManager->GetTimeOffsPtr();
-            
-            if (toptr) pp+=*toptr;
-            char buf[64];
-            snprintf(buf, sizeof(buf),"%d %02d",(int)pp, ((int)(pp*100.0))%100);
-            if (strlen(buf)>sizeof(bla)) memcpy(bla,buf+strlen(buf)-sizeof(bla),sizeof(bla));
-            else
-                memcpy(bla+sizeof(bla)-strlen(buf),buf,strlen(buf));
-            
-        }
-        else if (tmode==4) // samples
-        {
-            char buf[128];
-            format_timestr_pos(pp,buf,sizeof(buf),4);
-            if (strlen(buf)>sizeof(bla)) memcpy(bla,buf+strlen(buf)-sizeof(bla),sizeof(bla));
-            else
-                memcpy(bla+sizeof(bla)-strlen(buf),buf,strlen(buf));
-        }
-        else if (tmode==5) // frames
-        {
-            char buf[128];
-            format_timestr_pos(pp,buf,sizeof(buf),5);
-            char *p=buf;
-            char *op=buf;
-            int ccnt=0;
-            while (*p)
-            {
-                if (*p == ':')
-                {
-                    ccnt++;
-                    if (ccnt!=3)
-                    {
-                        p++;
-                        continue;
-                    }
-                    *p=' ';
-                }
-                
-                *op++=*p++;
-            }
-            *op=0;
-            if (strlen(buf)>sizeof(bla)) memcpy(bla,buf+strlen(buf)-sizeof(bla),sizeof(bla));
-            else
-                memcpy(bla+sizeof(bla)-strlen(buf),buf,strlen(buf));
-        }
-        else if (tmode>0)
-        {
-            int num_measures=0;
-            double beats=TimeMap2_timeToBeats(NULL,pp,&num_measures,NULL,NULL,NULL)+ 0.000000000001;
-            double nbeats = floor(beats);
-            
-            beats -= nbeats;
-            
-            int fracbeats = (int) (1000.0 * beats);
-            
-            int *measptr = TheManager->GetMeasOffsPtr();
-            int nm=num_measures+1+(measptr ? *measptr : 0);
-            if (nm >= 100) bla[0]='0'+(nm/100)%10;//bars hund
-            if (nm >= 10) bla[1]='0'+(nm/10)%10;//barstens
-            bla[2]='0'+(nm)%10;//bars
-            
-            int nb=(int)nbeats+1;
-            if (nb >= 10) bla[3]='0'+(nb/10)%10;//beats tens
-            bla[4]='0'+(nb)%10;//beats
-            
-            
-            bla[7]='0' + (fracbeats/100)%10;
-            bla[8]='0' + (fracbeats/10)%10;
-            bla[9]='0' + (fracbeats%10); // frames
-        }
-        else
-        {
-            double *toptr = TheManager->GetTimeOffsPtr();
-            if (toptr) pp+=(*toptr);
-            
-            int ipp=(int)pp;
-            int fr=(int)((pp-ipp)*1000.0);
-            
-            if (ipp >= 360000) bla[0]='0'+(ipp/360000)%10;//hours hundreds
-            if (ipp >= 36000) bla[1]='0'+(ipp/36000)%10;//hours tens
-            if (ipp >= 3600) bla[2]='0'+(ipp/3600)%10;//hours
-            
-            bla[3]='0'+(ipp/600)%6;//min tens
-            bla[4]='0'+(ipp/60)%10;//min
-            bla[5]='0'+(ipp/10)%6;//sec tens
-            bla[6]='0'+(ipp%10);//sec
-            bla[7]='0' + (fr/100)%10;
-            bla[8]='0' + (fr/10)%10;
-            bla[9]='0' + (fr%10); // frames
-        }
+        unsigned char bla[10];
+        memcpy(bla, timeDisplay->GetMCUDigits(), sizeof(bla));
         
         if (m_mackie_lasttime_mode != tmode)
         {
@@ -1182,20 +1049,13 @@ int GetColorIntFromRGB(int r, int g, int b)
 class MFT_RGB_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-private:
-    int lastR = 0;
-    int lastG = 0;
-    int lastB = 0;
-    
 public:
     virtual ~MFT_RGB_Midi_FeedbackProcessor() {}
     MFT_RGB_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
     virtual void ForceRGBValue(int r, int g, int b) override
     {
-        lastR = r;
-        lastG = g;
-        lastB = b;
+        GetShadowValue(ShadowChannelRGB)->Set((r << 16) | (g << 8) | b);
         
         int rgbVal = GetColorIntFromRGB(r, g, b);
         
@@ -1204,7 +1064,7 @@ public:
 
     virtual void UpdateRGBValue(int r, int g, int b) override
     {
-        if(r == lastR && g == lastG && b == lastB)
+        if(GetShadowValue(ShadowChannelRGB)->IsCurrent((r << 16) | (g << 8) | b))
             return;
         
         ForceRGBValue(r, g, b);
@@ -7,7 +7,7 @@
 #ifndef handy_functions_h
 #define handy_functions_h
 
-#include "reaper_plugin_functions.h"
+#include "control_surface_integrator_Reaper.h"
 #include "WDL/db2val.h"
 
 //slope = (output_end - output_start) / (input_end - input_start)
@@ -27,19 +27,145 @@ static double int14ToNormalized(unsigned char msb, unsigned char lsb)
 static double normalizedToVol(double val)
 {
     double pos=val*1000.0;
-    pos=SLIDER2DB(pos);
+    pos=DAW::SLIDER2DB(pos);
     return DB2VAL(pos);
 }
 
 static double volToNormalized(double vol)
 {
-    double d=(DB2SLIDER(VAL2DB(vol))/1000.0);
+    double d=(DAW::DB2SLIDER(VAL2DB(vol))/1000.0);
     if (d<0.0)d=0.0;
     else if (d>1.0)d=1.0;
     
     return d;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Table driven volume conversions
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// normalizedToVol and volToNormalized go through log/exp plus the SLIDER2DB/DB2SLIDER imports, and they get called
+// per widget per tick for volume, send and meter feedback.
+// The fader tables below are sampled from those reference functions, so they track REAPER's fader taper exactly at the sample points.
+// The taper lives inside REAPER and is only reachable after the API is imported, so those two can't be generated at compile time.
+// They are built once, on first use, from the Run() thread -- ~22k reference calls, well under a millisecond.
+// The log2 table doesn't depend on the taper and is constexpr.
+//
+// Error bounds (linear interpolation against the reference, checked by tests/test_volume_tables.cpp):
+//  - normalizedToVolFast -- exact for every 7 bit and 14 bit position (127 divides 16383), < 1e-6 gain in between
+//  - VAL2DBFast -- < 2e-5 dB
+//  - volToNormalizedFast / peakToNormalizedMeter -- < 1e-5 normalized, i.e. well under one 14 bit step
+
+static const int VolumeTableInt14Steps = 16383;
+static const double VolumeTableMinDB = -150.0;
+static const double VolumeTableMaxDB = 24.0;
+static const int VolumeTableStepsPerDB = 32;
+static const int VolumeTableDBSteps = (int)((VolumeTableMaxDB - VolumeTableMinDB) * VolumeTableStepsPerDB);
+static const int VolumeTableMantissaSteps = 512;
+static const double TwentyLog10Of2 = 6.0205999132796239042747778944899;
+
+struct Log2MantissaTable
+{
+    double values[VolumeTableMantissaSteps + 1];
+    
+    // mantissa from frexp is in [0.5, 1.0], ln(m) = 2 atanh((m - 1) / (m + 1)) converges in a few dozen terms there
+    constexpr Log2MantissaTable() : values()
+    {
+        for(int i = 0; i <= VolumeTableMantissaSteps; i++)
+        {
+            double mantissa = 0.5 + 0.5 * i / VolumeTableMantissaSteps;
+            double z = (mantissa - 1.0) / (mantissa + 1.0);
+            double term = z;
+            double sum = 0.0;
+            
+            for(int k = 1; k < 60; k += 2)
+            {
+                sum += term / k;
+                term *= z * z;
+            }
+            
+            values[i] = 2.0 * sum / 0.69314718055994530941723212145818;
+        }
+    }
+};
+
+inline constexpr Log2MantissaTable Log2FromMantissa;
+
+struct VolumeTables
+{
+    double gainFromInt14[VolumeTableInt14Steps + 1];
+    double sliderFromDB[VolumeTableDBSteps + 1];
+    
+    VolumeTables()
+    {
+        for(int i = 0; i <= VolumeTableInt14Steps; i++)
+            gainFromInt14[i] = DB2VAL(DAW::SLIDER2DB(i * 1000.0 / VolumeTableInt14Steps));
+        
+        // unclamped, so interpolation across the top of the fader stays on the curve
+        for(int i = 0; i <= VolumeTableDBSteps; i++)
+            sliderFromDB[i] = DAW::DB2SLIDER(VolumeTableMinDB + (double)i / VolumeTableStepsPerDB) / 1000.0;
+    }
+};
+
+// inline, not static, so every translation unit shares the one ~170KB instance
+inline const VolumeTables& GetVolumeTables()
+{
+    static VolumeTables tables;
+    return tables;
+}
+
+static double normalizedToVolFast(double val)
+{
+    if(val <= 0.0)
+        return GetVolumeTables().gainFromInt14[0];
+    if(val >= 1.0)
+        return GetVolumeTables().gainFromInt14[VolumeTableInt14Steps];
+    
+    double pos = val * VolumeTableInt14Steps;
+    int index = (int)pos;
+    double fraction = pos - index;
+    const double* table = GetVolumeTables().gainFromInt14;
+
+    return fraction == 0.0 ? table[index] : table[index] + fraction * (table[index + 1] - table[index]);
+}
+
+static double VAL2DBFast(double x)
+{
+    if (x < 0.0000000298023223876953125) return -150.0;
+    
+    int exponent = 0;
+    double pos = (frexp(x, &exponent) - 0.5) * 2.0 * VolumeTableMantissaSteps;
+    int index = (int)pos;
+    if(index >= VolumeTableMantissaSteps) index = VolumeTableMantissaSteps - 1;
+    const double* table = Log2FromMantissa.values;
+    
+    double v = (exponent + table[index] + (pos - index) * (table[index + 1] - table[index])) * TwentyLog10Of2;
+    return v<-150.0?-150.0:v;
+}
+
+static double volToNormalizedFast(double vol)
+{
+    double dB = VAL2DBFast(vol);
+    
+    if(dB >= VolumeTableMaxDB)
+        return volToNormalized(vol);
+    
+    double pos = (dB - VolumeTableMinDB) * VolumeTableStepsPerDB;
+    int index = (int)pos;
+    if(index >= VolumeTableDBSteps) index = VolumeTableDBSteps - 1;
+    const double* table = GetVolumeTables().sliderFromDB;
+    
+    double d = table[index] + (pos - index) * (table[index + 1] - table[index]);
+    if (d<0.0)d=0.0;
+    else if (d>1.0)d=1.0;
+    
+    return d;
+}
+
+static double peakToNormalizedMeter(double peak)
+{
+    return volToNormalizedFast(peak);
+}
+
 static double normalizedToPan(double val)
 {
     return 2.0 * val - 1.0;
@@ -53,7 +179,7 @@ static double panToNormalized(double val)
 static double charToVol(unsigned char val)
 {
     double pos=((double)val*1000.0)/127.0;
-    pos=SLIDER2DB(pos);
+    pos=DAW::SLIDER2DB(pos);
     return DB2VAL(pos);
 }
 
@@ -67,14 +193,14 @@ static double int14ToDB(unsigned char msb, unsigned char lsb)
 {
     int val=lsb | (msb<<7);
     double pos=((double)val*1000.0)/16383.0;
-    return SLIDER2DB(pos);
+    return DAW::SLIDER2DB(pos);
 }
 
 static double int14ToVol(unsigned char msb, unsigned char lsb)
 {
     int val=lsb | (msb<<7);
     double pos=((double)val*1000.0)/16383.0;
-    pos=SLIDER2DB(pos);
+    pos=DAW::SLIDER2DB(pos);
     return DB2VAL(pos);
 }
 
@@ -86,7 +212,7 @@ static double int14ToPan(unsigned char msb, unsigned char lsb)
 
 static int volToInt14(double vol)
 {
-    double d=(DB2SLIDER(VAL2DB(vol))*16383.0/1000.0);
+    double d=(DAW::DB2SLIDER(VAL2DB(vol))*16383.0/1000.0);
     if (d<0.0)d=0.0;
     else if (d>16383.0)d=16383.0;
     
@@ -104,7 +230,7 @@ static  int panToInt14(double pan)
 
 static  unsigned char volToChar(double vol)
 {
-    double d=(DB2SLIDER(VAL2DB(vol))*127.0/1000.0);
+    double d=(DAW::DB2SLIDER(VAL2DB(vol))*127.0/1000.0);
     if (d<0.0)d=0.0;
     else if (d>127.0)d=127.0;
     
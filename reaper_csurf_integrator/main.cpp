@@ -36,6 +36,38 @@ gaccel_register_t acreg_write_FX_params =
 
 int g_registered_command_toggle_write_FX_params = 0;
 
+gaccel_register_t acreg_toggle_trace_capture =
+{
+    {FCONTROL|FALT|FVIRTKEY, '5', 0},
+    "CSI Toggle Trace Capture of Surface Input and Output"
+};
+
+int g_registered_command_toggle_trace_capture = 0;
+
+gaccel_register_t acreg_dump_trace =
+{
+    {FCONTROL|FALT|FVIRTKEY, '6', 0},
+    "CSI Dump Trace to /CSI/Trace.txt"
+};
+
+int g_registered_command_dump_trace = 0;
+
+gaccel_register_t acreg_toggle_profiler =
+{
+    {FCONTROL|FALT|FVIRTKEY, '7', 0},
+    "CSI Toggle Latency Profiler (report on stop)"
+};
+
+int g_registered_command_toggle_profiler = 0;
+
+gaccel_register_t acreg_toggle_input_recording =
+{
+    {FCONTROL|FALT|FVIRTKEY, '8', 0},
+    "CSI Toggle Input Recording to /CSI/Recording.csirec"
+};
+
+int g_registered_command_toggle_input_recording = 0;
+
 
 extern bool hookCommandProc(int command, int flag);
 
@@ -106,6 +138,34 @@ REAPER_PLUGIN_DLL_EXPORT int REAPER_PLUGIN_ENTRYPOINT(REAPER_PLUGIN_HINSTANCE hI
         
         reaper_plugin_info->Register("gaccel", &acreg_write_FX_params);
         
+        acreg_toggle_trace_capture.accel.cmd = g_registered_command_toggle_trace_capture = reaper_plugin_info->Register("command_id", (void*)"CSI Toggle Trace Capture of Surface Input and Output");
+        
+        if (!g_registered_command_toggle_trace_capture)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_toggle_trace_capture);
+        
+        acreg_dump_trace.accel.cmd = g_registered_command_dump_trace = reaper_plugin_info->Register("command_id", (void*)"CSI Dump Trace to /CSI/Trace.txt");
+        
+        if (!g_registered_command_dump_trace)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_dump_trace);
+        
+        acreg_toggle_profiler.accel.cmd = g_registered_command_toggle_profiler = reaper_plugin_info->Register("command_id", (void*)"CSI Toggle Latency Profiler (report on stop)");
+        
+        if (!g_registered_command_toggle_profiler)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_toggle_profiler);
+        
+        acreg_toggle_input_recording.accel.cmd = g_registered_command_toggle_input_recording = reaper_plugin_info->Register("command_id", (void*)"CSI Toggle Input Recording to /CSI/Recording.csirec");
+        
+        if (!g_registered_command_toggle_input_recording)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_toggle_input_recording);
+        
 
         reaper_plugin_info->Register("hookcommand", (void*)hookCommandProc);
         
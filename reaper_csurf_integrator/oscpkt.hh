@@ -265,6 +265,23 @@ public:
       }
       return *this;
     }
+    /** retrieve a string argument without copying it, s points into the message storage */
+    ArgReader &popStr(const char *&s) {
+      s = 0;
+      if (precheck(TYPE_TAG_STRING)) {
+        s = argBeg(arg_idx++);
+      }
+      return *this;
+    }
+    /** retrieve a binary blob without copying it, data points into the message storage */
+    ArgReader &popBlob(const char *&data, size_t &size) {
+      data = 0; size = 0;
+      if (precheck(TYPE_TAG_BLOB)) {
+        data = argBeg(arg_idx)+4; size = argEnd(arg_idx) - data;
+        ++arg_idx;
+      }
+      return *this;
+    }
     /** retrieve a binary blob */
     ArgReader &popBlob(std::vector<char> &b) { 
       if (precheck(TYPE_TAG_BLOB)) {
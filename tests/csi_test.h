@@ -0,0 +1,34 @@
+//
+//  csi_test.h
+//  reaper_csurf_integrator
+//
+//  Minimal checks for the headless tests, each test is its own executable and returns non zero on failure
+//
+
+#ifndef csi_test_h
+#define csi_test_h
+
+#include <cstdio>
+#include <cmath>
+
+static int csiTestFailures_ = 0;
+
+#define CSI_CHECK(condition) \
+    do { if( ! (condition)) { csiTestFailures_++; fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); } } while(0)
+
+#define CSI_CHECK_NEAR(actual, expected, tolerance) \
+    do { double csiActual_ = (actual), csiExpected_ = (expected); \
+        if( ! (fabs(csiActual_ - csiExpected_) <= (tolerance))) { csiTestFailures_++; \
+            fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %.9g, expected %.9g +/- %g\n", __FILE__, __LINE__, #actual, csiActual_, csiExpected_, (double)(tolerance)); } } while(0)
+
+static int CSITestResult(const char* name)
+{
+    if(csiTestFailures_ > 0)
+        fprintf(stderr, "%s: %d checks failed\n", name, csiTestFailures_);
+    else
+        printf("%s: passed\n", name);
+    
+    return csiTestFailures_ > 0 ? 1 : 0;
+}
+
+#endif /* csi_test_h */
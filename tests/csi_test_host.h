@@ -0,0 +1,96 @@
+//
+//  csi_test_host.h
+//  reaper_csurf_integrator
+//
+//  Runs a Manager against the in-memory DAW model for the headless tests.
+//  Each test writes its own CSI.ini into a scratch resource tree that shares the Surfaces and Zones under tests/resources.
+//  The benchmarks use it too.
+//
+
+#ifndef csi_test_host_h
+#define csi_test_host_h
+
+#include <filesystem> // ahead of the swell min/max macros
+#include "control_surface_integrator.h"
+
+// One MCU on one page, what most tests run against
+static const string MCUTestIni =
+    "Version 1.1\n"
+    "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+    "MidiSurface MCU 0 0 MCU.mst MCU 8 0 0 0\n";
+
+static string MakeTestResources(string csiIni)
+{
+    char scratch[] = "/tmp/csi_test_XXXXXX";
+    
+    if(mkdtemp(scratch) == nullptr)
+    {
+        fprintf(stderr, "Could not make a scratch resource folder\n");
+        exit(2);
+    }
+    
+    filesystem::copy(string(CSI_TEST_RESOURCES) + "/CSI", string(scratch) + "/CSI", filesystem::copy_options::recursive);
+    
+    ofstream iniFile(string(scratch) + "/CSI/CSI.ini", ios::trunc);
+    iniFile << csiIni;
+    
+    return scratch;
+}
+
+static void AddTestResource(string resourcePath, string relativePath, string contents)
+{
+    ofstream file(resourcePath + "/CSI/" + relativePath, ios::trunc);
+    file << contents;
+}
+
+static void RemoveTestResources(string resourcePath)
+{
+    error_code error;
+    filesystem::remove_all(resourcePath, error);
+}
+
+static void StartManager(string resourcePath)
+{
+    HeadlessDAW::Get().SetResourcePath(resourcePath);
+    TheManager = new Manager(nullptr);
+    TheManager->Init();
+}
+
+static void RunTicks(int numTicks)
+{
+    for(int i = 0; i < numTicks; i++)
+        TheManager->Run();
+}
+
+static void StopManager()
+{
+    TheManager->Shutdown();
+    delete TheManager;
+    TheManager = nullptr;
+}
+
+// Calls to one DAW API since the profiler was last enabled, inside and outside the profiled phases
+static long long DAWCalls(const char* api)
+{
+    long long calls = 0;
+    
+    for(int phase = 0; phase <= NumProfilePhases; phase++)
+        calls += CSIProfiler::GetDAWCalls(phase, CSIProfiler::RegisterDAWApi(api));
+    
+    return calls;
+}
+
+// The 3 byte messages sent on a MIDI output of one type, 0xe0 counts pitch bend on every channel
+static int CountSent(HeadlessMidiOutput* midiOutput, unsigned char type)
+{
+    int count = 0;
+    int position = 0;
+    
+    while(MIDI_event_t* event = midiOutput->GetSentMessages()->EnumItems(&position))
+        if(event->size == 3 && (event->midi_message[0] & 0xf0) == type)
+            count++;
+    
+    return count;
+}
+
+#endif /* csi_test_host_h */
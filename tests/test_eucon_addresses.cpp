@@ -0,0 +1,114 @@
+//
+//  test_eucon_addresses.cpp
+//  reaper_csurf_integrator
+//
+//  EuCon addresses are interned once for both directions: feedback goes out on the widget's address,
+//  Pan and Width labels are left to EuCon, and every PostMessage in a tick runs
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static vector<string> ReadLines(string filePath)
+{
+    vector<string> lines;
+    ifstream file(filePath);
+    string line;
+
+    while(getline(file, line))
+        lines.push_back(line);
+
+    return lines;
+}
+
+static int CountContaining(const vector<string> &lines, string text)
+{
+    int count = 0;
+
+    for(auto &line : lines)
+        if(line.find(text) != string::npos)
+            count++;
+
+    return count;
+}
+
+int main()
+{
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "EuConSurface EuCon EuCon 2 0 0 0\n");
+
+    AddTestResource(resources, "Zones/EuCon/Track.zon",
+                    "Zone Track\n"
+                    "\tTrackNavigator\n"
+                    "\tFader|\t\tTrackVolume\n"
+                    "\tPan_Display|\tTrackPanDisplay\n"
+                    "\tName_Display|\tTrackNameDisplay\n"
+                    "ZoneEnd\n");
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    daw.AddTrack("Kick");
+    daw.AddTrack("Snare");
+
+    StartManager(resources);
+
+    EuCon_ControlSurface* surface = dynamic_cast<EuCon_ControlSurface*>(TheManager->GetCurrentPage()->GetSurface("EuCon"));
+    CSI_CHECK(surface != nullptr);
+
+    vector<CSIWidgetInfo> widgets;
+
+    for(int channel = 1; channel <= 2; channel++)
+    {
+        string number = to_string(channel);
+
+        widgets.push_back(CSIWidgetInfo("Fader" + number, "Fader" + number, "Fader" + number, "Channel", channel, true));
+        widgets.push_back(CSIWidgetInfo("Pan_Display" + number, "", "Pan_Display" + number, "Channel", channel, true));
+        widgets.push_back(CSIWidgetInfo("Name_Display" + number, "", "Name_Display" + number, "Channel", channel, true));
+    }
+
+    CSITrace::SetEnabled(TraceOutput, 0);
+    TheManager->InitializeEuConWidgets(&widgets);
+    TheManager->ReceiveEuConGroupVisibilityChange("Channel", 1, true);
+    TheManager->ReceiveEuConGroupVisibilityChange("Channel", 2, true);
+
+    // One id per address, whichever direction asks, and the special inbound addresses come first
+    CSI_CHECK(surface->InternAddress("PostMessage") == EuConPostMessageAddressId);
+    CSI_CHECK(surface->InternAddress("LayoutChanged") == EuConLayoutChangedAddressId);
+    CSI_CHECK(surface->InternAddress("Fader1") == surface->InternAddress("Fader1"));
+    CSI_CHECK(surface->InternAddress("Fader1") != surface->InternAddress("Fader2"));
+
+    RunTicks(2);
+    CSITrace::DumpToFile(resources + "/CSI/Trace.txt");
+    CSITrace::SetEnabled(0, 0);
+
+    vector<string> trace = ReadLines(resources + "/CSI/Trace.txt");
+
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader1 0.7") == 1);
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Name_Display1 Kick") == 1);
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Name_Display2 Snare") == 1);
+
+    // The zone clears the pan labels with a value, the text TrackPanDisplay would put there never goes out
+    for(auto &line : trace)
+        if(line.find("Pan_Display") != string::npos)
+            CSI_CHECK(line.find(" 0.000000") != string::npos);
+
+    // Commands are not positions, two in one tick both run
+    CSIProfiler::SetEnabled(true);
+
+    TheManager->ReceiveEuConMessage("PostMessage", 40001);
+    TheManager->ReceiveEuConMessage("PostMessage", 40002);
+    TheManager->ReceiveEuConMessage("LayoutChanged", 1.0);
+    RunTicks(1);
+
+    CSI_CHECK(DAWCalls("PostCommandMessage") == 2);
+    CSI_CHECK(DAWCalls("MarkProjectDirty") == 1);
+
+    CSIProfiler::SetEnabled(false);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_eucon_addresses");
+}
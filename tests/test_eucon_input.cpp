@@ -0,0 +1,102 @@
+//
+//  test_eucon_input.cpp
+//  reaper_csurf_integrator
+//
+//  EuCon input merges a fader's positions within a tick, whatever values they are, but never a button's presses,
+//  even one named like a pan control, and an address too long for an input record still arrives whole
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static EuCon_ControlSurface* GetEuConSurface()
+{
+    return dynamic_cast<EuCon_ControlSurface*>(TheManager->GetCurrentPage()->GetSurface("EuCon"));
+}
+
+int main()
+{
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "EuConSurface EuCon EuCon 3 0 0 0\n");
+
+    AddTestResource(resources, "Zones/EuCon/Track.zon",
+                    "Zone Track\n"
+                    "\tTrackNavigator\n"
+                    "\tFader|\t\tTrackVolume\n"
+                    "\tMute|\t\tTrackMute\n"
+                    "\tPanFlip|\tTrackSolo\n"
+                    "ZoneEnd\n");
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 3; i++)
+        daw.AddTrack("Track " + to_string(i + 1))->info_.SetValue("D_VOL", 1.0);
+
+    StartManager(resources);
+
+    EuCon_ControlSurface* surface = GetEuConSurface();
+    CSI_CHECK(surface != nullptr);
+
+    // Longer than EuConInputRecord::address, and sent before the widgets exist so it travels by name rather than id
+    string longAddress = "Fader3" + string(sizeof(EuConInputRecord::address) + 20, 'x');
+    TheManager->ReceiveEuConMessage(longAddress.c_str(), 0.25);
+
+    vector<CSIWidgetInfo> widgets;
+
+    for(int channel = 1; channel <= 3; channel++)
+    {
+        string fader = channel == 3 ? longAddress : "Fader" + to_string(channel);
+
+        widgets.push_back(CSIWidgetInfo("Fader" + to_string(channel), fader, fader, "Channel", channel, true));
+        widgets.push_back(CSIWidgetInfo("Mute" + to_string(channel), "Mute" + to_string(channel), "Mute" + to_string(channel), "Channel", channel, true));
+        widgets.push_back(CSIWidgetInfo("PanFlip" + to_string(channel), "PanFlip" + to_string(channel), "PanFlip" + to_string(channel), "Channel", channel, true));
+    }
+
+    TheManager->InitializeEuConWidgets(&widgets); // as EuCon calls back once it has the surface's layout
+    RunTicks(2);
+
+    CSI_CHECK(daw.tracks_[2]->info_.GetValue("D_VOL") != 1.0);
+
+    // 0.0 and 1.0 are fader positions too, the three moves arrive as one
+    long long coalesced = surface->GetNumInputCoalesced();
+
+    TheManager->ReceiveEuConMessage("Fader2", 0.25);
+    TheManager->ReceiveEuConMessage("Fader1", 0.0);
+    TheManager->ReceiveEuConMessage("Fader1", 1.0);
+    TheManager->ReceiveEuConMessage("Fader1", 0.25);
+    RunTicks(1);
+
+    CSI_CHECK(surface->GetNumInputCoalesced() - coalesced == 2);
+    CSI_CHECK(daw.tracks_[0]->info_.GetValue("D_VOL") == daw.tracks_[1]->info_.GetValue("D_VOL"));
+    CSI_CHECK(daw.tracks_[0]->info_.GetValue("D_VOL") == daw.tracks_[2]->info_.GetValue("D_VOL"));
+
+    // Two presses toggle mute twice, merged they would leave only the last release
+    coalesced = surface->GetNumInputCoalesced();
+
+    TheManager->ReceiveEuConMessage("Mute1", 1.0);
+    TheManager->ReceiveEuConMessage("Mute1", 0.0);
+    TheManager->ReceiveEuConMessage("Mute2", 1.0);
+    TheManager->ReceiveEuConMessage("Mute2", 0.0);
+    TheManager->ReceiveEuConMessage("Mute2", 1.0);
+    TheManager->ReceiveEuConMessage("Mute2", 0.0);
+    RunTicks(1);
+
+    CSI_CHECK(surface->GetNumInputCoalesced() == coalesced);
+    CSI_CHECK(daw.tracks_[0]->info_.GetValue("B_MUTE") != 0.0);
+    CSI_CHECK(daw.tracks_[1]->info_.GetValue("B_MUTE") == 0.0);
+
+    // A button whose name starts like a pan control is still a button, merged its press would be lost to the release
+    TheManager->ReceiveEuConMessage("PanFlip1", 1.0);
+    TheManager->ReceiveEuConMessage("PanFlip1", 0.0);
+    RunTicks(1);
+
+    CSI_CHECK(surface->GetNumInputCoalesced() == coalesced);
+    CSI_CHECK(daw.tracks_[0]->info_.GetValue("I_SOLO") != 0.0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_eucon_input");
+}
@@ -0,0 +1,60 @@
+//
+//  test_eucon_meters.cpp
+//  reaper_csurf_integrator
+//
+//  A meter read on the EuCon thread while Run writes never mixes the level of one tick with the peak of another
+//
+
+#include <thread>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+int main()
+{
+    EuConMeterSnapshot meter;
+    atomic<bool> isReading = { true };
+    atomic<int> numWrites = { 0 };
+
+    // Every write keeps level, peak and clip in step, so any mismatch is a torn read
+    thread writer([&]()
+    {
+        for(int i = 1; isReading; i++)
+        {
+            EuConMeterValues values;
+            values.level = (float)i;
+            values.peak = (float)-i;
+            values.isClipping = (i & 1) != 0;
+            meter.Write(values);
+            numWrites = i;
+        }
+    });
+
+    int numTorn = 0;
+    float lastLevel = -144.0;
+    bool isMonotonic = true;
+
+    while(numWrites < 5000000) // levels stay exact in a float
+    {
+        EuConMeterValues values = meter.Read();
+
+        if(values.level == -144.0) // nothing written yet
+            continue;
+
+        if(values.peak != -values.level || values.isClipping != (((int)values.level & 1) != 0))
+            numTorn++;
+
+        if(values.level < lastLevel)
+            isMonotonic = false;
+
+        lastLevel = values.level;
+    }
+
+    isReading = false;
+    writer.join();
+
+    CSI_CHECK(numTorn == 0);
+    CSI_CHECK(isMonotonic);
+    CSI_CHECK(meter.Read().level == (float)numWrites);
+
+    return CSITestResult("test_eucon_meters");
+}
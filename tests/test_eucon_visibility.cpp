@@ -0,0 +1,133 @@
+//
+//  test_eucon_visibility.cpp
+//  reaper_csurf_integrator
+//
+//  An EuCon surface only updates the general widgets and the channels and subgroups EuCon has made visible,
+//  and the visible counts follow each visibility change
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static vector<string> ReadLines(string filePath)
+{
+    vector<string> lines;
+    ifstream file(filePath);
+    string line;
+
+    while(getline(file, line))
+        lines.push_back(line);
+
+    return lines;
+}
+
+static int CountContaining(const vector<string> &lines, string text)
+{
+    int count = 0;
+
+    for(auto &line : lines)
+        if(line.find(text) != string::npos)
+            count++;
+
+    return count;
+}
+
+static void MoveAllFaders(double volume)
+{
+    for(auto &track : HeadlessDAW::Get().tracks_)
+        track->info_.SetValue("D_VOL", volume);
+}
+
+// The fader feedback one tick sends after every fader moves
+static vector<string> TraceFaderMoves(string resources, double volume)
+{
+    string tracePath = resources + "/CSI/Trace.txt";
+    double since = CSIProfiler::GetTimestamp();
+
+    MoveAllFaders(volume);
+
+    CSITrace::SetEnabled(TraceOutput, 0);
+    RunTicks(1);
+    CSITrace::DumpToFile(tracePath, since);
+    CSITrace::SetEnabled(0, 0);
+
+    return ReadLines(tracePath);
+}
+
+int main()
+{
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "EuConSurface EuCon EuCon 3 0 0 0\n");
+
+    for(int i = 0; i < 3; i++)
+        HeadlessDAW::Get().AddTrack("Track " + to_string(i + 1));
+
+    StartManager(resources);
+
+    EuCon_ControlSurface* surface = dynamic_cast<EuCon_ControlSurface*>(TheManager->GetCurrentPage()->GetSurface("EuCon"));
+    CSI_CHECK(surface != nullptr);
+
+    vector<CSIWidgetInfo> widgets;
+
+    widgets.push_back(CSIWidgetInfo("Play", "Play", "Play", "General", 0, true));
+
+    for(int channel = 1; channel <= 3; channel++)
+    {
+        string number = to_string(channel);
+
+        widgets.push_back(CSIWidgetInfo("Fader" + number, "Fader" + number, "Fader" + number, "Channel", channel, true));
+        widgets.push_back(CSIWidgetInfo("Pan" + number, "Pan" + number, "Pan" + number, "Pan", channel, true));
+    }
+
+    TheManager->InitializeEuConWidgets(&widgets);
+    RunTicks(2);
+
+    // Nothing but the general widgets until EuCon shows a channel
+    CSI_CHECK(surface->GetNumVisibleWidgets() == 1);
+    CSI_CHECK(surface->GetNumVisibleWidgets(1) == 0);
+
+    TheManager->ReceiveEuConGroupVisibilityChange("Channel", 1, true);
+    TheManager->ReceiveEuConGroupVisibilityChange("Channel", 3, true);
+    RunTicks(1);
+
+    CSI_CHECK(surface->GetNumVisibleWidgets() == 3);
+    CSI_CHECK(surface->GetNumVisibleWidgets(1) == 1);
+    CSI_CHECK(surface->GetNumVisibleWidgets(2) == 0);
+
+    // A subgroup shows on every channel at once, but only counts on the visible ones
+    TheManager->ReceiveEuConGroupVisibilityChange("Pan", 0, true);
+    RunTicks(1);
+
+    CSI_CHECK(surface->GetNumVisibleWidgets() == 5);
+    CSI_CHECK(surface->GetNumVisibleWidgets(1) == 2);
+    CSI_CHECK(surface->GetNumVisibleWidgets(1, "Pan") == 1);
+    CSI_CHECK(surface->GetNumVisibleWidgets(2) == 0);
+    CSI_CHECK(surface->GetNumVisibleWidgets(2, "Pan") == 0);
+
+    vector<string> trace = TraceFaderMoves(resources, 0.5);
+
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader1 ") == 1);
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader2 ") == 0);
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader3 ") == 1);
+
+    // Hidden again, channel 3 stops updating and channel 2 catches up as soon as it shows
+    TheManager->ReceiveEuConGroupVisibilityChange("Channel", 3, false);
+    TheManager->ReceiveEuConGroupVisibilityChange("Channel", 2, true);
+    RunTicks(1);
+
+    CSI_CHECK(surface->GetNumVisibleWidgets() == 5);
+    CSI_CHECK(surface->GetNumVisibleWidgets(3) == 0);
+
+    trace = TraceFaderMoves(resources, 0.25);
+
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader1 ") == 1);
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader2 ") == 1);
+    CSI_CHECK(CountContaining(trace, "OUT->EuCon Fader3 ") == 0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_eucon_visibility");
+}
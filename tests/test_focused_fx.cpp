@@ -0,0 +1,101 @@
+//
+//  test_focused_fx.cpp
+//  reaper_csurf_integrator
+//
+//  The focused and last touched FX are asked of the DAW at most once a tick, however many widgets follow them,
+//  and are asked again when the tick ends or REAPER says they changed
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+int main()
+{
+    string resources = MakeTestResources(MCUTestIni);
+
+    // Every V-Pot and scribble strip follows the last touched parameter
+    string home = "Zone Home\n";
+
+    for(int i = 1; i <= 8; i++)
+        home += "\tRotary" + to_string(i) + "\t\tFocusedFXParam\n\tDisplayUpper" + to_string(i) + "\tFocusedFXParamNameDisplay\n";
+
+    AddTestResource(resources, "Zones/MCU/Home.zon", home + "ZoneEnd\n");
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 3; i++)
+        daw.AddFX(daw.AddTrack("Track " + to_string(i + 1)), "VST: ReaEQ (Cockos)", 8);
+
+    // REAPER's 1-based track numbers
+    daw.lastTouchedFXTrackNumber_ = 2;
+    daw.lastTouchedFXIndex_ = 0;
+    daw.lastTouchedFXParamIndex_ = 3;
+
+    daw.focusedFXTrackNumber_ = 3;
+    daw.focusedFXIndex_ = 0;
+
+    StartManager(resources);
+    RunTicks(2);
+
+    TrackNavigationManager* trackNavigationManager = TheManager->GetCurrentPage()->GetTrackNavigationManager();
+
+    // 16 widgets, one question a tick
+    CSIProfiler::SetEnabled(true);
+    RunTicks(10);
+
+    CSI_CHECK(DAWCalls("GetLastTouchedFX") == 10);
+
+    CSIProfiler::SetEnabled(false);
+
+    int fxSlot = -1;
+    int fxParam = -1;
+
+    CSI_CHECK(trackNavigationManager->GetLastTouchedFXTrack(&fxSlot, &fxParam) == daw.tracks_[1].get());
+    CSI_CHECK(fxSlot == 0 && fxParam == 3);
+
+    int fxIndex = -1;
+
+    CSI_CHECK(trackNavigationManager->GetFocusedFXTrack(&fxIndex) == daw.tracks_[2].get());
+    CSI_CHECK(fxIndex == 0);
+
+    // Within a tick the answer stands, even if the DAW has moved on
+    CSIProfiler::SetEnabled(true);
+
+    daw.lastTouchedFXTrackNumber_ = 1;
+    daw.focusedFXIndex_ = -1;
+
+    for(int i = 0; i < 5; i++)
+    {
+        CSI_CHECK(trackNavigationManager->GetLastTouchedFXTrack(&fxSlot, &fxParam) == daw.tracks_[1].get());
+        CSI_CHECK(trackNavigationManager->GetFocusedFXTrack(&fxIndex) == daw.tracks_[2].get());
+    }
+
+    CSI_CHECK(DAWCalls("GetLastTouchedFX") == 0);
+    CSI_CHECK(DAWCalls("GetFocusedFX") == 0);
+
+    // Unless REAPER reports the change
+    TheManager->OnLastTouchedFX();
+    CSI_CHECK(trackNavigationManager->GetLastTouchedFXTrack(&fxSlot, &fxParam) == daw.tracks_[0].get());
+
+    TheManager->OnFXFocus(nullptr, -1);
+    CSI_CHECK(trackNavigationManager->GetFocusedFXTrack(&fxIndex) == nullptr);
+
+    CSI_CHECK(DAWCalls("GetLastTouchedFX") == 1);
+    CSI_CHECK(DAWCalls("GetFocusedFX") == 1);
+
+    CSIProfiler::SetEnabled(false);
+
+    // A new tick asks again
+    daw.lastTouchedFXTrackNumber_ = 3;
+    daw.focusedFXTrackNumber_ = 2;
+    daw.focusedFXIndex_ = 0;
+    RunTicks(1);
+
+    CSI_CHECK(trackNavigationManager->GetLastTouchedFXTrack(&fxSlot, &fxParam) == daw.tracks_[2].get());
+    CSI_CHECK(trackNavigationManager->GetFocusedFXTrack(&fxIndex) == daw.tracks_[1].get());
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_focused_fx");
+}
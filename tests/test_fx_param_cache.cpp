@@ -0,0 +1,100 @@
+//
+//  test_fx_param_cache.cpp
+//  reaper_csurf_integrator
+//
+//  FX param values are read once a tick per slot, names once until the FX list changes,
+//  and formatted values only again once their param has moved
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+int main()
+{
+    HeadlessDAW& daw = HeadlessDAW::Get();
+    MediaTrack* track = daw.AddTrack("Track 1");
+    HeadlessFX* fx = daw.AddFX(track, "VST: ReaEQ (Cockos)", 8);
+
+    for(int i = 0; i < 8; i++)
+        fx->params_[i].value_ = i / 10.0;
+
+    FXParamCache cache;
+    double min = -1.0;
+    double max = -1.0;
+
+    CSIProfiler::SetEnabled(true);
+
+    // A surface showing 4 params asks about each several times a tick, the DAW is asked once
+    for(int i = 0; i < 4; i++)
+    {
+        CSI_CHECK(cache.GetValue(track, 0, i, &min, &max) == i / 10.0);
+        cache.GetValue(track, 0, i, nullptr, nullptr);
+    }
+
+    CSI_CHECK(min == 0.0 && max == 1.0);
+    CSI_CHECK(DAWCalls("TrackFX_GetParam") == 4);
+
+    // Next tick the first ask polls the whole slot
+    fx->params_[3].value_ = 0.9;
+    cache.Invalidate();
+
+    CSI_CHECK(cache.GetValue(track, 0, 0, nullptr, nullptr) == 0.0);
+    CSI_CHECK(DAWCalls("TrackFX_GetParam") == 8);
+
+    for(int i = 1; i < 4; i++)
+        cache.GetValue(track, 0, i, nullptr, nullptr);
+
+    CSI_CHECK(cache.GetValue(track, 0, 3, nullptr, nullptr) == 0.9);
+    CSI_CHECK(DAWCalls("TrackFX_GetParam") == 8);
+
+    // Params no longer shown drop out of the poll
+    cache.Invalidate();
+    cache.GetValue(track, 0, 0, nullptr, nullptr);
+    cache.Invalidate();
+    cache.GetValue(track, 0, 0, nullptr, nullptr);
+
+    CSI_CHECK(DAWCalls("TrackFX_GetParam") == 8 + 4 + 1);
+
+    // Names are kept across ticks
+    CSI_CHECK(string(cache.GetName(track, 0, 1)) == "Param 2");
+
+    fx->params_[1].name_ = "Gain";
+    cache.Invalidate();
+
+    CSI_CHECK(string(cache.GetName(track, 0, 1)) == "Param 2");
+    CSI_CHECK(DAWCalls("TrackFX_GetParamName") == 1);
+
+    // until the track's FX list changes
+    cache.OnFXListChange(track);
+
+    CSI_CHECK(string(cache.GetName(track, 0, 1)) == "Gain");
+    CSI_CHECK(DAWCalls("TrackFX_GetParamName") == 2);
+
+    // Formatted text is asked for once per value
+    CSI_CHECK(string(cache.GetFormattedValue(track, 0, 2)) == "0.20");
+
+    for(int tick = 0; tick < 5; tick++)
+    {
+        cache.Invalidate();
+        cache.GetFormattedValue(track, 0, 2);
+    }
+
+    CSI_CHECK(DAWCalls("TrackFX_GetFormattedParamValue") == 1);
+
+    fx->params_[2].value_ = 0.25;
+    cache.Invalidate();
+
+    CSI_CHECK(string(cache.GetFormattedValue(track, 0, 2)) == "0.25");
+    CSI_CHECK(DAWCalls("TrackFX_GetFormattedParamValue") == 2);
+
+    // Another track's slot 0 is another slot
+    MediaTrack* track2 = daw.AddTrack("Track 2");
+    daw.AddFX(track2, "VST: ReaComp (Cockos)", 4);
+
+    CSI_CHECK(string(cache.GetName(track2, 0, 1)) == "Param 2");
+    CSI_CHECK(cache.GetValue(track2, 0, 1, nullptr, nullptr) == 0.0);
+
+    CSIProfiler::SetEnabled(false);
+
+    return CSITestResult("test_fx_param_cache");
+}
@@ -0,0 +1,104 @@
+//
+//  test_fx_zones.cpp
+//  reaper_csurf_integrator
+//
+//  FX zone files are indexed at startup and parsed on first use, by GoZone as much as by FX activation,
+//  and only the most recently used stay parsed. A file holding more than one Zone is parsed up front, whole.
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static long long NumZoneFilesParsed()
+{
+    return CSIProfiler::GetPhaseStats(ProfileProcessZoneFile).calls;
+}
+
+static string GetFXName(int index)
+{
+    return "VST: TestEQ " + to_string(index + 1) + " (Test)";
+}
+
+int main()
+{
+    string resources = MakeTestResources(MCUTestIni);
+
+    int numFXZones = ControlSurface::MaxResidentFXZones + 1;
+
+    // A comment and a blank line ahead of the Zone line don't stop a file being indexed
+    for(int fx = 0; fx < numFXZones; fx++)
+        AddTestResource(resources, "Zones/MCU/TestEQ" + to_string(fx + 1) + ".zon",
+                        "// TestEQ on the V-Pots\n"
+                        "\n"
+                        "Zone \"" + GetFXName(fx) + "\"\n"
+                        "\tSelectedTrackNavigator\n"
+                        "\tRotary1\t\tFXParam 0\n"
+                        "ZoneEnd\n");
+
+    // Led by an ordinary Zone, so parsed up front with the FX Zone that follows it
+    AddTestResource(resources, "Zones/MCU/Buttons.zon",
+                    "Zone Buttons\n"
+                    "\tSelectedTrackNavigator\n"
+                    "ZoneEnd\n"
+                    "Zone \"VST: Buttons FX (Test)\"\n"
+                    "\tSelectedTrackNavigator\n"
+                    "ZoneEnd\n");
+
+    // Two FX Zones in one file, parsed up front so the second can be found before the first is used
+    AddTestResource(resources, "Zones/MCU/Pair.zon",
+                    "Zone \"VST: Pair A (Test)\"\n"
+                    "\tSelectedTrackNavigator\n"
+                    "ZoneEnd\n"
+                    "// The second of the pair\n"
+                    "Zone \"VST: Pair B (Test)\"\n"
+                    "\tSelectedTrackNavigator\n"
+                    "ZoneEnd\n");
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    daw.AddTrack("Track 1");
+
+    CSIProfiler::SetEnabled(true);
+    StartManager(resources);
+    RunTicks(1);
+
+    ControlSurface* surface = TheManager->GetCurrentPage()->GetSurface("MCU");
+    CSI_CHECK(surface != nullptr);
+
+    // Home, Track, Buttons and Pair
+    CSI_CHECK(NumZoneFilesParsed() == 4);
+    CSI_CHECK(surface->GetZoneTemplate("Buttons") != nullptr);
+    CSI_CHECK(surface->GetZoneTemplate("VST: Buttons FX (Test)") != nullptr);
+    CSI_CHECK(surface->GetZoneTemplate("VST: Pair B (Test)") != nullptr);
+    CSI_CHECK(surface->GetZoneTemplate("VST: Pair A (Test)") != nullptr);
+    CSI_CHECK(NumZoneFilesParsed() == 4);
+
+    surface->GoZone(GetFXName(0));
+    CSI_CHECK(NumZoneFilesParsed() == 5);
+
+    CSI_CHECK(surface->GetZoneTemplate(GetFXName(0)) != nullptr);
+    CSI_CHECK(NumZoneFilesParsed() == 5);
+
+    // One more than stays resident pushes out the least recently used, which is parsed again when next asked for
+    for(int fx = 1; fx < numFXZones; fx++)
+        CSI_CHECK(surface->GetZoneTemplate(GetFXName(fx)) != nullptr);
+
+    CSI_CHECK(NumZoneFilesParsed() == 4 + numFXZones);
+
+    CSI_CHECK(surface->GetZoneTemplate(GetFXName(numFXZones - 1)) != nullptr);
+    CSI_CHECK(NumZoneFilesParsed() == 4 + numFXZones);
+
+    CSI_CHECK(surface->GetZoneTemplate(GetFXName(0)) != nullptr);
+    CSI_CHECK(NumZoneFilesParsed() == 5 + numFXZones);
+
+    // The pair was never dropped, so never parsed again or added twice
+    CSI_CHECK(surface->GetZoneTemplate("VST: Pair A (Test)") != nullptr);
+    CSI_CHECK(NumZoneFilesParsed() == 5 + numFXZones);
+    CSI_CHECK(daw.console_.find("already has a Zone named") == string::npos);
+
+    CSIProfiler::SetEnabled(false);
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_fx_zones");
+}
@@ -0,0 +1,114 @@
+//
+//  test_latency.cpp
+//  reaper_csurf_integrator
+//
+//  Each input's action and the feedback it causes are timed from when the input arrived,
+//  feedback nobody asked for is not, and the report and Profile.json show them
+//
+
+#include <sstream>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+// The Count column of the report line for name
+static int GetReportedCount(const string &report, const string &name)
+{
+    istringstream lines(report);
+    string line;
+
+    while(getline(lines, line))
+    {
+        istringstream columns(line);
+        string surface;
+        string column;
+        int count = -1;
+
+        if(columns >> surface >> column >> count && surface == "MCU" && column == name)
+            return count;
+    }
+
+    return -1;
+}
+
+static void TestHistogram()
+{
+    LatencyHistogram histogram;
+
+    for(int i = 0; i < 90; i++)
+        histogram.Add(0.1);     // under 0.125ms
+
+    for(int i = 0; i < 9; i++)
+        histogram.Add(3.0);     // 2 - 4ms
+
+    histogram.Add(1000.0);      // the catch all
+
+    CSI_CHECK(histogram.count == 100);
+    CSI_CHECK(histogram.buckets[0] == 90);
+    CSI_CHECK(histogram.buckets[5] == 9);
+    CSI_CHECK(histogram.buckets[LatencyHistogram::NumBuckets - 1] == 1);
+    CSI_CHECK(histogram.maximum == 1000.0);
+    CSI_CHECK(histogram.GetPercentile(0.5) == 0.125);
+    CSI_CHECK(histogram.GetPercentile(0.95) == 4.0);
+    CSI_CHECK(histogram.GetPercentile(0.999) == 1000.0);
+}
+
+int main()
+{
+    TestHistogram();
+
+    string resources = MakeTestResources(MCUTestIni);
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Track " + to_string(i + 1));
+
+    HeadlessMidiInput* midiInput = daw.GetMidiInput(0);
+
+    StartManager(resources);
+    RunTicks(3);
+
+    daw.console_ = "";
+    TheManager->ToggleProfiler();
+
+    // Five fader moves, each moves the fader back
+    for(int i = 0; i < 5; i++)
+    {
+        midiInput->QueueMessage(0xe0, 0x00, 0x20 + i * 8);
+        RunTicks(1);
+    }
+
+    // A Mute press and release, two actions and one LED change
+    midiInput->QueueMessage(0x90, 0x10, 0x7f);
+    midiInput->QueueMessage(0x90, 0x10, 0x00);
+    RunTicks(1);
+
+    // Feedback for a change made in REAPER has no input to be timed from
+    daw.tracks_[1]->info_.SetValue("D_VOL", 0.25);
+    RunTicks(2);
+
+    TheManager->ToggleProfiler();
+
+    CSI_CHECK(GetReportedCount(daw.console_, "TrackVolume") == 5);
+    CSI_CHECK(GetReportedCount(daw.console_, "TrackMute") == 2);
+    CSI_CHECK(GetReportedCount(daw.console_, "Feedback") == 6);
+
+    JSONValue profile;
+
+    CSI_CHECK(JSONValue::ReadFile(resources + "/CSI/Profile.json", profile));
+
+    const JSONValue* phases = profile.Find("phases");
+    double runCalls = 0.0;
+
+    if(phases != nullptr)
+        for(auto &phase : phases->elements)
+            if(phase.GetString("phase") == "Run")
+                runCalls = phase.GetNumber("calls");
+
+    CSI_CHECK(runCalls == 8.0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_latency");
+}
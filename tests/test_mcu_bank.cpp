@@ -0,0 +1,99 @@
+//
+//  test_mcu_bank.cpp
+//  reaper_csurf_integrator
+//
+//  Banking an MCU shows the next 8 tracks on the emulated device, and only the faders, LEDs and scribble strips that differ are sent
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+#include "handy_functions.h"
+
+static int FaderPosition(MediaTrack* track)
+{
+    return (int)(volToNormalized(track->info_.GetValue("D_VOL")) * 16383.0);
+}
+
+// Fader, Mute LED and scribble strip of each strip show the bank starting at firstTrack
+static void CheckBank(MCUEmulator &emulator, int firstTrack)
+{
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int channel = 0; channel < 8; channel++)
+    {
+        MediaTrack* track = daw.tracks_[firstTrack + channel].get();
+
+        CSI_CHECK_NEAR(emulator.GetFader(channel), FaderPosition(track), 1);
+        CSI_CHECK(emulator.IsLEDOn(0x10 + channel) == (track->info_.GetValue("B_MUTE") != 0.0));
+        CSI_CHECK(emulator.GetDisplayCell(0, 0, channel).find("Trk" + to_string(firstTrack + channel + 1)) == 0);
+    }
+}
+
+static void PressButton(HeadlessMidiInput* midiInput, int note)
+{
+    midiInput->QueueMessage(0x90, note, 0x7f);
+    midiInput->QueueMessage(0x90, note, 0x00);
+    RunTicks(1);
+}
+
+int main()
+{
+    string resources = MakeTestResources(MCUTestIni);
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 16; i++)
+    {
+        MediaTrack* track = daw.AddTrack("Trk" + to_string(i + 1));
+        track->info_.SetValue("D_VOL", 0.1 + i * 0.05);
+        track->info_.SetValue("B_MUTE", i % 3 == 0 ? 1.0 : 0.0);
+    }
+
+    MCUEmulator emulator;
+    HeadlessMidiOutput* midiOutput = daw.GetMidiOutput(0);
+    midiOutput->AttachEmulator(&emulator);
+    HeadlessMidiInput* midiInput = daw.GetMidiInput(0);
+
+    StartManager(resources);
+    RunTicks(3);
+
+    CheckBank(emulator, 0);
+
+    emulator.ResetCounters();
+    PressButton(midiInput, 0x2f); // BankRight
+    RunTicks(1);
+
+    CheckBank(emulator, 8);
+
+    // Every volume in the second bank differs from the first, so each fader moves exactly once
+    CSI_CHECK(emulator.GetTotals(MCUFader).messages == 8);
+    CSI_CHECK(emulator.GetTotals(MCUFader).redundantMessages == 0);
+    CSI_CHECK(emulator.GetTotals(MCUDisplay).messages > 0);
+
+    // Tracks 1 and 9, 4 and 12, 7 and 15 are not all muted alike, only the Mute LEDs that change are sent
+    int ledChanges = 0;
+
+    for(int channel = 0; channel < 8; channel++)
+        if((channel % 3 == 0) != ((channel + 8) % 3 == 0))
+            ledChanges++;
+
+    CSI_CHECK(emulator.GetTotals(MCULED).messages - emulator.GetTotals(MCULED).redundantMessages == ledChanges);
+
+    // Past the last bank nothing moves
+    emulator.ResetCounters();
+    PressButton(midiInput, 0x2f);
+    RunTicks(1);
+
+    CheckBank(emulator, 8);
+    CSI_CHECK(emulator.GetTotals(MCUFader).messages == 0);
+
+    PressButton(midiInput, 0x2e); // BankLeft
+    RunTicks(1);
+
+    CheckBank(emulator, 0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_mcu_bank");
+}
@@ -0,0 +1,81 @@
+//
+//  test_osc_address_matcher.cpp
+//  reaper_csurf_integrator
+//
+//  OSC addresses find their widgets through the matcher: exact addresses first, then template patterns,
+//  and an incoming pattern reaches every literal address it covers
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static vector<int> Match(OSCAddressMatcher &matcher, string address, int maxAddressIds = MaxOSCMatches)
+{
+    int addressIds[MaxOSCMatches];
+    int count = matcher.Match(address, addressIds, maxAddressIds);
+
+    vector<int> matches(addressIds, addressIds + count);
+    sort(matches.begin(), matches.end());
+
+    return matches;
+}
+
+int main()
+{
+    OSCAddressMatcher matcher;
+
+    matcher.Add("/Fader1", 1);
+    matcher.Add("/Fader2", 2);
+    matcher.Add("/Fader10", 10);
+    matcher.Add("/Mute1", 11);
+    matcher.Add("/track/1/pan", 20);
+    matcher.Add("/track/*/pan", 21);
+    matcher.Add("/track/?/volume", 22);
+    matcher.Add("/bank/[a-c]", 23);
+    matcher.Add("/page/[!0-9]", 24);
+    matcher.Add("/button/{play,stop}", 25);
+
+    // Exact addresses
+    CSI_CHECK(Match(matcher, "/Fader1") == vector<int>({ 1 }));
+    CSI_CHECK(Match(matcher, "/Fader10") == vector<int>({ 10 }));
+    CSI_CHECK(Match(matcher, "/Fader3").empty());
+    CSI_CHECK(Match(matcher, "/Fader").empty());
+    CSI_CHECK(Match(matcher, "/Fader1/extra").empty());
+
+    // An exact address wins over the template that also covers it
+    CSI_CHECK(Match(matcher, "/track/1/pan") == vector<int>({ 20 }));
+    CSI_CHECK(Match(matcher, "/track/7/pan") == vector<int>({ 21 }));
+    CSI_CHECK(Match(matcher, "/track/7/8/pan").empty()); // * stays inside one segment
+
+    CSI_CHECK(Match(matcher, "/track/3/volume") == vector<int>({ 22 }));
+    CSI_CHECK(Match(matcher, "/track/12/volume").empty());
+
+    CSI_CHECK(Match(matcher, "/bank/b") == vector<int>({ 23 }));
+    CSI_CHECK(Match(matcher, "/bank/d").empty());
+
+    CSI_CHECK(Match(matcher, "/page/x") == vector<int>({ 24 }));
+    CSI_CHECK(Match(matcher, "/page/5").empty());
+
+    CSI_CHECK(Match(matcher, "/button/play") == vector<int>({ 25 }));
+    CSI_CHECK(Match(matcher, "/button/stop") == vector<int>({ 25 }));
+    CSI_CHECK(Match(matcher, "/button/record").empty());
+
+    // An incoming pattern addresses every literal widget address it matches, templates are not matched against it
+    CSI_CHECK(Match(matcher, "/Fader*") == vector<int>({ 1, 2, 10 }));
+    CSI_CHECK(Match(matcher, "/Fader?") == vector<int>({ 1, 2 }));
+    CSI_CHECK(Match(matcher, "/{Fader,Mute}1") == vector<int>({ 1, 11 }));
+    CSI_CHECK(Match(matcher, "/Fader[!1]").size() == 1);
+    CSI_CHECK(Match(matcher, "/track/*/pan") == vector<int>({ 20 }));
+    CSI_CHECK(Match(matcher, "/Pan*").empty());
+
+    // No more ids than the caller has room for
+    CSI_CHECK(Match(matcher, "/Fader*", 2).size() == 2);
+    CSI_CHECK(Match(matcher, "/Fader1", 0).empty());
+
+    matcher.Clear();
+
+    CSI_CHECK(Match(matcher, "/Fader1").empty());
+    CSI_CHECK(Match(matcher, "/Fader*").empty());
+
+    return CSITestResult("test_osc_address_matcher");
+}
@@ -0,0 +1,144 @@
+//
+//  test_osc_arguments.cpp
+//  reaper_csurf_integrator
+//
+//  OSCArguments keeps doubles at full precision and flags a string argument that didn't fit,
+//  and a blob argument never reaches the widget bound to it as a value
+//
+
+#include <unistd.h>
+#include <thread>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static OSCArguments ReadMessage(oscpkt::Message &message)
+{
+    // Through the wire format, as the OSC input thread sees it
+    oscpkt::PacketWriter packetWriter;
+    packetWriter.init().addMessage(message);
+
+    oscpkt::PacketReader packetReader(packetWriter.packetData(), packetWriter.packetSize());
+
+    OSCArguments arguments;
+
+    if(oscpkt::Message* decoded = packetReader.popMessage())
+        arguments.Read(*decoded);
+
+    return arguments;
+}
+
+static void SendOSC(oscpkt::UdpSocket &socket, oscpkt::Message &message)
+{
+    oscpkt::PacketWriter packetWriter;
+    packetWriter.init().addMessage(message);
+
+    socket.sendPacket(packetWriter.packetData(), packetWriter.packetSize());
+}
+
+// Input arrives on the OSC input thread, so give it a moment
+static bool WaitForVolume(MediaTrack* track, double unchangedVolume)
+{
+    for(int i = 0; i < 100; i++)
+    {
+        RunTicks(1);
+
+        if(track->info_.GetValue("D_VOL") != unchangedVolume)
+            return true;
+
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    return false;
+}
+
+int main()
+{
+    const double position = 0.123456789012345; // a float would hold about 7 of these digits
+
+    oscpkt::Message numbers("/track/1/position");
+    numbers.pushDouble(position).pushInt32(-3).pushFloat(0.5f).pushBool(true).pushInt64(1LL << 40);
+
+    OSCArguments arguments = ReadMessage(numbers);
+
+    CSI_CHECK(arguments.numArguments == 5);
+    CSI_CHECK(arguments.values[0] == position);
+    CSI_CHECK(arguments.values[1] == -3.0);
+    CSI_CHECK(arguments.values[2] == 0.5);
+    CSI_CHECK(arguments.values[3] == 1.0);
+    CSI_CHECK(arguments.values[4] == (double)(1LL << 40));
+    CSI_CHECK(arguments.stringArgumentIndex == -1);
+
+    for(int i = 0; i < 5; i++)
+        CSI_CHECK(arguments.isNumeric[i]);
+
+    string name = "Lead Vocal Double (Comp, De-esser, Plate)"; // over the old 48 character limit
+
+    oscpkt::Message shortString("/track/1/name");
+    shortString.pushStr(name);
+
+    arguments = ReadMessage(shortString);
+
+    CSI_CHECK(arguments.stringArgumentIndex == 0);
+    CSI_CHECK( ! arguments.isStringTruncated);
+    CSI_CHECK(string(arguments.stringValue) == name);
+
+    oscpkt::Message longString("/track/1/name");
+    longString.pushFloat(1.0f).pushStr(string(sizeof(arguments.stringValue) + 10, 'x'));
+
+    arguments = ReadMessage(longString);
+
+    CSI_CHECK(arguments.numArguments == 2);
+    CSI_CHECK(arguments.stringArgumentIndex == 1);
+    CSI_CHECK(arguments.isStringTruncated);
+    CSI_CHECK(strlen(arguments.stringValue) == sizeof(arguments.stringValue) - 1);
+
+    // A blob holds its place among the arguments, but is no number
+    const char bytes[4] = { 1, 2, 3, 4 };
+
+    oscpkt::Message blob("/Fader1");
+    blob.pushBlob((void*)bytes, sizeof(bytes)).pushStr("Kick").pushFloat(0.25f);
+
+    arguments = ReadMessage(blob);
+
+    CSI_CHECK(arguments.numArguments == 3);
+    CSI_CHECK( ! arguments.isNumeric[0]);
+    CSI_CHECK( ! arguments.isNumeric[1]);
+    CSI_CHECK(arguments.isNumeric[2]);
+
+    // So a fader sent one doesn't jump to the bottom
+    int inPort = 20000 + 4 * (getpid() % 10000);
+
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "OSCSurface OSC " + to_string(inPort) + " " + to_string(inPort + 1) + " Strip.ost OSC 8 0 0 0 127.0.0.1,\n");
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Track " + to_string(i + 1))->info_.SetValue("D_VOL", 1.0);
+
+    StartManager(resources);
+    RunTicks(2);
+
+    oscpkt::UdpSocket device;
+    device.connectTo("127.0.0.1", inPort);
+    CSI_CHECK(device.isOk());
+
+    oscpkt::Message blobOnly("/Fader1");
+    blobOnly.pushBlob((void*)bytes, sizeof(bytes));
+    SendOSC(device, blobOnly);
+
+    // Handled in order, so once Fader2 has moved the blob has been too
+    oscpkt::Message fader("/Fader2");
+    fader.pushFloat(0.25f);
+    SendOSC(device, fader);
+
+    CSI_CHECK(WaitForVolume(daw.tracks_[1].get(), 1.0));
+    CSI_CHECK(daw.tracks_[0]->info_.GetValue("D_VOL") == 1.0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_osc_arguments");
+}
@@ -0,0 +1,112 @@
+//
+//  test_osc_bundles.cpp
+//  reaper_csurf_integrator
+//
+//  OSC feedback goes out as one bundle per surface per tick, split so no packet is bigger than the surface's
+//  max packet size, and a tick with nothing new sends nothing
+//
+
+#include <unistd.h>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+struct ReceivedPackets
+{
+    int packets = 0;
+    int faders = 0;
+    int maxPacketSize = 0;
+};
+
+static ReceivedPackets Receive(oscpkt::UdpSocket &socket)
+{
+    ReceivedPackets received;
+    oscpkt::PacketReader packetReader;
+
+    while(socket.receiveNextPacket(50))
+    {
+        received.packets++;
+        received.maxPacketSize = max(received.maxPacketSize, (int)socket.packetSize());
+
+        packetReader.init(socket.packetData(), socket.packetSize());
+
+        while(oscpkt::Message* message = packetReader.popMessage())
+            if(message->addressPattern().rfind("/Fader", 0) == 0)
+                received.faders++;
+    }
+
+    return received;
+}
+
+static void MoveAllFaders(double volume)
+{
+    for(auto &track : HeadlessDAW::Get().tracks_)
+        track->info_.SetValue("D_VOL", volume);
+}
+
+int main()
+{
+    int inPort = 20000 + 4 * (getpid() % 10000);
+    int smallInPort = inPort + 2;
+    const int smallPacketSize = 100; // room for the bundle header and 4 fader messages
+
+    // Client lists, so the surfaces send from an unbound socket and the test can listen on the display ports
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "OSCSurface OSC " + to_string(inPort) + " " + to_string(inPort + 1) + " Strip.ost OSC 8 0 0 0 127.0.0.1,\n"
+        "OSCSurface Small " + to_string(smallInPort) + " " + to_string(smallInPort + 1) + " Strip.ost OSC 8 0 0 0 127.0.0.1, " + to_string(smallPacketSize) + "\n");
+
+    // The second surface's strips follow on from the first's
+    for(int i = 0; i < 16; i++)
+        HeadlessDAW::Get().AddTrack("Track " + to_string(i + 1));
+
+    oscpkt::UdpSocket display;
+    display.bindTo(inPort + 1);
+    CSI_CHECK(display.isOk());
+
+    oscpkt::UdpSocket smallDisplay;
+    smallDisplay.bindTo(smallInPort + 1);
+    CSI_CHECK(smallDisplay.isOk());
+
+    StartManager(resources);
+    RunTicks(2);
+
+    Receive(display);
+    Receive(smallDisplay);
+
+    // Every fader moves in one tick, one datagram carries them all
+    MoveAllFaders(0.5);
+    RunTicks(1);
+
+    ReceivedPackets received = Receive(display);
+
+    CSI_CHECK(received.packets == 1);
+    CSI_CHECK(received.faders == 8);
+
+    // The same 8 in packets of at most smallPacketSize bytes
+    received = Receive(smallDisplay);
+
+    CSI_CHECK(received.packets == 2);
+    CSI_CHECK(received.faders == 8);
+    CSI_CHECK(received.maxPacketSize <= smallPacketSize);
+
+    // Nothing changed, nothing sent
+    RunTicks(2);
+
+    CSI_CHECK(Receive(display).packets == 0);
+    CSI_CHECK(Receive(smallDisplay).packets == 0);
+
+    // One fader, one small packet
+    HeadlessDAW::Get().tracks_[3]->info_.SetValue("D_VOL", 0.25);
+    RunTicks(1);
+
+    received = Receive(display);
+
+    CSI_CHECK(received.packets == 1);
+    CSI_CHECK(received.faders == 1);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_osc_bundles");
+}
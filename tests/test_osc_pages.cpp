@@ -0,0 +1,120 @@
+//
+//  test_osc_pages.cpp
+//  reaper_csurf_integrator
+//
+//  Pages share an OSC surface's socket, input goes to the surface on the page that is up, not the last one to register,
+//  and a surface resends its whole state to the device when its page comes back
+//
+
+#include <unistd.h>
+#include <thread>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static void SendOSC(oscpkt::UdpSocket &socket, string address, float value)
+{
+    oscpkt::Message message(address);
+    message.pushFloat(value);
+
+    oscpkt::PacketWriter packetWriter;
+    packetWriter.init().addMessage(message);
+
+    socket.sendPacket(packetWriter.packetData(), packetWriter.packetSize());
+}
+
+// Input arrives on the OSC input thread, so give it a moment
+static bool WaitForVolume(MediaTrack* track, double unchangedVolume)
+{
+    for(int i = 0; i < 100; i++)
+    {
+        RunTicks(1);
+
+        if(track->info_.GetValue("D_VOL") != unchangedVolume)
+            return true;
+
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    return false;
+}
+
+// Fader messages that reached the device, bundles unpacked
+static int CountReceivedFaders(oscpkt::UdpSocket &socket)
+{
+    int count = 0;
+    oscpkt::PacketReader packetReader;
+
+    while(socket.receiveNextPacket(50))
+    {
+        packetReader.init(socket.packetData(), socket.packetSize());
+
+        while(oscpkt::Message* message = packetReader.popMessage())
+            if(message->addressPattern().rfind("/Fader", 0) == 0)
+                count++;
+    }
+
+    return count;
+}
+
+int main()
+{
+    int inPort = 20000 + getpid() % 20000;
+    string surface = "OSCSurface OSC " + to_string(inPort) + " " + to_string(inPort + 1) + " Strip.ost OSC 8 0 0 0 127.0.0.1,\n"; // a client list, a connected socket would bind the display's port
+
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"One\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n" + surface +
+        "Page \"Two\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n" + surface);
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Track " + to_string(i + 1))->info_.SetValue("D_VOL", 1.0);
+
+    oscpkt::UdpSocket display;
+    display.bindTo(inPort + 1);
+    CSI_CHECK(display.isOk());
+
+    StartManager(resources);
+    RunTicks(2);
+
+    oscpkt::UdpSocket device;
+    device.connectTo("127.0.0.1", inPort);
+    CSI_CHECK(device.isOk());
+
+    // Page One is up at startup, although page Two's surface registered on the socket after it
+    SendOSC(device, "/Fader1", 0.25);
+    CSI_CHECK(WaitForVolume(daw.tracks_[0].get(), 1.0));
+
+    TheManager->GoToPage("Two");
+    SendOSC(device, "/Fader2", 0.25);
+    CSI_CHECK(WaitForVolume(daw.tracks_[1].get(), 1.0));
+
+    TheManager->GoToPage("One");
+    SendOSC(device, "/Fader3", 0.25);
+    CSI_CHECK(WaitForVolume(daw.tracks_[2].get(), 1.0));
+
+    // Nothing left over from page One's earlier turn, or from page Two, is replayed
+    for(int i = 3; i < 8; i++)
+        CSI_CHECK(daw.tracks_[i]->info_.GetValue("D_VOL") == 1.0);
+
+    // Page Two drove the display last, so page One sends every fader again although none has moved since it last did
+    RunTicks(2);
+    TheManager->GoToPage("Two");
+    RunTicks(2);
+    CountReceivedFaders(display);
+
+    TheManager->GoToPage("One");
+    RunTicks(2);
+
+    CSI_CHECK(CountReceivedFaders(display) == 8);
+
+    RunTicks(2);
+
+    CSI_CHECK(CountReceivedFaders(display) == 0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_osc_pages");
+}
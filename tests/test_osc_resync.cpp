@@ -0,0 +1,139 @@
+//
+//  test_osc_resync.cpp
+//  reaper_csurf_integrator
+//
+//  An OSC client gets the surface's whole state again when it asks with /csi/resync or a zone loads,
+//  the zone address first, each value once and as it stands when the tick ends
+//
+
+#include <unistd.h>
+#include <thread>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static vector<string> Receive(oscpkt::UdpSocket &socket)
+{
+    vector<string> addresses;
+    oscpkt::PacketReader packetReader;
+
+    while(socket.receiveNextPacket(50))
+    {
+        packetReader.init(socket.packetData(), socket.packetSize());
+
+        while(oscpkt::Message* message = packetReader.popMessage())
+            addresses.push_back(message->addressPattern());
+    }
+
+    return addresses;
+}
+
+static int CountFaders(const vector<string> &addresses, string prefix = "/Fader")
+{
+    int count = 0;
+
+    for(auto &address : addresses)
+        if(address.rfind(prefix, 0) == 0)
+            count++;
+
+    return count;
+}
+
+static void SendOSC(oscpkt::UdpSocket &socket, oscpkt::Message &message)
+{
+    oscpkt::PacketWriter packetWriter;
+    packetWriter.init().addMessage(message);
+
+    socket.sendPacket(packetWriter.packetData(), packetWriter.packetSize());
+}
+
+// Input arrives on the OSC input thread, so give it a moment
+static vector<string> WaitForFeedback(oscpkt::UdpSocket &socket)
+{
+    for(int i = 0; i < 100; i++)
+    {
+        RunTicks(1);
+
+        vector<string> addresses = Receive(socket);
+
+        if(addresses.size() > 0)
+            return addresses;
+
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+
+    return vector<string>();
+}
+
+int main()
+{
+    int inPort = 20000 + 4 * (getpid() % 10000);
+
+    // A client list, so the surface sends from an unbound socket and the test can listen on the display port
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"Home\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "OSCSurface OSC " + to_string(inPort) + " " + to_string(inPort + 1) + " Strip.ost OSC 8 0 0 0 127.0.0.1,\n");
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Track " + to_string(i + 1))->info_.SetValue("D_VOL", 0.1 + i * 0.1);
+
+    oscpkt::UdpSocket display;
+    display.bindTo(inPort + 1);
+    CSI_CHECK(display.isOk());
+
+    StartManager(resources);
+    RunTicks(2);
+    Receive(display);
+
+    oscpkt::UdpSocket device;
+    device.connectTo("127.0.0.1", inPort);
+    CSI_CHECK(device.isOk());
+
+    // The configured client is heard from for the first time, which is a resync of its own, even for a message no widget takes
+    oscpkt::Message unknown("/Unknown");
+    unknown.pushFloat(1.0f);
+    SendOSC(device, unknown);
+
+    vector<string> addresses = WaitForFeedback(display);
+
+    CSI_CHECK(addresses.size() > 0 && addresses[0] == "/Home");
+    CSI_CHECK(CountFaders(addresses) == 8);
+
+    RunTicks(2);
+    CSI_CHECK(Receive(display).empty());
+
+    // Nothing has moved, /csi/resync with no arguments still gets every fader
+    oscpkt::Message resync(OSCResyncAddress);
+    SendOSC(device, resync);
+
+    addresses = WaitForFeedback(display);
+
+    CSI_CHECK(CountFaders(addresses) == 8);
+
+    for(int i = 1; i <= 8; i++)
+        CSI_CHECK(CountFaders(addresses, "/Fader" + to_string(i)) == 1);
+
+    RunTicks(2);
+    CSI_CHECK(Receive(display).empty());
+
+    // A zone load sends the zone address ahead of the state, a fader that moves in the same tick still goes out once
+    TheManager->GetCurrentPage()->GetSurface("OSC")->LoadingZone("Home");
+    daw.tracks_[2]->info_.SetValue("D_VOL", 0.75);
+    RunTicks(1);
+
+    addresses = Receive(display);
+
+    CSI_CHECK(addresses.size() > 0 && addresses[0] == "/Home");
+    CSI_CHECK(CountFaders(addresses) == 8);
+    CSI_CHECK(CountFaders(addresses, "/Fader3") == 1);
+
+    RunTicks(2);
+    CSI_CHECK(Receive(display).empty());
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_osc_resync");
+}
@@ -0,0 +1,133 @@
+//
+//  test_profiler.cpp
+//  reaper_csurf_integrator
+//
+//  Profiler phases count a phase nested in itself once, DAW calls are counted per API name on the main thread only,
+//  and JSONValue reads back what WriteProfile and csi_bench write
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static void TestNestedPhases()
+{
+    CSIProfiler::SetEnabled(true);
+    
+    {
+        ProfileScope outer(ProfileZoneActivate);
+        
+        {
+            ProfileScope included(ProfileZoneActivate); // an included Zone
+            ProfileScope parse(ProfileProcessZoneFile);
+        }
+    }
+    
+    CSI_CHECK(CSIProfiler::GetPhaseStats(ProfileZoneActivate).calls == 1);
+    CSI_CHECK(CSIProfiler::GetPhaseStats(ProfileProcessZoneFile).calls == 1);
+    
+    {
+        ProfileScope again(ProfileZoneActivate); // the depth unwound with the scopes
+    }
+    
+    CSI_CHECK(CSIProfiler::GetPhaseStats(ProfileZoneActivate).calls == 2);
+    
+    CSIProfiler::SetEnabled(false);
+}
+
+static void TestNestedZoneActivate()
+{
+    // Home includes Track, an 8 channel zone
+    string resources = MakeTestResources(MCUTestIni);
+    
+    StartManager(resources);
+    
+    ControlSurface* surface = TheManager->GetCurrentPage()->GetSurface("MCU");
+    vector<Zone*> zones;
+    
+    CSI_CHECK(surface != nullptr);
+    
+    CSIProfiler::SetEnabled(true);
+    
+    if(surface != nullptr)
+        surface->GetZoneTemplate("Home")->Activate(surface, zones);
+    
+    CSI_CHECK(zones.size() == 9); // Home itself and a Track zone per channel
+    CSI_CHECK(CSIProfiler::GetPhaseStats(ProfileZoneActivate).calls == 1);
+    
+    CSIProfiler::SetEnabled(false);
+    
+    for(auto zone : zones)
+        surface->Deactivate(zone);
+    
+    StopManager();
+    RemoveTestResources(resources);
+}
+
+static void TestDAWCalls()
+{
+    int api = CSIProfiler::RegisterDAWApi("GetPlayState");
+    
+    CSI_CHECK(CSIProfiler::RegisterDAWApi("GetPlayState") == api); // an overload registering the same name shares the row
+    CSI_CHECK(CSIProfiler::RegisterDAWApi("GetPlayState (test)") != api);
+    
+    CSIProfiler::SetEnabled(true);
+    
+    DAW::GetPlayState();
+    
+    CSI_CHECK(CSIProfiler::GetDAWCallCount() == 1);
+    CSI_CHECK(CSIProfiler::GetDAWCalls(NumProfilePhases, api) == 1);
+    
+    // As the EuCon thread does
+    thread otherThread([]() { for(int i = 0; i < 1000; i++) DAW::GetPlayState(); });
+    otherThread.join();
+    
+    CSI_CHECK(CSIProfiler::GetDAWCallCount() == 1);
+    CSI_CHECK(CSIProfiler::GetDAWCalls(NumProfilePhases, api) == 1);
+    
+    CSIProfiler::SetEnabled(false);
+}
+
+static void TestJSON()
+{
+    JSONValue value;
+    
+    CSI_CHECK(JSONValue::Parse("{ \"phases\": [ { \"phase\": \"Run\", \"calls\": 3, \"nsPerOp\": 1.5e3 }, { \"phase\": \"Zone \\\"A\\\"\\n\", \"nsPerOp\": -2 } ], \"ok\": true, \"none\": null }", value));
+    CSI_CHECK(value.type == JSONValue::Object);
+    
+    const JSONValue* phases = value.Find("phases");
+    
+    CSI_CHECK(phases != nullptr && phases->elements.size() == 2);
+    
+    if(phases != nullptr && phases->elements.size() == 2)
+    {
+        CSI_CHECK(phases->elements[0].GetString("phase") == "Run");
+        CSI_CHECK(phases->elements[0].GetNumber("nsPerOp") == 1500.0);
+        CSI_CHECK(phases->elements[1].GetString("phase") == "Zone \"A\"\n");
+        CSI_CHECK(phases->elements[1].GetNumber("nsPerOp") == -2.0);
+        CSI_CHECK(phases->elements[1].GetNumber("calls", 7.0) == 7.0);
+    }
+    
+    CSI_CHECK(value.Find("ok") != nullptr && value.Find("ok")->boolValue);
+    CSI_CHECK(value.Find("none") != nullptr && value.Find("none")->type == JSONValue::Null);
+    
+    // The old regex reader took the first match on a line, these are all rejected outright
+    CSI_CHECK( ! JSONValue::Parse("{ \"phases\": [ ", value));
+    CSI_CHECK(value.type == JSONValue::Null);
+    CSI_CHECK( ! JSONValue::Parse("{ \"a\": 1 } trailing", value));
+    CSI_CHECK( ! JSONValue::Parse("{ \"a\" 1 }", value));
+    CSI_CHECK( ! JSONValue::Parse("", value));
+    
+    // Formatting doesn't matter any more, everything on one line
+    CSI_CHECK(JSONValue::Parse("{\"benchmarks\":[{\"name\":\"x\",\"nsPerOp\":12.5},{\"name\":\"y\",\"nsPerOp\":3}]}", value));
+    CSI_CHECK(value.Find("benchmarks") != nullptr && value.Find("benchmarks")->elements.size() == 2);
+}
+
+int main()
+{
+    TestNestedPhases();
+    TestNestedZoneActivate();
+    TestDAWCalls();
+    TestJSON();
+    
+    return CSITestResult("test_profiler");
+}
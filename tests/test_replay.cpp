@@ -0,0 +1,105 @@
+//
+//  test_replay.cpp
+//  reaper_csurf_integrator
+//
+//  A recording replayed as fast as possible reproduces the DAW writes, and the feedback file only holds what the replay produced
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static vector<string> ReadLines(string filePath)
+{
+    vector<string> lines;
+    ifstream file(filePath);
+    string line;
+
+    while(getline(file, line))
+        lines.push_back(line);
+
+    return lines;
+}
+
+static int CountContaining(const vector<string> &lines, string text)
+{
+    int count = 0;
+
+    for(auto &line : lines)
+        if(line.find(text) != string::npos)
+            count++;
+
+    return count;
+}
+
+int main()
+{
+    string resources = MakeTestResources(MCUTestIni);
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Track " + to_string(i + 1))->info_.SetValue("D_VOL", 0.5);
+
+    HeadlessMidiInput* midiInput = daw.GetMidiInput(0);
+    string recordingPath = resources + "/CSI/Recording.csirec";
+
+    StartManager(resources);
+    TheManager->ToggleTraceCapture(); // puts feedback from before the replay in the trace history
+    RunTicks(2);
+
+    CSI_CHECK(CSIRecorder::Start(recordingPath));
+
+    // Three ticks of fader moves on strips 1 and 2
+    for(int tick = 0; tick < 3; tick++)
+    {
+        midiInput->QueueMessage(0xe0, 0x00, 0x20 + tick * 0x10);
+        midiInput->QueueMessage(0xe1, 0x00, 0x30 + tick * 0x10);
+        RunTicks(1);
+    }
+
+    CSIRecorder::Stop();
+
+    double recordedVolume1 = daw.tracks_[0]->info_.GetValue("D_VOL");
+    double recordedVolume2 = daw.tracks_[1]->info_.GetValue("D_VOL");
+
+    CSI_CHECK(recordedVolume1 != 0.5);
+    CSI_CHECK(recordedVolume2 != 0.5);
+
+    TheManager->ToggleTraceCapture();
+
+    daw.tracks_[0]->info_.SetValue("D_VOL", 0.5);
+    daw.tracks_[1]->info_.SetValue("D_VOL", 0.5);
+    RunTicks(1);
+
+    CSI_CHECK(TheManager->StartReplay(recordingPath, true));
+
+    // One recorded tick per Run, then one more Run to capture the last feedback
+    int numRuns = 0;
+
+    while(TheManager->IsReplaying() && numRuns < 100)
+    {
+        TheManager->Run();
+        numRuns++;
+    }
+
+    CSI_CHECK( ! TheManager->IsReplaying());
+    CSI_CHECK(numRuns == 4);
+
+    CSI_CHECK_NEAR(daw.tracks_[0]->info_.GetValue("D_VOL"), recordedVolume1, 1e-9);
+    CSI_CHECK_NEAR(daw.tracks_[1]->info_.GetValue("D_VOL"), recordedVolume2, 1e-9);
+
+    vector<string> writes = ReadLines(resources + "/CSI/ReplayDAWWrites.txt");
+
+    CSI_CHECK(CountContaining(writes, "CSurf_OnVolumeChange") == 6);
+    CSI_CHECK(writes.size() == 6); // nothing written before the replay started, and nothing besides the fader moves
+
+    vector<string> feedback = ReadLines(resources + "/CSI/ReplayFeedback.txt");
+
+    CSI_CHECK(feedback.size() > 0);
+    CSI_CHECK(CountContaining(feedback, "IN <-") == 0); // the pre replay capture traced input too, the replay only traces output
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_replay");
+}
@@ -0,0 +1,69 @@
+//
+//  test_shadow_state.cpp
+//  reaper_csurf_integrator
+//
+//  Unchanged feedback is suppressed, and entering a page clears the surface's ShadowState so everything goes out again
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+#include "handy_functions.h"
+
+static int FaderPosition(MediaTrack* track)
+{
+    return (int)(volToNormalized(track->info_.GetValue("D_VOL")) * 16383.0);
+}
+
+int main()
+{
+    string resources = MakeTestResources(
+        "Version 1.1\n"
+        "Page \"One\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "MidiSurface MCU 0 0 MCU.mst MCU 8 0 0 0\n"
+        "Page \"Two\" FollowMCP NoSynchPages UseScrollLink NoNumbers { 0 0 0 }\n"
+        "MidiSurface MCU 0 0 MCU.mst MCU 8 0 0 0\n");
+    
+    HeadlessDAW& daw = HeadlessDAW::Get();
+    
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Track " + to_string(i + 1))->info_.SetValue("D_VOL", 0.25 + i * 0.05);
+    
+    MCUEmulator emulator;
+    HeadlessMidiOutput* midiOutput = daw.GetMidiOutput(0);
+    midiOutput->AttachEmulator(&emulator);
+    
+    StartManager(resources);
+    RunTicks(3);
+    
+    for(int i = 0; i < 8; i++)
+        CSI_CHECK_NEAR(emulator.GetFader(i), FaderPosition(daw.tracks_[i].get()), 1);
+    
+    midiOutput->ClearSentMessages();
+    RunTicks(3);
+    
+    CSI_CHECK(midiOutput->GetNumMessagesSent() == 0); // nothing changed, nothing sent
+    
+    daw.tracks_[2]->info_.SetValue("D_VOL", 0.9);
+    RunTicks(1);
+    
+    CSI_CHECK(CountSent(midiOutput, 0xe0) == 1);
+    CSI_CHECK_NEAR(emulator.GetFader(2), FaderPosition(daw.tracks_[2].get()), 1);
+    
+    TheManager->GoToPage("Two");
+    RunTicks(1);
+    TheManager->GoToPage("One");
+    
+    midiOutput->ClearSentMessages();
+    emulator.ResetState(); // as if the device had been power cycled while page Two was up
+    RunTicks(1);
+    
+    CSI_CHECK(CountSent(midiOutput, 0xe0) == 8); // page One resends its whole state after coming back
+    
+    for(int i = 0; i < 8; i++)
+        CSI_CHECK_NEAR(emulator.GetFader(i), FaderPosition(daw.tracks_[i].get()), 1);
+    
+    StopManager();
+    RemoveTestResources(resources);
+    
+    return CSITestResult("test_shadow_state");
+}
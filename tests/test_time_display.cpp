@@ -0,0 +1,96 @@
+//
+//  test_time_display.cpp
+//  reaper_csurf_integrator
+//
+//  The shared time display reads the transport once a tick and only formats a text again once the position
+//  has moved by a unit that text shows
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static void MoveCursor(TimeDisplayFormatter &formatter, double position)
+{
+    HeadlessDAW::Get().cursorPosition_ = position;
+    formatter.Invalidate();
+}
+
+int main()
+{
+    int timeMode = 0;       // ruler, Minutes:Seconds
+    int timeMode2 = -1;     // transport follows the ruler
+    int measureOffset = 0;
+    double timeOffset = 0.0;
+
+    TimeDisplayFormatter formatter;
+    formatter.Init(&timeMode, &timeMode2, &measureOffset, &timeOffset);
+
+    CSIProfiler::SetEnabled(true);
+
+    MoveCursor(formatter, 75.5);
+
+    CSI_CHECK(string(formatter.GetText(0)) == "1:15.500");
+    CSI_CHECK(string(formatter.GetText(0)) == "1:15.500");
+    CSI_CHECK(formatter.GetTimeMode() == 0);
+
+    // MCU and EuCon asking in the same tick share one read of the transport and one format
+    CSI_CHECK(DAWCalls("GetPlayState") == 1);
+    CSI_CHECK(DAWCalls("GetCursorPosition") == 1);
+    CSI_CHECK(DAWCalls("format_timestr_pos") == 1);
+
+    // Less than a millisecond on, the text can't change
+    MoveCursor(formatter, 75.5004);
+
+    CSI_CHECK(string(formatter.GetText(0)) == "1:15.500");
+    CSI_CHECK(DAWCalls("GetCursorPosition") == 2);
+    CSI_CHECK(DAWCalls("format_timestr_pos") == 1);
+
+    MoveCursor(formatter, 75.502);
+
+    CSI_CHECK(string(formatter.GetText(0)) == "1:15.502");
+    CSI_CHECK(DAWCalls("format_timestr_pos") == 2);
+
+    // The project time offset moves the clock modes, not the position they're keyed on
+    timeOffset = 10.0;
+    MoveCursor(formatter, 75.5);
+
+    CSI_CHECK(string(formatter.GetText(0)) == "1:25.500");
+
+    const unsigned char* digits = formatter.GetMCUDigits();
+    const unsigned char expectedDigits[10] = { 0, 0, 0, '0', '1', '2', '5', '5', '0', '0' };
+
+    CSI_CHECK(memcmp(digits, expectedDigits, sizeof(expectedDigits)) == 0);
+
+    long long formats = DAWCalls("format_timestr_pos");
+    formatter.GetMCUDigits();
+    formatter.GetText(0);
+    CSI_CHECK(DAWCalls("format_timestr_pos") == formats);
+
+    // Bars/Beats, 120 bpm, a hundredth of a beat is the smallest step the text shows
+    timeOffset = 0.0;
+    timeMode = 2;
+    MoveCursor(formatter, 0.25);
+
+    CSI_CHECK(formatter.GetTimeMode() == 2);
+    CSI_CHECK(string(formatter.GetText(2)) == "1.1.50");
+
+    formats = DAWCalls("format_timestr_pos");
+    MoveCursor(formatter, 0.2502);
+
+    CSI_CHECK(string(formatter.GetText(2)) == "1.1.50");
+    CSI_CHECK(DAWCalls("format_timestr_pos") == formats);
+
+    MoveCursor(formatter, 2.125); // bar 2, beat 1, a quarter beat in
+
+    CSI_CHECK(string(formatter.GetText(2)) == "2.1.25");
+
+    // The transport's own mode wins over the ruler's
+    timeMode2 = 3;
+    formatter.Invalidate();
+
+    CSI_CHECK(formatter.GetTimeMode() == 3);
+
+    CSIProfiler::SetEnabled(false);
+
+    return CSITestResult("test_time_display");
+}
@@ -0,0 +1,126 @@
+//
+//  test_trace.cpp
+//  reaper_csurf_integrator
+//
+//  Trace records from any thread reach the console and the dump file in order, formatted as the old console lines were,
+//  and a record too big for the ring says so
+//
+
+#include <thread>
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static vector<string> ReadLines(string filePath)
+{
+    vector<string> lines;
+    ifstream file(filePath);
+    string line;
+
+    while(getline(file, line))
+        lines.push_back(line);
+
+    return lines;
+}
+
+static int CountContaining(const vector<string> &lines, string text)
+{
+    int count = 0;
+
+    for(auto &line : lines)
+        if(line.find(text) != string::npos)
+            count++;
+
+    return count;
+}
+
+int main()
+{
+    HeadlessDAW& daw = HeadlessDAW::Get();
+    string resources = MakeTestResources("Version 1.1\n");
+    string dumpPath = resources + "/CSI/Trace.txt";
+
+    int mcu = CSITrace::RegisterName("MCU");
+    int osc = CSITrace::RegisterName("OSC");
+    int fader = CSITrace::RegisterName("Fader1");
+
+    CSI_CHECK(CSITrace::RegisterName("MCU") == mcu);
+    CSI_CHECK(CSITrace::GetName(osc) == "OSC");
+
+    CSI_CHECK( ! CSITrace::IsEnabled(TraceInput));
+
+    // Output to the console as well as the history, input to the history only
+    CSITrace::SetEnabled(TraceInput | TraceOutput, TraceOutput);
+
+    CSI_CHECK(CSITrace::IsEnabled(TraceInput) && CSITrace::IsEnabled(TraceOutput));
+
+    const unsigned char noteOn[3] = { 0x90, 0x10, 0x7f };
+
+    CSITrace::Record(TraceWidgetInput, mcu, fader, 0.5);
+    CSITrace::Record(TraceMidiOutput, mcu, 0, noteOn, 3);
+    CSITrace::Record(TraceOSCOutput, osc, 0, "/track/1/volume", 0.25);
+    CSITrace::Record(TraceOSCOutput, osc, 0, "/track/1/name", "Kick");
+
+    // An address and text that together won't fit a record
+    string longAddress = "/track/1/fx/1/param/" + string(sizeof(TraceRecord::data), 'p');
+    CSITrace::Record(TraceOSCOutput, osc, 0, longAddress.c_str(), "Ratio");
+
+    // Surfaces record from the main thread, the OSC and EuCon threads at once
+    vector<thread> producers;
+
+    for(int producer = 0; producer < 4; producer++)
+        producers.push_back(thread([&, producer]()
+        {
+            for(int i = 0; i < 1000; i++)
+                CSITrace::Record(TraceOSCOutput, osc, 0, ("/producer/" + to_string(producer)).c_str(), (double)i);
+        }));
+
+    for(auto &producer : producers)
+        producer.join();
+
+    CSITrace::DumpToFile(dumpPath);
+    vector<string> lines = ReadLines(dumpPath);
+
+    CSI_CHECK(lines.size() == 5 + 4000);
+    CSI_CHECK(lines.size() > 4 && lines[0].find("IN <- MCU Fader1 0.500000") != string::npos);
+    CSI_CHECK(lines.size() > 4 && lines[1].find("OUT->MCU  90  10  7f") != string::npos);
+    CSI_CHECK(lines.size() > 4 && lines[2].find("OUT->OSC /track/1/volume 0.250000") != string::npos);
+    CSI_CHECK(lines.size() > 4 && lines[3].find("OUT->OSC /track/1/name Kick") != string::npos);
+    CSI_CHECK(lines.size() > 4 && lines[4].find("[truncated]") != string::npos);
+    CSI_CHECK(CountContaining(lines, "[truncated]") == 1);
+
+    for(int producer = 0; producer < 4; producer++)
+        CSI_CHECK(CountContaining(lines, "/producer/" + to_string(producer) + " ") == 1000);
+
+    // Records dumped since a timestamp leave out what came before it
+    double since = CSIProfiler::GetTimestamp();
+    CSITrace::Record(TraceOSCOutput, osc, 0, "/after", 1.0);
+    CSITrace::DumpToFile(dumpPath, since);
+
+    lines = ReadLines(dumpPath);
+
+    CSI_CHECK(lines.size() == 1);
+    CSI_CHECK(CountContaining(lines, "/after") == 1);
+
+    // Only the output went to the console
+    CSITrace::SetEnabled(0, 0);
+    CSITrace::FlushToConsole(); // nothing to flush once console tracing is off
+
+    CSI_CHECK(daw.console_.empty());
+
+    CSITrace::SetEnabled(TraceInput | TraceOutput, TraceOutput);
+    CSITrace::Record(TraceWidgetInput, mcu, fader, 1.0);
+    CSITrace::Record(TraceMidiOutput, mcu, 0, noteOn, 3);
+    CSITrace::Shutdown(); // drains the ring
+    CSITrace::FlushToConsole();
+
+    CSI_CHECK(daw.console_.find("OUT->MCU  90  10  7f") != string::npos);
+    CSI_CHECK(daw.console_.find("IN <-") == string::npos);
+
+    CSITrace::SetEnabled(0, 0);
+
+    CSI_CHECK( ! CSITrace::IsEnabled(TraceOutput));
+
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_trace");
+}
@@ -0,0 +1,79 @@
+//
+//  test_track_appearance.cpp
+//  reaper_csurf_integrator
+//
+//  Track names and colours are read once and kept across ticks, a title change shows on the next tick,
+//  and a colour change within TrackAppearanceCache::VerifyInterval ticks
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+static string GetScribbleStrip(MCUEmulator &emulator, int channel)
+{
+    string cell = emulator.GetDisplayCell(0, 0, channel);
+
+    return cell.substr(0, cell.find_last_not_of(' ') + 1);
+}
+
+int main()
+{
+    string resources = MakeTestResources(MCUTestIni);
+
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+        daw.AddTrack("Trk" + to_string(i + 1));
+
+    MCUEmulator emulator;
+    daw.GetMidiOutput(0)->AttachEmulator(&emulator);
+
+    StartManager(resources);
+    RunTicks(3);
+
+    CSI_CHECK(GetScribbleStrip(emulator, 0) == "Trk1");
+
+    // Names shown every tick are read once a sweep, not once a tick
+    CSIProfiler::SetEnabled(true);
+    RunTicks(TrackAppearanceCache::VerifyInterval);
+
+    CSI_CHECK(DAWCalls("GetTrackName") == 8);
+
+    CSIProfiler::SetEnabled(false);
+
+    // REAPER tells the surface about a rename, the strip follows on the next tick
+    MediaTrack* track = daw.tracks_[0].get();
+    DAW::GetSetMediaTrackInfo(track, "P_NAME", (void*)"Kick");
+    TheManager->OnTrackTitleChange(track);
+    RunTicks(1);
+
+    CSI_CHECK(GetScribbleStrip(emulator, 0) == "Kick");
+
+    // Colours come with no notification, so the cache keeps the old one until its next sweep
+    TrackAppearanceCache* appearances = TheManager->GetTrackAppearances();
+    MediaTrack* track2 = daw.tracks_[1].get();
+
+    track2->info_.SetValue("I_CUSTOMCOLOR", 0x1ff0000);
+    CSI_CHECK(appearances->GetColour(track2) == 0x1ff0000);
+
+    track2->info_.SetValue("I_CUSTOMCOLOR", 0x100ff00);
+    CSI_CHECK(appearances->GetColour(track2) == 0x1ff0000);
+
+    for(int tick = 0; tick < TrackAppearanceCache::VerifyInterval && appearances->GetColour(track2) != 0x100ff00; tick++)
+        appearances->Run();
+
+    CSI_CHECK(appearances->GetColour(track2) == 0x100ff00);
+
+    // After a track list change a pointer may belong to another track, nothing cached survives
+    DAW::GetSetMediaTrackInfo(track2, "P_NAME", (void*)"Snare");
+    track2->info_.SetValue("I_CUSTOMCOLOR", 0x10000ff);
+    TheManager->OnTrackListChange();
+
+    CSI_CHECK(string(appearances->GetName(track2)) == "Snare");
+    CSI_CHECK(appearances->GetColour(track2) == 0x10000ff);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_track_appearance");
+}
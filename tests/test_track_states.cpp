@@ -0,0 +1,93 @@
+//
+//  test_track_states.cpp
+//  reaper_csurf_integrator
+//
+//  Track state is read from the DAW once per shown track per property each tick, however many widgets show it,
+//  and an action sees what the action before it changed
+//
+
+#include "csi_test_host.h"
+#include "csi_test.h"
+
+int main()
+{
+    HeadlessDAW& daw = HeadlessDAW::Get();
+
+    for(int i = 0; i < 8; i++)
+    {
+        MediaTrack* track = daw.AddTrack("Track " + to_string(i + 1));
+        track->info_.SetValue("D_VOL", 0.1 * (i + 1));
+        track->info_.SetValue("D_PAN", -0.5);
+    }
+
+    MediaTrack* track1 = daw.tracks_[0].get();
+    MediaTrack* track2 = daw.tracks_[1].get();
+
+    // The snapshot by itself, one read per track per column until it is invalidated
+    TrackStateSnapshot snapshot;
+
+    CSIProfiler::SetEnabled(true);
+
+    CSI_CHECK(snapshot.GetUIVolume(track1) == 0.1);
+    CSI_CHECK(snapshot.GetUIVolume(track2) == 0.2);
+    CSI_CHECK(snapshot.GetUIPan(track1) == -0.5);
+    CSI_CHECK(snapshot.GetUIVolume(track1) == 0.1);
+    CSI_CHECK(snapshot.GetNumTracks() == 2);
+
+    CSI_CHECK(DAWCalls("GetTrackUIVolPan") == 2);
+
+    // A new column is read for every track that has joined
+    CSI_CHECK( ! snapshot.GetUIMute(track1));
+    CSI_CHECK(DAWCalls("GetTrackUIMute") == 2);
+
+    track1->info_.SetValue("D_VOL", 0.75);
+
+    CSI_CHECK(snapshot.GetUIVolume(track1) == 0.1);
+
+    snapshot.Invalidate();
+
+    CSI_CHECK(snapshot.GetNumTracks() == 0);
+    CSI_CHECK(snapshot.GetUIVolume(track1) == 0.75);
+    CSI_CHECK(DAWCalls("GetTrackUIVolPan") == 3);
+
+    track1->info_.SetValue("D_VOL", 0.1);
+    CSIProfiler::SetEnabled(false);
+
+    // On an MCU each strip's fader and V-Pot share one volume and pan read a tick
+    string resources = MakeTestResources(MCUTestIni);
+
+    HeadlessMidiInput* midiInput = daw.GetMidiInput(0);
+
+    StartManager(resources);
+    RunTicks(2);
+
+    CSIProfiler::SetEnabled(true);
+    RunTicks(10);
+
+    CSI_CHECK(DAWCalls("GetTrackUIVolPan") == 8 * 10);
+    CSI_CHECK(DAWCalls("GetTrackUIMute") == 8 * 10);
+
+    CSIProfiler::SetEnabled(false);
+
+    // Two presses of Mute in one tick, the second toggles what the first left
+    for(int press = 0; press < 2; press++)
+    {
+        midiInput->QueueMessage(0x90, 0x10, 0x7f);
+        midiInput->QueueMessage(0x90, 0x10, 0x00);
+    }
+
+    RunTicks(1);
+
+    CSI_CHECK(track1->info_.GetValue("B_MUTE") == 0.0);
+
+    midiInput->QueueMessage(0x90, 0x10, 0x7f);
+    midiInput->QueueMessage(0x90, 0x10, 0x00);
+    RunTicks(1);
+
+    CSI_CHECK(track1->info_.GetValue("B_MUTE") != 0.0);
+
+    StopManager();
+    RemoveTestResources(resources);
+
+    return CSITestResult("test_track_states");
+}
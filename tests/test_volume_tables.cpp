@@ -0,0 +1,80 @@
+//
+//  test_volume_tables.cpp
+//  reaper_csurf_integrator
+//
+//  Holds the table driven conversions in handy_functions.h to the error bounds documented there
+//
+
+#include "control_surface_integrator.h"
+#include "handy_functions.h"
+#include "csi_test.h"
+
+int main()
+{
+    // normalizedToVolFast -- exact at every 14 bit and 7 bit position
+    double maxInt14Error = 0.0;
+    
+    for(int i = 0; i <= VolumeTableInt14Steps; i++)
+    {
+        double normalized = i / (double)VolumeTableInt14Steps;
+        maxInt14Error = fmax(maxInt14Error, fabs(normalizedToVolFast(normalized) - normalizedToVol(normalized)));
+    }
+    
+    CSI_CHECK(maxInt14Error < 1e-12);
+    
+    for(int i = 0; i <= 127; i++)
+        CSI_CHECK_NEAR(normalizedToVolFast(i / 127.0), normalizedToVol(i / 127.0), 1e-12);
+    
+    // ... and < 1e-6 gain in between
+    double maxBetweenError = 0.0;
+    
+    for(int i = 0; i < 200000; i++)
+    {
+        double normalized = (i + 0.37) / 200000.0;
+        maxBetweenError = fmax(maxBetweenError, fabs(normalizedToVolFast(normalized) - normalizedToVol(normalized)));
+    }
+    
+    CSI_CHECK(maxBetweenError < 1e-6);
+    
+    // VAL2DBFast -- < 2e-5 dB, across the whole meter range, floors at -150 like VAL2DB
+    double maxDBError = 0.0;
+    
+    for(double dB = -149.0; dB < 24.0; dB += 0.0137)
+    {
+        double gain = DB2VAL(dB);
+        maxDBError = fmax(maxDBError, fabs(VAL2DBFast(gain) - VAL2DB(gain)));
+    }
+    
+    CSI_CHECK(maxDBError < 2e-5);
+    CSI_CHECK(VAL2DBFast(0.0) == -150.0);
+    CSI_CHECK(VAL2DBFast(1e-12) == -150.0);
+    
+    // the constexpr log2 table against the library
+    for(int i = 0; i <= VolumeTableMantissaSteps; i++)
+        CSI_CHECK_NEAR(Log2FromMantissa.values[i], log2(0.5 + 0.5 * i / VolumeTableMantissaSteps), 1e-14);
+    
+    static_assert(Log2FromMantissa.values[VolumeTableMantissaSteps] == 0.0, "log2(1) is computed at compile time");
+    
+    // volToNormalizedFast / peakToNormalizedMeter -- < 1e-5 normalized, clamped to 0..1
+    double maxNormalizedError = 0.0;
+    
+    for(double dB = -149.0; dB < 24.0; dB += 0.0137)
+    {
+        double gain = DB2VAL(dB);
+        maxNormalizedError = fmax(maxNormalizedError, fabs(volToNormalizedFast(gain) - volToNormalized(gain)));
+    }
+    
+    CSI_CHECK(maxNormalizedError < 1e-5);
+    CSI_CHECK(volToNormalizedFast(0.0) == 0.0);
+    CSI_CHECK(volToNormalizedFast(DB2VAL(30.0)) == 1.0);
+    CSI_CHECK(peakToNormalizedMeter(DB2VAL(-6.0)) == volToNormalizedFast(DB2VAL(-6.0)));
+    
+    // round trip through a 14 bit fader position lands where the reference round trip does, which floors at -150 dB
+    for(int i = 1; i <= VolumeTableInt14Steps; i += 97)
+    {
+        double normalized = i / (double)VolumeTableInt14Steps;
+        CSI_CHECK_NEAR(volToNormalizedFast(normalizedToVolFast(normalized)), volToNormalized(normalizedToVol(normalized)), 0.5 / VolumeTableInt14Steps);
+    }
+    
+    return CSITestResult("test_volume_tables");
+}